@@ -6,10 +6,18 @@ layout(location = 1) in vec3 v_normal;
 layout(location = 2) in vec2 v_texture_coord;
 layout(location = 3) in vec3 v_color;
 
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
+
 // Uniform properties
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
 
 // Output
 out vec3 frag_normal;
@@ -22,5 +30,5 @@ void main()
     frag_normal = v_normal;
     frag_color = v_color;
     tex_coord = v_texture_coord;
-    gl_Position = Projection * View * Model * vec4(v_position, 1.0);
+    gl_Position = ViewProjection * Model * vec4(v_position, 1.0);
 }
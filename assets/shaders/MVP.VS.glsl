@@ -3,13 +3,21 @@
 // Input
 layout(location = 0) in vec3 v_position;
 
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
+
 // Uniform properties
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
 
 
 void main()
 {
-    gl_Position = Projection * View * Model * vec4(v_position, 1.0);
+    gl_Position = ViewProjection * Model * vec4(v_position, 1.0);
 }
@@ -0,0 +1,143 @@
+/// Microbenchmark of the batched sphere kernels against the per-pair hit tests.
+///
+/// Usage: sphere_kernels_bench [positions] [iterations]
+/// Prints the time per tested position of every kernel supported by this CPU,
+/// and checks that all of them find the same hits.
+
+#include "World_OF_Tanks/SphereKernels.h"
+#include "World_OF_Tanks/Projectiles.h"
+#include "World_OF_Tanks/EnemyTanks.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    /// Packed positions and radii, laid out like the simulation pools
+    struct Positions
+    {
+        std::vector<float> xs, ys, zs, radii;
+    };
+
+
+    /// Run `body` `iterations` times, return the nanoseconds per position.
+    template <typename Body>
+    double Measure(std::size_t count, int iterations, std::size_t& hits, Body body)
+    {
+        // Warm up the caches and the branch predictors
+        hits = body();
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t total = 0;
+        for (int it = 0; it < iterations; ++it)
+        {
+            total += body();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        // Keep the results alive
+        static volatile std::size_t sink;
+        sink = total;
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        return ns / (static_cast<double>(count) * iterations);
+    }
+
+
+    void Report(const char* name, double nsPerPosition, std::size_t hits, std::size_t reference)
+    {
+        std::printf("  %-28s %8.3f ns/position  %8zu hits%s\n",
+                    name, nsPerPosition, hits, hits == reference ? "" : "  MISMATCH");
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 100000;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // Positions spread over the arena around the player, about 1% of them hit
+    Positions positions;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> height(0.0f, 2.0f);
+    std::uniform_real_distribution<float> size(0.5f, 2.0f);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        positions.xs.push_back(coord(rng));
+        positions.ys.push_back(height(rng));
+        positions.zs.push_back(coord(rng));
+        positions.radii.push_back(size(rng));
+    }
+
+    PlayerTank player;
+    player.position = glm::vec3(1.0f, 0.5f, -2.0f);
+
+    std::vector<std::uint8_t> hitMask(count);
+    std::size_t hits = 0;
+
+    std::printf("sphere kernels: %zu positions x %d iterations, cpu kernel: %s\n",
+                count, iterations, SphereKernels::GetIsaName(SphereKernels::DetectIsa()));
+
+    const SphereKernels::Isa kernels[] = { SphereKernels::Isa::Scalar, SphereKernels::Isa::SSE4, SphereKernels::Isa::AVX2 };
+
+    /// Projectiles against the player: points against a sphere of radius 1
+    std::printf("point vs sphere (ProjectilePlayerCollision)\n");
+    std::size_t reference = 0;
+    double ns = Measure(count, iterations, reference, [&]()
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            glm::vec3 position(positions.xs[i], positions.ys[i], positions.zs[i]);
+            n += Projectiles::ProjectilePlayerCollision(position, player) ? 1 : 0;
+        }
+        return n;
+    });
+    Report("per-pair glm::length", ns, reference, reference);
+
+    for (SphereKernels::Isa isa : kernels)
+    {
+        if (!SphereKernels::IsSupported(isa)) continue;
+        ns = Measure(count, iterations, hits, [&]()
+        {
+            return SphereKernels::TestSpheres(isa, player.position, 1.0f,
+                positions.xs.data(), positions.ys.data(), positions.zs.data(), nullptr,
+                count, hitMask.data());
+        });
+        Report(SphereKernels::GetIsaName(isa), ns, hits, reference);
+    }
+
+    /// Tanks against the player: spheres with their own radius against a sphere
+    std::printf("sphere vs sphere (TankPlayerCollision)\n");
+    ns = Measure(count, iterations, reference, [&]()
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            glm::vec3 position(positions.xs[i], positions.ys[i], positions.zs[i]);
+            n += EnemyTanks::TankPlayerCollision(player, position, positions.radii[i]) ? 1 : 0;
+        }
+        return n;
+    });
+    Report("per-pair glm::distance", ns, reference, reference);
+
+    for (SphereKernels::Isa isa : kernels)
+    {
+        if (!SphereKernels::IsSupported(isa)) continue;
+        ns = Measure(count, iterations, hits, [&]()
+        {
+            return SphereKernels::TestSpheres(isa, player.position, player.radius,
+                positions.xs.data(), positions.ys.data(), positions.zs.data(), positions.radii.data(),
+                count, hitMask.data());
+        });
+        Report(SphereKernels::GetIsaName(isa), ns, hits, reference);
+    }
+
+    return 0;
+}
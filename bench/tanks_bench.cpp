@@ -0,0 +1,232 @@
+/// Microbenchmarks of the gameplay passes, headless (no GL), for regression tracking.
+///
+/// Usage: tanks_bench [maxEntities] [minTimeMs] [threads]
+/// Sweeps the entity count from 10 to maxEntities (default 100000) by powers of 10,
+/// times every pass for at least minTimeMs (default 200) per count, on `threads`
+/// threads (default 1, the calling thread only). The results are printed as JSON
+/// on stdout, the progress goes to stderr. InitializeBuildings is timed once, on the
+/// default arena, since the arena caps the number of buildings.
+///
+/// The passes run on a scene spread so that the tank density stays the one of 100 tanks
+/// in the gameplay arena: the ns/entity of the big counts compare with the small ones
+/// instead of measuring a pile of overlapping tanks. The arena bound the tanks move in
+/// is scaled the same way. The buildings stay in the center.
+
+#include "World_OF_Tanks/TankSim.h"
+#include "core/log/log.h"
+#include "utils/random_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    const std::uint64_t benchSeed = 42;
+    const float tickDuration = 1.0f / 60.0f;
+    const double tanksPerArena = 100.0;     // Density of the scene
+
+
+    struct Result
+    {
+        std::string name;
+        std::size_t entities;
+        std::size_t iterations;
+        double nsPerOp;
+    };
+
+
+    /// Run reset() then op() until minTimeMs of op() was measured (3 runs at least),
+    /// only op() is timed. Returns the mean nanoseconds per op().
+    template <typename Reset, typename Op>
+    Result Measure(const char* name, std::size_t entities, double minTimeMs, Reset reset, Op op)
+    {
+        // Warm up the caches and the allocations
+        reset();
+        op();
+
+        double totalNs = 0.0;
+        std::size_t iterations = 0;
+        while (iterations < 3 || totalNs < minTimeMs * 1e6)
+        {
+            reset();
+
+            auto start = std::chrono::steady_clock::now();
+            op();
+            auto end = std::chrono::steady_clock::now();
+
+            totalNs += std::chrono::duration<double, std::nano>(end - start).count();
+            iterations++;
+        }
+
+        Result result = { name, entities, iterations, totalNs / iterations };
+        std::fprintf(stderr, "  %-36s %8zu entities %14.1f ns/op\n", name, entities, result.nsPerOp);
+        return result;
+    }
+
+
+    /// Projectiles flying over the arena scaled by `spread`, none expired
+    void FillProjectiles(ProjectilePool& projectiles, std::size_t count, float spread)
+    {
+        const float halfSize = arenaHalfSize * spread;
+        random_utils::Sequence random(benchSeed, 1000);
+
+        projectiles.Clear();
+        projectiles.Reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Projectile projectile;
+            projectile.position = glm::vec3(random.NextFloat(-halfSize, halfSize), random.NextFloat(0.5f, 1.5f),
+                                            random.NextFloat(-halfSize, halfSize));
+            projectile.velocity = glm::vec3(random.NextFloat(-10.0f, 10.0f), 0.0f, random.NextFloat(-10.0f, 10.0f));
+            projectile.radius = 0.1f;
+            projectile.lifespan = 0.0f;
+            projectile.maxLifespan = 5.0f;
+            projectiles.Add(projectile);
+        }
+    }
+
+
+    void PrintJson(const std::vector<Result>& results, std::size_t maxEntities, unsigned int threads)
+    {
+        std::printf("{\n");
+        std::printf("  \"benchmark\": \"tanks_bench\",\n");
+        std::printf("  \"seed\": %llu,\n", static_cast<unsigned long long>(benchSeed));
+        std::printf("  \"threads\": %u,\n", threads);
+        std::printf("  \"max_entities\": %zu,\n", maxEntities);
+        std::printf("  \"results\": [\n");
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+            double nsPerEntity = result.entities > 0 ? result.nsPerOp / result.entities : 0.0;
+            std::printf("    {\"name\": \"%s\", \"entities\": %zu, \"iterations\": %zu, "
+                        "\"ns_per_op\": %.1f, \"ns_per_entity\": %.3f}%s\n",
+                        result.name.c_str(), result.entities, result.iterations,
+                        result.nsPerOp, nsPerEntity, i + 1 < results.size() ? "," : "");
+        }
+        std::printf("  ]\n");
+        std::printf("}\n");
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t maxEntities = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 100000;
+    const double minTimeMs = argc > 2 ? std::atof(argv[2]) : 200.0;
+    const unsigned int threads = argc > 3 ? static_cast<unsigned int>(std::atoi(argv[3])) : 1;
+
+    // Only the results go to stdout, GameInit warns about every tank it can't place
+    Log::SetLevel(LogLevel::Error);
+
+    JobSystem jobs(threads);
+    std::vector<Result> results;
+
+    /// ARENA INIT
+    // Timed once with the default arena, out of the sweep: the buildings are capped by the
+    // cells of the fixed size arena (49), a bigger count only measures the failed tries.
+    // The entities of this result are the buildings actually placed.
+    {
+        std::fprintf(stderr, "default arena\n");
+        std::unique_ptr<TankSim> sim;
+        results.push_back(Measure("InitializeBuildings", 0, minTimeMs,
+            [&]() { sim.reset(new TankSim(benchSeed, 1)); },
+            [&]() { GameInit(sim.get()).InitializeBuildings(); }));
+        results.back().entities = sim->GetBuildings().size();
+    }
+
+    for (std::size_t count = 10; count <= maxEntities; count *= 10)
+    {
+        std::fprintf(stderr, "%zu entities\n", count);
+        const int numEntities = static_cast<int>(count);
+
+        /// ARENA INIT
+        // A fresh simulation with the default buildings per run
+        {
+            std::unique_ptr<TankSim> sim;
+            results.push_back(Measure("InitializeEnemyTanks", count, minTimeMs,
+                [&]()
+                {
+                    sim.reset(new TankSim(benchSeed, 1));
+                    GameInit(sim.get()).InitializeBuildings();
+                    sim->BuildBuildingIndex();
+                },
+                [&]() { GameInit(sim.get()).InitializeEnemyTanks(numEntities); }));
+        }
+
+        /// SCENE
+        // The default buildings with `count` enemy tanks and `count` projectiles, spread out
+        TankSim sim(benchSeed, 1);
+        GameInit(&sim).InitializeBuildings();
+        sim.BuildBuildingIndex();
+        GameInit(&sim).InitializeEnemyTanks(numEntities);
+
+        const BuildingIndex& buildings = sim.GetBuildingIndex();
+        const float spread = static_cast<float>(std::max(1.0, std::sqrt(count / tanksPerArena)));
+        const float arenaBound = arenaHalfSize * spread;
+        EnemyTankPool initialEnemies = sim.GetEnemies();
+        for (std::size_t i = 0; i < initialEnemies.Size(); ++i)
+        {
+            initialEnemies.positionX[i] *= spread;
+            initialEnemies.positionZ[i] *= spread;
+        }
+
+        const PlayerTank initialPlayer = sim.GetPlayer();
+        ProjectilePool initialProjectiles;
+        FillProjectiles(initialProjectiles, count, spread);
+
+        EnemyTankPool enemies;
+        PlayerTank player;
+        ProjectilePool projectiles;
+        SpatialGrid grid(4.0f, 1.5f);
+
+        // Every pass starts again from the initial scene, the grid is built outside the timing
+        auto resetScene = [&]()
+        {
+            enemies = initialEnemies;
+            player = initialPlayer;
+            projectiles = initialProjectiles;
+            EnemyTanks::BuildTankGrid(grid, enemies);
+        };
+
+        /// PASSES
+        results.push_back(Measure("BuildTankGrid", count, minTimeMs, resetScene,
+            [&]() { EnemyTanks::BuildTankGrid(grid, enemies); }));
+
+        results.push_back(Measure("UpdateTankCollisions", count, minTimeMs, resetScene,
+            [&]() { EnemyTanks::UpdateTankCollisions(enemies, player, grid, jobs); }));
+
+        results.push_back(Measure("UpdateTankCollisionsWithBuildings", count, minTimeMs, resetScene,
+            [&]() { EnemyTanks::UpdateTankCollisionsWithBuildings(enemies, buildings, jobs); }));
+
+        results.push_back(Measure("UpdateEnemyMovement", count, minTimeMs, resetScene,
+            [&]()
+            {
+                float turretRotationSpeed = 1.0f;
+                float targetRotation = 0.0f;
+                EnemyTanks::UpdateEnemyMovement(enemies, player, false, arenaBound, tickDuration, benchSeed, 0,
+                                                attackRange, fireRate, fireAlignmentThreshold,
+                                                turretRotationSpeed, targetRotation,
+                                                projectiles, buildings, grid, jobs);
+            }));
+
+        results.push_back(Measure("UpdateSinkingTanks", count, minTimeMs, resetScene,
+            [&]() { EnemyTanks::UpdateSinkingTanks(enemies, tickDuration, jobs); }));
+
+        results.push_back(Measure("UpdateProjectiles", count, minTimeMs, resetScene,
+            [&]()
+            {
+                Projectiles::UpdateProjectiles(projectiles, player, enemies, grid, buildings,
+                                               static_cast<int>(damage), tickDuration, jobs);
+            }));
+    }
+
+    PrintJson(results, maxEntities, threads);
+    return 0;
+}
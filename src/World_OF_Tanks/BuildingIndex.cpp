@@ -0,0 +1,79 @@
+#include "BuildingIndex.h"
+
+
+BuildingIndex::BuildingIndex()
+    : originX(0.0f), originZ(0.0f), invCellSize(1.0f), maxReach(0.0f),
+    numCellsX(1), numCellsZ(1), cellStart(2, 0)
+{ /* DEFAULT EMPTY CONSTRUCTOR BODY */ }
+
+
+/// <summary>
+/// Sort the building records into a dense grid covering their centers.
+/// </summary>
+/// <param name="buildingRecords">Collision records of all the buildings.</param>
+/// <param name="cellSize">Size of a grid cell in world units.</param>
+void BuildingIndex::Build(const std::vector<BuildingRecord>& buildingRecords, float cellSize)
+{
+    records.clear();
+    maxReach = 0.0f;
+    invCellSize = 1.0f / cellSize;
+
+    if (buildingRecords.empty())
+    {
+        numCellsX = numCellsZ = 1;
+        cellStart.assign(2, 0);
+        return;
+    }
+
+    // Bounds of the building centers and the largest reach out of a cell
+    glm::vec2 minCenter(buildingRecords[0].position.x, buildingRecords[0].position.z);
+    glm::vec2 maxCenter = minCenter;
+    for (const BuildingRecord& record : buildingRecords)
+    {
+        minCenter = glm::min(minCenter, glm::vec2(record.position.x, record.position.z));
+        maxCenter = glm::max(maxCenter, glm::vec2(record.position.x, record.position.z));
+
+        maxReach = std::max(maxReach, record.radius);
+        maxReach = std::max(maxReach, std::max(record.halfExtents.x, record.halfExtents.z));
+    }
+
+    originX = minCenter.x;
+    originZ = minCenter.y;
+    numCellsX = static_cast<int>((maxCenter.x - minCenter.x) * invCellSize) + 1;
+    numCellsZ = static_cast<int>((maxCenter.y - minCenter.y) * invCellSize) + 1;
+
+    // Counting sort of the records by cell, the building order is kept inside a cell
+    std::vector<int> recordCell(buildingRecords.size());
+    cellStart.assign(numCellsX * numCellsZ + 1, 0);
+    for (std::size_t i = 0; i < buildingRecords.size(); ++i)
+    {
+        recordCell[i] = CellZ(buildingRecords[i].position.z) * numCellsX + CellX(buildingRecords[i].position.x);
+        cellStart[recordCell[i] + 1]++;
+    }
+    for (int c = 0; c < numCellsX * numCellsZ; ++c)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    std::vector<std::uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    records.resize(buildingRecords.size());
+    for (std::size_t i = 0; i < buildingRecords.size(); ++i)
+    {
+        records[cursor[recordCell[i]]++] = buildingRecords[i];
+    }
+}
+
+
+/// <summary>
+/// Collect the candidates around a position, sorted by building id.
+/// </summary>
+/// <param name="center">Center of the query.</param>
+/// <param name="radius">Interaction distance around the center.</param>
+/// <param name="out">Receives the candidate records (cleared first).</param>
+void BuildingIndex::QuerySphereSorted(const glm::vec3& center, float radius, std::vector<const BuildingRecord*>& out) const
+{
+    out.clear();
+    QuerySphere(center, radius, [&out](const BuildingRecord& record) { out.push_back(&record); });
+    std::sort(out.begin(), out.end(),
+        [](const BuildingRecord* a, const BuildingRecord* b) { return a->id < b->id; });
+}
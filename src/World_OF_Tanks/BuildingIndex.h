@@ -0,0 +1,130 @@
+#pragma once
+
+#ifndef BUILDING_INDEX_H
+#define BUILDING_INDEX_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+/// <summary>
+/// Compact collision data of a building, no strings or render data in the hot loops.
+/// </summary>
+struct BuildingRecord
+{
+    glm::vec3 position;     // Center of the building
+    float radius;           // Bounding sphere radius
+    glm::vec3 halfExtents;  // Half size of the AABB
+    std::uint32_t id;       // Index of the building in the simulation's building list
+};
+
+
+/// <summary>
+/// STATIC SORTED GRID OVER THE BUILDINGS (XZ PLANE), BUILT ONCE AFTER INIT.
+/// Every record is stored in the cell of its center, queries widen their range by the
+/// largest building reach, so a building is reported at most once per query.
+/// </summary>
+class BuildingIndex
+{
+public:
+    BuildingIndex();
+
+    /// Build the grid from the records, `cellSize` should be close to the building spacing.
+    void Build(const std::vector<BuildingRecord>& buildingRecords, float cellSize);
+
+    /// Call fn(record) for every building that may touch the sphere (XZ bounds only).
+    template <typename Fn>
+    void QuerySphere(const glm::vec3& center, float radius, Fn fn) const;
+
+    /// Same search as QuerySphere, stops at the first record for which pred(record) is true.
+    template <typename Pred>
+    bool AnySphere(const glm::vec3& center, float radius, Pred pred) const;
+
+    /// Stops at the first record that may touch the AABB and for which pred(record) is true.
+    template <typename Pred>
+    bool AnyBox(const glm::vec3& minBox, const glm::vec3& maxBox, Pred pred) const;
+
+    /// Collect the candidates of QuerySphere in building order (stable iteration).
+    void QuerySphereSorted(const glm::vec3& center, float radius, std::vector<const BuildingRecord*>& out) const;
+
+    const std::vector<BuildingRecord>& GetRecords() const { return records; }
+    bool IsEmpty() const { return records.empty(); }
+
+private:
+    template <typename Pred>
+    bool AnyInRange(float minX, float minZ, float maxX, float maxZ, Pred pred) const;
+
+    int CellX(float x) const { return std::min(numCellsX - 1, std::max(0, static_cast<int>(std::floor((x - originX) * invCellSize)))); }
+    int CellZ(float z) const { return std::min(numCellsZ - 1, std::max(0, static_cast<int>(std::floor((z - originZ) * invCellSize)))); }
+
+private:
+    float originX;          // World position of the first cell
+    float originZ;
+    float invCellSize;
+    float maxReach;         // Largest XZ distance from a building center to its bounds
+
+    int numCellsX;
+    int numCellsZ;
+
+    std::vector<std::uint32_t> cellStart;   // Offset of every cell in records (size cells + 1)
+    std::vector<BuildingRecord> records;    // Records sorted by cell
+};
+
+
+template <typename Pred>
+bool BuildingIndex::AnyInRange(float minX, float minZ, float maxX, float maxZ, Pred pred) const
+{
+    if (records.empty())
+    {
+        return false;
+    }
+
+    // Buildings centered outside the range can still reach inside it
+    int minCellX = CellX(minX - maxReach);
+    int maxCellX = CellX(maxX + maxReach);
+    int minCellZ = CellZ(minZ - maxReach);
+    int maxCellZ = CellZ(maxZ + maxReach);
+
+    for (int cz = minCellZ; cz <= maxCellZ; ++cz)
+    {
+        for (int cx = minCellX; cx <= maxCellX; ++cx)
+        {
+            int cell = cz * numCellsX + cx;
+            for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i)
+            {
+                if (pred(records[i]))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+template <typename Pred>
+bool BuildingIndex::AnySphere(const glm::vec3& center, float radius, Pred pred) const
+{
+    return AnyInRange(center.x - radius, center.z - radius, center.x + radius, center.z + radius, pred);
+}
+
+
+template <typename Fn>
+void BuildingIndex::QuerySphere(const glm::vec3& center, float radius, Fn fn) const
+{
+    AnySphere(center, radius, [&fn](const BuildingRecord& record) { fn(record); return false; });
+}
+
+
+template <typename Pred>
+bool BuildingIndex::AnyBox(const glm::vec3& minBox, const glm::vec3& maxBox, Pred pred) const
+{
+    return AnyInRange(minBox.x, minBox.z, maxBox.x, maxBox.z, pred);
+}
+
+#endif // BUILDING_INDEX_H
@@ -13,7 +13,7 @@
 /// <param name="player">Player-controlled tank.</param>
 /// <returns>True if collision is detected; otherwise, false.</returns>
 bool Buildings::CheckTankBuildingCollision(
-    const Building& building,
+    const BuildingRecord& building,
     PlayerTank& player)
 {
     // Combined radius of the tank and building
@@ -32,7 +32,7 @@ bool Buildings::CheckTankBuildingCollision(
 /// <param name="player">Player-controlled tank.</param>
 /// <returns>True if collision is detected; otherwise, false.</returns>
 void Buildings::SolveTankBuildingCollision(
-    const Building& building,
+    const BuildingRecord& building,
     PlayerTank& player)
 {
     // The orientation of the vehicle when collision happend!
@@ -53,56 +53,23 @@ void Buildings::SolveTankBuildingCollision(
 /// <summary>
 /// Update collision, check between a player-controlled tank and a vector of buildings.
 /// </summary>
-/// <param name="buildings">Vector of buildings in the game world.</param>
+/// <param name="buildings">Static index of the buildings in the game world.</param>
 /// <param name="player">Player-controlled tank.</param>
 void Buildings::UpdateTankBuildingCollision(
-    std::vector<Building>& buildings,
+    const BuildingIndex& buildings,
     PlayerTank& player)
 {
-    for (const Building& building : buildings)
+    // Only the buildings around the tank, the extra radius covers the pushes made in the loop
+    std::vector<const BuildingRecord*> nearby;
+    buildings.QuerySphereSorted(player.position, 2.0f * player.radius, nearby);
+
+    for (const BuildingRecord* building : nearby)
     {
-        if (CheckTankBuildingCollision(building, player))
+        if (CheckTankBuildingCollision(*building, player))
         {
             // Resolve collision with the building
-            SolveTankBuildingCollision(building, player);
+            SolveTankBuildingCollision(*building, player);
         }
     }
 }
 
-
-/// <summary>
-/// Update collision, check between projectiles and a vector of buildings.
-/// </summary>
-/// <param name="buildings">Vector of buildings in the game world.</param>
-/// <param name="projectiles">Veector of projectiles in the game world.</param>
-/// <param name="deltaTime">Time elapsed since the last update.</param>
-void Buildings::UpdateProjectileBuildingCollisiong(
-    std::vector<Building>& buildings,
-    std::vector<Projectile>& projectiles,
-    float deltaTime)
-{
-    for (auto projectileIt = projectiles.begin(); projectileIt != projectiles.end(); )
-    {
-        // Update the projectile's position based on its velocity and time
-        projectileIt->position += projectileIt->velocity * deltaTime;
-        bool collision = false;
-
-        // Check for collision with buildings
-        for (const auto& building : buildings)
-        {
-            if (Projectiles::ProjectileBuildingCollision(*projectileIt, building))
-            {
-                // Remove the projectile when a collision is detected
-                projectileIt = projectiles.erase(projectileIt);
-                collision = true;
-                break; // DON'T NEED TO CHECK OTHER BUILDINGS
-            }
-        }
-
-        if (!collision)
-        {
-            // No collision detected, move to the next projectile
-            ++projectileIt;
-        }
-    }
-}
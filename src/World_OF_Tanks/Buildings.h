@@ -5,10 +5,10 @@
 
 #include "Projectiles.h"
 #include "EnemyTanks.h"
+#include "BuildingIndex.h"
 
 #include <glm/gtc/constants.hpp>
 #include <glm/glm.hpp>
-#include <string>
 #include <vector>
 
 
@@ -17,18 +17,28 @@ struct PlayerTank;
 
 
 /// <summary>
-/// Represent a building in the game world with a position, scale, name, and collision radius.
+/// Represent a building in the game world with a position, scale, and collision radius.
+/// A building is identified by its index in the building list.
 /// </summary>
 struct Building {
     glm::vec3 position; // Position of the building
     glm::vec3 scale;    // Half-extents of the AABB (Axis-Aligned Bounding Box)
-    std::string name;   // A unique name for the building
     float radius;       // Collision radius of the building
 
     // Constructor for easy creation of Building objects
     Building(
-        const glm::vec3& pos,const glm::vec3& scl, const std::string& nm, const float radius)
-        : position(pos), scale(scl), name(nm), radius(radius) {}
+        const glm::vec3& pos,const glm::vec3& scl, const float radius)
+        : position(pos), scale(scl), radius(radius) {}
+
+    /// Compact collision record of the building, `id` is its index in the building list.
+    BuildingRecord GetRecord(std::uint32_t id) const {
+        BuildingRecord record;
+        record.position = position;
+        record.radius = radius;
+        record.halfExtents = scale * 0.5f;
+        record.id = id;
+        return record;
+    }
 
     /// <summary>
     /// Check if a point is inside the building's AABB (Axis-Aligned Bounding Box).
@@ -50,28 +60,21 @@ class Buildings {
 public:
     /// Resolve collision between a tank and a building, adjusting the tank's position if needed.
     static void SolveTankBuildingCollision(
-        const Building& building,
+        const BuildingRecord& building,
         PlayerTank& player
     );
 
     /// Checks for collision between the player's tank and a specific building.
     static bool CheckTankBuildingCollision(
-        const Building& building,
+        const BuildingRecord& building,
         PlayerTank& player
     );
 
     /// Update collision, check between the player's tank and buildings.
     static void UpdateTankBuildingCollision(
-        std::vector<Building>& buildings,
+        const BuildingIndex& buildings,
         PlayerTank& player
     );
-
-    /// Update collision, check between projectiles and buildings.
-    static void UpdateProjectileBuildingCollisiong(
-        std::vector<Building>& buildings,
-        std::vector<Projectile>& projectiles,
-        float deltaTime
-    );
 };
 
 #endif // BUILDINGS_H
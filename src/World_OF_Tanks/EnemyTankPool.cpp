@@ -0,0 +1,138 @@
+#include "EnemyTankPool.h"
+#include "EnemyTanks.h"
+
+
+/// <summary>
+/// Scatter an enemy tank into the hot arrays and the cold side table.
+/// </summary>
+/// <param name="tank">Initial state of the tank.</param>
+/// <returns>Index of the new tank in the pool.</returns>
+std::size_t EnemyTankPool::Add(const EnemyTank& tank)
+{
+    positionX.push_back(tank.position.x);
+    positionY.push_back(tank.position.y);
+    positionZ.push_back(tank.position.z);
+    radius.push_back(tank.radius);
+    rotation.push_back(tank.rotation);
+    turretRotation.push_back(tank.turretRotation);
+
+    movementPattern.push_back(tank.movementPattern);
+    movementTimer.push_back(tank.movementTimer);
+    timeSinceLastShot.push_back(tank.timeSinceLastShot);
+
+    health.push_back(tank.health);
+    sinkSpeed.push_back(tank.sinkSpeed);
+    sinkDepth.push_back(tank.sinkDepth);
+
+    isRenderable.push_back(tank.isRenderable ? 1 : 0);
+    isDestroyed.push_back(tank.isDestroyed ? 1 : 0);
+
+    nextPositionX.push_back(tank.position.x);
+    nextPositionZ.push_back(tank.position.z);
+    isMoveBlocked.push_back(0);
+
+    EnemyTankCold coldState;
+    coldState.direction = tank.direction;
+    coldState.deformationLevel = tank.deformationLevel;
+    coldState.isPlayerInRange = tank.isPlayerInRange;
+    cold.push_back(coldState);
+
+    return Size() - 1;
+}
+
+
+/// <summary>
+/// Gather a tank from the pool arrays.
+/// </summary>
+/// <param name="index">Index of the tank.</param>
+/// <returns>Copy of the tank's state.</returns>
+EnemyTank EnemyTankPool::Get(std::size_t index) const
+{
+    EnemyTank tank;
+
+    tank.position = GetPosition(index);
+    tank.direction = cold[index].direction;
+    tank.radius = radius[index];
+    tank.rotation = rotation[index];
+    tank.turretRotation = turretRotation[index];
+
+    tank.movementPattern = movementPattern[index];
+    tank.movementTimer = movementTimer[index];
+
+    tank.health = health[index];
+    tank.sinkSpeed = sinkSpeed[index];
+    tank.sinkDepth = sinkDepth[index];
+
+    tank.isRenderable = isRenderable[index] != 0;
+    tank.isDestroyed = isDestroyed[index] != 0;
+
+    tank.isPlayerInRange = cold[index].isPlayerInRange;
+    tank.timeSinceLastShot = timeSinceLastShot[index];
+    tank.deformationLevel = cold[index].deformationLevel;
+
+    return tank;
+}
+
+
+/// <summary>
+/// Reserve room for `capacity` tanks in every array.
+/// </summary>
+/// <param name="capacity">Number of tanks.</param>
+void EnemyTankPool::Reserve(std::size_t capacity)
+{
+    positionX.reserve(capacity);
+    positionY.reserve(capacity);
+    positionZ.reserve(capacity);
+    radius.reserve(capacity);
+    rotation.reserve(capacity);
+    turretRotation.reserve(capacity);
+
+    movementPattern.reserve(capacity);
+    movementTimer.reserve(capacity);
+    timeSinceLastShot.reserve(capacity);
+
+    health.reserve(capacity);
+    sinkSpeed.reserve(capacity);
+    sinkDepth.reserve(capacity);
+
+    isRenderable.reserve(capacity);
+    isDestroyed.reserve(capacity);
+
+    nextPositionX.reserve(capacity);
+    nextPositionZ.reserve(capacity);
+    isMoveBlocked.reserve(capacity);
+
+    cold.reserve(capacity);
+}
+
+
+/// <summary>
+/// Remove all the tanks.
+/// </summary>
+void EnemyTankPool::Clear()
+{
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    radius.clear();
+    rotation.clear();
+    turretRotation.clear();
+
+    movementPattern.clear();
+    movementTimer.clear();
+    timeSinceLastShot.clear();
+
+    health.clear();
+    sinkSpeed.clear();
+    sinkDepth.clear();
+
+    isRenderable.clear();
+    isDestroyed.clear();
+
+    nextPositionX.clear();
+    nextPositionZ.clear();
+    isMoveBlocked.clear();
+    neighbours.clear();
+
+    cold.clear();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef ENEMY_TANK_POOL_H
+#define ENEMY_TANK_POOL_H
+
+#include "SpatialGrid.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+struct EnemyTank;
+
+
+/// <summary>
+/// Rarely touched state of an enemy tank, kept out of the per-tick arrays.
+/// </summary>
+struct EnemyTankCold
+{
+    glm::vec3 direction;       // Direction the tank is facing
+    float deformationLevel;    // Level of tank deformation (written on hits only)
+    bool isPlayerInRange;      // Player is in range
+};
+
+
+/// <summary>
+/// ENEMY TANKS STORED AS STRUCTURE OF ARRAYS.
+/// Every field read or written each tick lives in its own contiguous array, so the
+/// movement, turret and sinking passes are plain loops over floats the compiler can
+/// vectorize. The cold state sits in a side table indexed the same way.
+/// A tank is identified by its index, tanks are never removed during a round.
+/// </summary>
+class EnemyTankPool
+{
+public:
+    /// Append a tank, returns its index.
+    std::size_t Add(const EnemyTank& tank);
+    /// Gather the tank at `index` back into an EnemyTank (tools and debugging).
+    EnemyTank Get(std::size_t index) const;
+
+    void Reserve(std::size_t capacity);
+    void Clear();
+
+    std::size_t Size() const { return positionX.size(); }
+    bool Empty() const { return positionX.empty(); }
+
+    glm::vec3 GetPosition(std::size_t index) const
+    {
+        return glm::vec3(positionX[index], positionY[index], positionZ[index]);
+    }
+    void SetPosition(std::size_t index, const glm::vec3& position)
+    {
+        positionX[index] = position.x;
+        positionY[index] = position.y;
+        positionZ[index] = position.z;
+    }
+
+public:
+    /// HOT: read or written every tick
+    std::vector<float> positionX;          // Position of the tank
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> radius;             // Radius of the tank
+    std::vector<float> rotation;           // Rotation angle of the tank's body
+    std::vector<float> turretRotation;     // Rotation angle of the tank's turret
+
+    std::vector<std::int32_t> movementPattern; // Pattern for tank's movement
+    std::vector<float> movementTimer;      // Timer for movement pattern
+    std::vector<float> timeSinceLastShot;  // Time elapsed since the last shot
+
+    std::vector<std::int32_t> health;      // Tank's health
+    std::vector<float> sinkSpeed;          // Speed tank sinks
+    std::vector<float> sinkDepth;          // Depth tank sinks
+
+    std::vector<std::uint8_t> isRenderable;    // Tank should be rendered
+    std::vector<std::uint8_t> isDestroyed;     // Tank is destroyed
+
+    /// SCRATCH: position each tank wants to move to this tick
+    std::vector<float> nextPositionX;
+    std::vector<float> nextPositionZ;
+    std::vector<std::uint8_t> isMoveBlocked;   // The move hits a building or a tank
+    std::vector<NeighbourBlock> neighbours;    // Tanks around every tank, gathered by the collision passes
+
+    /// COLD: side table, same indices as the hot arrays
+    std::vector<EnemyTankCold> cold;
+};
+
+#endif // ENEMY_TANK_POOL_H
@@ -1,30 +1,80 @@
 #include "EnemyTanks.h"
 #include "Buildings.h"
 #include "Projectiles.h"
+#include "GameConstants.h"
+#include "SphereKernels.h"
 
+#include "core/jobs/job_system.h"
 #include "utils/glm_utils.h"
 #include "utils/math_utils.h"
+#include "utils/random_utils.h"
 
 #include <glm/gtc/constants.hpp>
+#include <algorithm>
 #include <iostream>
 
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 
+namespace
+{
+    // Distance a moving tank keeps from the other tanks, on top of its radius
+    const float tankMoveClearance = 2.0f; // Adjust this based on your game's scale and tank size
+
+
+    /// <summary>
+    /// Gather the neighbour lists of `count` entities as parallel jobs, the entity of slot s
+    /// is order(s). The slots are cut in fixed blocks, not in the ranges of the job system,
+    /// so the lists are the same whatever the thread count. gather(i, out) appends the
+    /// neighbours of entity i to out.
+    /// </summary>
+    template <typename Order, typename Gather>
+    void GatherNeighbours(std::size_t count, Order order, std::vector<NeighbourBlock>& blocks, JobSystem& jobs,
+                          Gather gather)
+    {
+        const std::size_t blockSize = static_cast<std::size_t>(jobQueryGrainSize);
+        blocks.resize((count + blockSize - 1) / blockSize);
+
+        jobs.ParallelFor(0, blocks.size(), 1, [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t b = first; b < last; ++b)
+            {
+                NeighbourBlock& block = blocks[b];
+                block.entities.clear();
+                block.offsets.clear();
+                block.indices.clear();
+
+                const std::size_t end = std::min(count, (b + 1) * blockSize);
+                for (std::size_t slot = b * blockSize; slot < end; ++slot)
+                {
+                    const std::uint32_t entity = order(slot);
+                    block.entities.push_back(entity);
+                    block.offsets.push_back(static_cast<std::uint32_t>(block.indices.size()));
+                    gather(entity, block.indices);
+                }
+                block.offsets.push_back(static_cast<std::uint32_t>(block.indices.size()));
+            }
+        });
+    }
+}
+
+
 /// <summary>
 /// Check for collision between two enemy tanks.
 /// </summary>
-/// <param name="tank1">The first enemy tank.</param>
-/// <param name="tank2">The second enemy tank.</param>
+/// <param name="position1">Position of the first enemy tank.</param>
+/// <param name="radius1">Radius of the first enemy tank.</param>
+/// <param name="position2">Position of the second enemy tank.</param>
+/// <param name="radius2">Radius of the second enemy tank.</param>
 /// <returns>True if collision is detected; otherwise, false.</returns>
 bool EnemyTanks::TankTankCollision(
-    const EnemyTank& tank1,
-    const EnemyTank& tank2) 
+    const glm::vec3& position1, float radius1,
+    const glm::vec3& position2, float radius2)
 {
-    // Calculate the distance between the two tank positions
-    return glm::distance(tank1.position, tank2.position) < 
-                        (tank1.radius + tank2.radius);
+    // Compare the squared distance between the two tank positions, no sqrt
+    float reach = radius1 + radius2;
+    return glm::distance2(position1, position2) < reach * reach;
 }
 
 
@@ -32,44 +82,48 @@ bool EnemyTanks::TankTankCollision(
 /// Check for collision between a player-controlled tank and an enemy tank.
 /// </summary>
 /// <param name="player">The player-controlled tank.</param>
-/// <param name="enemyTank">The enemy tank to check for collision with.</param>
+/// <param name="tankPosition">Position of the enemy tank to check for collision with.</param>
+/// <param name="tankRadius">Radius of the enemy tank.</param>
 /// <returns>True if collision is detected; otherwise, false.</returns>
 bool EnemyTanks::TankPlayerCollision(
     const PlayerTank& player,
-    const EnemyTank& enemyTank)
+    const glm::vec3& tankPosition,
+    float tankRadius)
 {
-    // Calculate the distance between the player tank and the enemy tank positions
-    return glm::distance(player.position, enemyTank.position) < 
-                        (player.radius + enemyTank.radius);
+    // Compare the squared distance between the player tank and the enemy tank positions
+    float reach = player.radius + tankRadius;
+    return glm::distance2(player.position, tankPosition) < reach * reach;
 }
 
 
 /// <summary>
 /// Check for collision between an enemy tank and a building, and resolve it if detected.
-/// <param name="tank">The enemy tank to check for collision.</param>
+/// <param name="tankPosition">Position of the enemy tank, moved out of the building.</param>
+/// <param name="tankRadius">Radius of the enemy tank.</param>
 /// <param name="building">The building to check for collision with.</param>
 /// <returns>True if collision is detected and resolved; otherwise, false.</returns>
 bool EnemyTanks::TankBuildingCollision(
-    EnemyTank& tank,
-    Building& building)
+    glm::vec3& tankPosition,
+    float tankRadius,
+    const BuildingRecord& building)
 {
     // Calculate the combined radius of the tank and building
-    float combinedRadius = tank.radius + 1.1f + building.radius;
+    float combinedRadius = tankRadius + 1.1f + building.radius;
     // Calculate the squared distance between the tank and building
-    float distanceSqr = glm::distance2(tank.position, building.position);
+    float distanceSqr = glm::distance2(tankPosition, building.position);
 
     // Check if the squared distance is less than the squared combined radius
     if (distanceSqr < (combinedRadius * combinedRadius))
     {
         // Calculate the direction from the tank to the building
-        glm::vec3 collisionDir = glm::normalize(tank.position - building.position);
+        glm::vec3 collisionDir = glm::normalize(tankPosition - building.position);
         float penetrationDepth = combinedRadius - glm::sqrt(distanceSqr);
 
         // Calculate the displacement vector to resolve the collision
         // Move the tank away from the building to resolve the collision
         glm::vec3 displacement = penetrationDepth * collisionDir;
         displacement.y = 0;
-        tank.position += displacement;
+        tankPosition += displacement;
 
         // Return true to indicate a collision
         return true;
@@ -82,26 +136,33 @@ bool EnemyTanks::TankBuildingCollision(
 
 /// <summary>
 /// Update sinking depth and renderability of destroyed enemy tanks.
+/// Branch free so the loop vectorizes: alive tanks add a zero depth.
+/// Every tank only touches its own entries, the ranges run as parallel jobs.
 /// </summary>
-/// <param name="enemies">Vector of enemy tanks.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
 /// <param name="deltaTime">Time elapsed since the last update.</param>
+/// <param name="jobs">Job system running the ranges of tanks.</param>
 void EnemyTanks::UpdateSinkingTanks(
-    std::vector<EnemyTank>& enemies,
-    float deltaTime)
+    EnemyTankPool& enemies,
+    float deltaTime,
+    JobSystem& jobs)
 {
-    for (auto& tank : enemies)
+    const std::uint8_t* isDestroyed = enemies.isDestroyed.data();
+    const float* sinkSpeed = enemies.sinkSpeed.data();
+    float* sinkDepth = enemies.sinkDepth.data();
+    std::uint8_t* isRenderable = enemies.isRenderable.data();
+
+    jobs.ParallelFor(0, enemies.Size(), jobGrainSize, [&](std::size_t begin, std::size_t end)
     {
-        if (tank.isDestroyed)
+        for (std::size_t i = begin; i < end; ++i)
         {
             // Update sinking depth
-            tank.sinkDepth += deltaTime * tank.sinkSpeed;
+            sinkDepth[i] += deltaTime * sinkSpeed[i] * static_cast<float>(isDestroyed[i]);
             // Make tank non-renderable once it has sunk ENOUGH
-            if (tank.sinkDepth >= 1.f)
-            {
-                tank.isRenderable = false;
-            }
+            std::uint8_t sunk = static_cast<std::uint8_t>(isDestroyed[i] & (sinkDepth[i] >= 1.f));
+            isRenderable[i] = static_cast<std::uint8_t>(isRenderable[i] & (sunk ^ 1));
         }
-    }
+    });
 }
 
 
@@ -131,105 +192,196 @@ glm::vec3 CalculateCollisionDisplacement(
 }
 
 
+/// <summary>
+/// Rebuild the broadphase grid from the current enemy positions.
+/// </summary>
+/// <param name="grid">Grid to rebuild.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
+void EnemyTanks::BuildTankGrid(
+    SpatialGrid& grid,
+    const EnemyTankPool& enemies)
+{
+    grid.Build(enemies.Size(), enemies.positionX.data(), enemies.positionZ.data(), sizeof(float));
+}
+
+
 /// <summary>
 /// Update tank collisions with the player and other enemy tanks and apply smoothing to positions.
+/// The pairs of tanks close enough to touch are gathered first, as parallel jobs reading the
+/// positions at the start of the pass. The pushes are then applied in one serial pass, every
+/// pair tested again on the current positions. Both walk the tanks in the grid order, which
+/// only depends on the positions (the result doesn't depend on the thread count) and keeps
+/// the nearby tanks in the cache. The grid slack bounds how far a tank is pushed in the pass.
 /// </summary>
-/// <param name="enemies">Vector of enemy tanks.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
 /// <param name="player">Player tank.</param>
+/// <param name="grid">Grid built from the enemy positions at the start of the pass.</param>
+/// <param name="jobs">Job system gathering the pairs.</param>
 void EnemyTanks::UpdateTankCollisions(
-    std::vector<EnemyTank>& enemies,
-    PlayerTank& player)
+    EnemyTankPool& enemies,
+    PlayerTank& player,
+    const SpatialGrid& grid,
+    JobSystem& jobs)
 {
     float smoothingFactor = 0.1f;
 
-    for (auto& enemy1 : enemies)
+    // Largest tank radius, bounds the distance at which two tanks can touch
+    float maxRadius = 0.0f;
+    for (float radius : enemies.radius)
     {
-        // Store the previous position before handling collisions
-        glm::vec3 prevPos = enemy1.position;
+        maxRadius = std::max(maxRadius, radius);
+    }
 
-        // Handle player and enemy tank collisions
-        if (TankPlayerCollision(player, enemy1))
+    // Neighbours of every tank that overlap it or are within the slack of it
+    const float slack = grid.GetSlack();
+    auto gridOrder = [&grid](std::size_t slot) { return grid.GetEntity(slot); };
+    GatherNeighbours(enemies.Size(), gridOrder, enemies.neighbours, jobs, [&](std::size_t i, std::vector<std::uint32_t>& out)
+    {
+        const glm::vec3 position1 = enemies.GetPosition(i);
+        const float radius1 = enemies.radius[i];
+
+        // Batched squared distance test of the grid candidates, the tank itself is dropped after
+        std::size_t first = out.size();
+        grid.Collect(position1, radius1 + maxRadius, out);
+        std::size_t numHits = SphereKernels::FilterSpheres(position1, radius1 + slack,
+            enemies.positionX.data(), enemies.positionY.data(), enemies.positionZ.data(), enemies.radius.data(),
+            out.data() + first, out.size() - first);
+        out.resize(first + numHits);
+        out.erase(std::remove(out.begin() + first, out.end(), static_cast<std::uint32_t>(i)), out.end());
+    });
+
+    // BARRIER: the pushes move shared tanks and the player, applied one tank after the other
+    for (const NeighbourBlock& block : enemies.neighbours)
+    {
+        for (std::size_t k = 0; k < block.entities.size(); ++k)
         {
-            glm::vec3 diff = enemy1.position - player.position;
-            float distance = glm::length(diff);
-            float overlap = (player.radius + enemy1.radius) - distance;
+            const std::size_t i = block.entities[k];
+            glm::vec3 position1 = enemies.GetPosition(i);
+            const float radius1 = enemies.radius[i];
+
+            // Store the previous position before handling collisions
+            glm::vec3 prevPos = position1;
 
-            if (overlap > 0)
+            // Handle player and enemy tank collisions
+            if (TankPlayerCollision(player, position1, radius1))
             {
-                glm::vec3 displacement = glm::normalize(diff) * (overlap * 0.5f);
-                player.position -= displacement;
-                enemy1.position += displacement;
+                glm::vec3 diff = position1 - player.position;
+                float distance = glm::length(diff);
+                float overlap = (player.radius + radius1) - distance;
+
+                if (overlap > 0)
+                {
+                    glm::vec3 displacement = glm::normalize(diff) * (overlap * 0.5f);
+                    player.position -= displacement;
+                    position1 += displacement;
+                }
             }
-        }
 
-        // Handle collisions among enemy tanks
-        for (auto& enemy2 : enemies)
-        {
-            if (&enemy1 != &enemy2 && TankTankCollision(enemy1, enemy2))
+            // Handle collisions among the nearby enemy tanks
+            for (std::uint32_t n = block.offsets[k]; n < block.offsets[k + 1]; ++n)
             {
-                glm::vec3 dif = enemy2.position - enemy1.position;
-                float distance = glm::length(dif);
-                float overlap = (enemy1.radius + enemy2.radius) - distance;
+                const std::uint32_t j = block.indices[n];
+                glm::vec3 position2 = enemies.GetPosition(j);
+                const float radius2 = enemies.radius[j];
 
-                if (overlap > 0)
+                if (TankTankCollision(position1, radius1, position2, radius2))
                 {
-                    glm::vec3 displacement = glm::normalize(dif) * (overlap * 0.5f);
-                    enemy1.position -= displacement;
-                    enemy2.position += displacement;
+                    glm::vec3 dif = position2 - position1;
+                    float distance = glm::length(dif);
+                    float overlap = (radius1 + radius2) - distance;
+
+                    if (overlap > 0)
+                    {
+                        glm::vec3 displacement = glm::normalize(dif) * (overlap * 0.5f);
+                        position1 -= displacement;
+                        enemies.SetPosition(j, position2 + displacement);
+                    }
                 }
             }
-        }
 
-        // Calculate the smooth displacement
-        glm::vec3 smoothDisplace = enemy1.position - prevPos;
+            // Calculate the smooth displacement
+            glm::vec3 smoothDisplace = position1 - prevPos;
 
-        // Apply smoothing to the positions
-        enemy1.position -= smoothDisplace * smoothingFactor;
-        player.position += smoothDisplace * smoothingFactor;
+            // Apply smoothing to the positions
+            enemies.SetPosition(i, position1 - smoothDisplace * smoothingFactor);
+            player.position += smoothDisplace * smoothingFactor;
+        }
     }
 }
 
 
 /// <summary>
 /// Update tank collisions with buildings and apply smoothing to positions.
+/// A tank is only pushed by the buildings, never by the other tanks, so the
+/// ranges of tanks run as parallel jobs.
 /// </summary>
-/// <param name="tanks">Vector of enemy tanks.</param>
-/// <param name="buildings">Vector of buildings.</param>
+/// <param name="tanks">Pool of enemy tanks.</param>
+/// <param name="buildings">Static index of the buildings.</param>
+/// <param name="jobs">Job system running the ranges of tanks.</param>
 void EnemyTanks::UpdateTankCollisionsWithBuildings(
-    std::vector<EnemyTank>& tanks,
-    std::vector<Building>& buildings)
+    EnemyTankPool& tanks,
+    const BuildingIndex& buildings,
+    JobSystem& jobs)
+{
+    jobs.ParallelFor(0, tanks.Size(), jobQueryGrainSize, [&](std::size_t begin, std::size_t end)
+    {
+        ResolveTankBuildingCollisions(tanks, buildings, begin, end);
+    });
+}
+
+
+/// <summary>
+/// Push the tanks [begin, end) out of the buildings around them.
+/// </summary>
+/// <param name="tanks">Pool of enemy tanks.</param>
+/// <param name="buildings">Static index of the buildings.</param>
+/// <param name="begin">First tank of the range.</param>
+/// <param name="end">End of the range (excluded).</param>
+void EnemyTanks::ResolveTankBuildingCollisions(
+    EnemyTankPool& tanks,
+    const BuildingIndex& buildings,
+    std::size_t begin,
+    std::size_t end)
 {
     float smoothingFactor = 0.1f;
+    std::vector<const BuildingRecord*> nearby;
 
-    for (EnemyTank& tank : tanks)
+    for (std::size_t i = begin; i < end; ++i)
     {
+        glm::vec3 position = tanks.GetPosition(i);
+        const float radius = tanks.radius[i];
+
         // Store the previous position before handling collisions
-        glm::vec3 previousPosition = tank.position;
+        glm::vec3 previousPosition = position;
         // Total displacement due to collisions with buildings
         glm::vec3 totalDisplacement(0.0f);
 
-        for (Building& building : buildings)
+        // Only the buildings around the tank, the extra tank radius covers the pushes made in the loop
+        buildings.QuerySphereSorted(position, 2.0f * radius + 1.1f, nearby);
+
+        for (const BuildingRecord* nearbyBuilding : nearby)
         {
-            if (TankBuildingCollision(tank, building))
+            const BuildingRecord& building = *nearbyBuilding;
+            if (TankBuildingCollision(position, radius, building))
             {
-                glm::vec3 diff = tank.position - building.position;
+                glm::vec3 diff = position - building.position;
                 float distance = glm::length(diff);
-                float overlap = (tank.radius + building.radius) - distance;
+                float overlap = (radius + building.radius) - distance;
 
                 if (overlap > 0)
                 {
                     glm::vec3 displacement = glm::normalize(diff) * (overlap * 0.5f);
-                    tank.position -= displacement;
+                    position -= displacement;
                     totalDisplacement += displacement;
                 }
             }
         }
 
         // Apply the total displacement to the tank's position
-        tank.position += totalDisplacement;
-        glm::vec3 smoothDisplacement = tank.position - previousPosition;
+        position += totalDisplacement;
+        glm::vec3 smoothDisplacement = position - previousPosition;
         // Apply smoothing to the positions
-        tank.position -= smoothDisplacement * smoothingFactor;
+        tanks.SetPosition(i, position - smoothDisplacement * smoothingFactor);
     }
 }
 
@@ -237,31 +389,34 @@ void EnemyTanks::UpdateTankCollisionsWithBuildings(
 /// <summary>
 /// Fire a projectile from an enemy tank if the turret is aligned with the player.
 /// </summary>
-/// <param name="enemy">Enemy tank firing the projectile.</param>
-/// <param name="projectiles">Vector containing the projectiles in the game world.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
+/// <param name="index">Enemy tank firing the projectile.</param>
+/// <param name="projectiles">Pool of the projectiles in the game world.</param>
 /// <param name="playerPos">Position of the player-controlled tank.</param>
 void EnemyTanks::FireProjectile(
-    EnemyTank& enemy,
-    std::vector<Projectile>& projectiles,
+    const EnemyTankPool& enemies,
+    std::size_t index,
+    ProjectilePool& projectiles,
     const glm::vec3& playerPos)
 {
     float turretLength = 1.0f;
+    glm::vec3 enemyPosition = enemies.GetPosition(index);
 
     // X and Z coords for turret direction based on the turret rotation
-    float turretDirectionX = cos(enemy.turretRotation);
-    float turretDirectionZ = sin(enemy.turretRotation);
+    float turretDirectionX = cos(enemies.turretRotation[index]);
+    float turretDirectionZ = sin(enemies.turretRotation[index]);
 
     // Create a normalized turret direction vector in the XZ plane (ignoring the Y-axis)
     glm::vec3 turretDirection = glm::vec3(turretDirectionX, 0.0f, turretDirectionZ);
     // Calculate the direction from the enemy tank to the player tank and normalize it
-    glm::vec3 directionToPlayer = glm::normalize(playerPos - enemy.position);
+    glm::vec3 directionToPlayer = glm::normalize(playerPos - enemyPosition);
 
     // Firing logic - only fire if the turret is aligned with the player
     // within a 10-degree firing OPEN RANGE CONE
     if (glm::dot(turretDirection, directionToPlayer) > cos(glm::radians(10.0f)))
     {
         // Adjust the turret tip position based on the size of your tank model
-        glm::vec3 turretTipPosition = enemy.position + turretDirection * turretLength;
+        glm::vec3 turretTipPosition = enemyPosition + turretDirection * turretLength;
 
         // Initial position for the projectile at the tip of the turret
         glm::vec3 worldCannonTip = turretTipPosition;
@@ -274,13 +429,13 @@ void EnemyTanks::FireProjectile(
         Projectile newProjectile;
 
         newProjectile.position = worldCannonTip;            // START PROJECTILE POSITION
-        newProjectile.velocity = velocityDirection * 2.5f;  // SPEED PROJECTILE
+        newProjectile.velocity = velocityDirection * 5.0f;  // SPEED PROJECTILE (moved once per tick)
 
         newProjectile.lifespan = 0.0f;                      // START PROJECTILE FIRE
         newProjectile.maxLifespan = 10.0f;                  // TIME SPAN UNTIL HE DISSAPEAR
         newProjectile.radius = 0.10f;                       // RADIUS OF THE PROJECTILE
 
-        projectiles.push_back(newProjectile);
+        projectiles.Add(newProjectile);
     }
 }
 
@@ -288,30 +443,32 @@ void EnemyTanks::FireProjectile(
 /// <summary>
 /// Attempt to fire a projectile at the player if the turret alignment threshold is met.
 /// </summary>
-/// <param name="enemy">Enemy tank attempting to fire.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
+/// <param name="index">Enemy tank attempting to fire.</param>
 /// <param name="deltaTime">Elapsed since the last frame.</param>
 /// <param name="targetRotation">Desired rotation of the turret.</param>
 /// <param name="fireAlignmentThreshold">Threshold for turret alignment before firing.</param>
 /// <param name="playerPos">Player's position.</param>
-/// <param name="projectiles">Vector of projectiles.</param>
+/// <param name="projectiles">Pool of projectiles.</param>
 void EnemyTanks::TryFireAtPlayer(
-    EnemyTank& enemy,
+    const EnemyTankPool& enemies,
+    std::size_t index,
     float deltaTime,
 
     float targetRotation,
     float fireAlignmentThreshold,
-    
-    glm::vec3& playerPos,
-    std::vector<Projectile>& projectiles)
+
+    const glm::vec3& playerPos,
+    ProjectilePool& projectiles)
 {
     // ABS difference in rotation between the enemy's turret and the target rotation.
-    float rotationDiff = glm::abs(targetRotation - enemy.turretRotation);
+    float rotationDiff = glm::abs(targetRotation - enemies.turretRotation[index]);
 
     // Normalize the rotation
     if (rotationDiff > 180.0f) rotationDiff -= 360.0f;
 
     // ABS rotation difference is within the specified alignment threshold.
-    if (glm::abs(rotationDiff) <= fireAlignmentThreshold) FireProjectile(enemy, projectiles, playerPos);
+    if (glm::abs(rotationDiff) <= fireAlignmentThreshold) FireProjectile(enemies, index, projectiles, playerPos);
 }
 
 
@@ -335,102 +492,208 @@ float EnemyTanks::RotateTowards(
 
 
 /// <summary>
-/// Update the turret rotation of an enemy tank and fire projectiles if conditions are met.
+/// Smoothly rotate the turrets of the alive enemy tanks towards the player.
+/// One tight loop over the position and turret arrays, dead tanks keep their rotation.
 /// </summary>
-/// <param name="enemy">Enemy tank whose turret is to be updated.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
 /// <param name="deltaTime">Time elapsed since the last update.</param>
 /// <param name="playerPos">Position of the player-controlled tank.</param>
-/// <param name="fireRate">Rate at which the enemy tank can fire projectiles.</param>
-/// <param name="projectiles">Vector containing the projectiles fired by enemy tanks.</param>
-void EnemyTanks::UpdateTurretAndFire(
-    EnemyTank& enemy,
+/// <param name="jobs">Job system running the ranges of tanks.</param>
+void EnemyTanks::UpdateTurrets(
+    EnemyTankPool& enemies,
     float deltaTime,
     const glm::vec3& playerPos,
-    float fireRate,
-    std::vector<Projectile>& projectiles)
+    JobSystem& jobs)
 {
-    // Enemy tank is still alive
-    if (enemy.health > 0)
+    const float* positionX = enemies.positionX.data();
+    const float* positionZ = enemies.positionZ.data();
+    const std::int32_t* health = enemies.health.data();
+    float* turretRotation = enemies.turretRotation.data();
+
+    jobs.ParallelFor(0, enemies.Size(), jobGrainSize, [&](std::size_t begin, std::size_t end)
     {
-        // Angle towards the player tank
-        glm::vec3 directionToPlayer = playerPos - enemy.position;
-        float desiredTurretRotation = M_PI - atan2(directionToPlayer.z, directionToPlayer.x);
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            // Angle towards the player tank
+            float directionX = playerPos.x - positionX[i];
+            float directionZ = playerPos.z - positionZ[i];
+            float desiredTurretRotation = static_cast<float>(M_PI - atan2(directionZ, directionX));
+
+            // Smoothly adjust the turret rotation, only while the tank is still alive
+            float rotated = RotateTowards(turretRotation[i], desiredTurretRotation, deltaTime * 2.0f);
+            turretRotation[i] = health[i] > 0 ? rotated : turretRotation[i];
+        }
+    });
+}
 
-        // Smoothly adjust the turret rotation
-        enemy.turretRotation = RotateTowards(enemy.turretRotation, desiredTurretRotation, deltaTime * 2.0f);
 
-        // Fire at the player if the turret is aligned with the player
-        // and the fire rate cooldown has passed
-        if (enemy.timeSinceLastShot >= fireRate)
+/// <summary>
+/// Update the fire cooldowns of the enemy tanks and fire projectiles if conditions are met.
+/// </summary>
+/// <param name="enemies">Pool of enemy tanks.</param>
+/// <param name="deltaTime">Time elapsed since the last update.</param>
+/// <param name="player">Player-controlled tank, the target.</param>
+/// <param name="fireRate">Rate at which the enemy tank can fire projectiles.</param>
+/// <param name="fireAlignmentThreshold">Alignment threshold for firing at the player.</param>
+/// <param name="targetRotation">Target rotation of enemy tanks.</param>
+/// <param name="projectiles">Pool of the projectiles fired by enemy tanks.</param>
+void EnemyTanks::UpdateFire(
+    EnemyTankPool& enemies,
+    float deltaTime,
+    const PlayerTank& player,
+    float fireRate,
+    float fireAlignmentThreshold,
+    float targetRotation,
+    ProjectilePool& projectiles)
+{
+    for (std::size_t i = 0; i < enemies.Size(); ++i)
+    {
+        // Enemy tank is still alive
+        if (enemies.health[i] > 0)
         {
-            FireProjectile(enemy, projectiles, playerPos);
-            // Reset the fire delay timer
-            enemy.timeSinceLastShot = 0;
+            // Fire at the player if the turret is aligned with the player
+            // and the fire rate cooldown has passed
+            if (enemies.timeSinceLastShot[i] >= fireRate)
+            {
+                FireProjectile(enemies, i, projectiles, player.position);
+                // Reset the fire delay timer
+                enemies.timeSinceLastShot[i] = 0;
+            }
+            else
+            {
+                // Time pass, can't shoot for now!
+                enemies.timeSinceLastShot[i] += deltaTime;
+            }
         }
-        else
+
+        if (enemies.cold[i].isPlayerInRange && player.health > 0)
         {
-            // Time pass, can't shoot for now!
-            enemy.timeSinceLastShot += deltaTime;
+            TryFireAtPlayer(enemies, i, deltaTime, targetRotation,
+                   fireAlignmentThreshold, player.position, projectiles);
         }
+
+        enemies.timeSinceLastShot[i] += deltaTime;
     }
 }
 
 
 /// <summary>
 /// Randomly change the movement pattern of an enemy tank.
+/// The pattern only depends on (seed, tank, tick), tanks can be changed in any order.
 /// </summary>
-/// <param name="enemy">Enemy tank to change the pattern for.</param>
-void EnemyTanks::ChangeMovementPattern(EnemyTank& enemy)
+/// <param name="enemies">Pool of enemy tanks.</param>
+/// <param name="index">Enemy tank to change the pattern for.</param>
+/// <param name="seed">Seed of the simulation.</param>
+/// <param name="tick">Current tick of the simulation.</param>
+void EnemyTanks::ChangeMovementPattern(
+    EnemyTankPool& enemies,
+    std::size_t index,
+    std::uint64_t seed,
+    std::uint64_t tick)
 {
     // Randomly change the movement pattern
     // Assuming 4 different patterns (0-3)
-    enemy.movementPattern = std::rand() % 4;
+    enemies.movementPattern[index] = random_utils::UniformInt(seed, RANDOM_STREAM_BLOCKED_PATTERN, index, tick, 4);
 }
 
 
 /// <summary>
-/// Handle the movement logic for an enemy tank based on its current movement pattern.
+/// Count down the movement timers, expired tanks get a new random pattern.
+/// A timer that ran out on an earlier tick is reset instead of counting down, so a
+/// new pattern starts on the tick after the timer expired.
+/// The countdown is one vectorizable loop, only the expired tanks draw random numbers.
+/// The draws are keyed by (seed, tank, tick), the ranges of tanks run as parallel jobs.
 /// </summary>
-/// <param name="enemy">Enemy tank to move.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
 /// <param name="deltaTime">Time since the last frame.</param>
-/// <returns>Movement vector for the enemy tank.</returns>
-glm::vec3 EnemyTanks::EnemyMovement(
-    EnemyTank& enemy,
-    float deltaTime)
+/// <param name="seed">Seed of the simulation.</param>
+/// <param name="tick">Current tick of the simulation.</param>
+/// <param name="jobs">Job system running the ranges of tanks.</param>
+void EnemyTanks::UpdateMovementTimers(
+    EnemyTankPool& enemies,
+    float deltaTime,
+    std::uint64_t seed,
+    std::uint64_t tick,
+    JobSystem& jobs)
 {
-    glm::vec3 movement(0);
+    float* movementTimer = enemies.movementTimer.data();
+    std::int32_t* movementPattern = enemies.movementPattern.data();
 
-    switch (enemy.movementPattern)
+    jobs.ParallelFor(0, enemies.Size(), jobGrainSize, [&](std::size_t begin, std::size_t end)
     {
-    case 0: // Move forward
-        movement += glm::vec3(
-            cos(enemy.rotation + M_PI) / 20,
-            0,
-            -sin(enemy.rotation + M_PI) / 20);
-        break;
-
-    case 1: // Move backward
-        movement += glm::vec3(
-            -cos(enemy.rotation + M_PI) / 20,
-            0,
-            sin(enemy.rotation + M_PI) / 20);
-        break;
-
-    case 2: // Rotate clockwise
-        enemy.rotation += deltaTime; // Rotate tank body
-        break;
-
-    case 3: // Rotate counterclockwise
-        enemy.rotation -= deltaTime; // Rotate tank body
-        break;
-    }
+        // Timers that expired on an earlier tick, before this tick counts down
+        std::vector<std::uint32_t> expired;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (movementTimer[i] <= 0)
+            {
+                expired.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            // Expired timers are left as they are, they are reset below
+            movementTimer[i] -= deltaTime * static_cast<float>(movementTimer[i] > 0);
+        }
+
+        for (std::uint32_t i : expired)
+        {
+            // Randomize movement pattern periodically
+            movementPattern[i] = random_utils::UniformInt(seed, RANDOM_STREAM_TIMER_PATTERN, i, tick, 4);
+            // Change pattern every 1-5 seconds
+            movementTimer[i] = static_cast<float>(
+                random_utils::UniformInt(seed, RANDOM_STREAM_TIMER_DURATION, i, tick, 5) + 1);
+        }
+    });
+}
+
 
-    // Apply boundary clamping
-    glm::vec3 newPosition = enemy.position + movement;
-    // Clamping newPosition within the map boundaries
-    newPosition.x = std::max(-20.0f, std::min(20.0f, newPosition.x));
-    newPosition.z = std::max(-20.0f, std::min(20.0f, newPosition.z));
-    return newPosition - enemy.position;
+/// <summary>
+/// Handle the movement logic for all enemy tanks based on their current movement pattern.
+/// Writes the position each tank wants to reach into the pool's next position arrays,
+/// the patterns are turned into factors instead of branches so the loop vectorizes.
+/// </summary>
+/// <param name="enemies">Pool of enemy tanks.</param>
+/// <param name="deltaTime">Duration of the tick, scales the move and the turn.</param>
+/// <param name="arenaBound">Half side of the arena, the moves are clamped to [-arenaBound, arenaBound].</param>
+/// <param name="jobs">Job system running the ranges of tanks.</param>
+void EnemyTanks::ComputeMovementCandidates(
+    EnemyTankPool& enemies,
+    float deltaTime,
+    float arenaBound,
+    JobSystem& jobs)
+{
+    const std::int32_t* movementPattern = enemies.movementPattern.data();
+    const float* positionX = enemies.positionX.data();
+    const float* positionZ = enemies.positionZ.data();
+    float* rotation = enemies.rotation.data();
+    float* nextPositionX = enemies.nextPositionX.data();
+    float* nextPositionZ = enemies.nextPositionZ.data();
+
+    jobs.ParallelFor(0, enemies.Size(), jobGrainSize, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            // 0: Move forward, 1: Move backward
+            float forward = static_cast<float>(movementPattern[i] == 0) - static_cast<float>(movementPattern[i] == 1);
+            // 2: Rotate clockwise, 3: Rotate counterclockwise
+            float turn = static_cast<float>(movementPattern[i] == 2) - static_cast<float>(movementPattern[i] == 3);
+
+            // Rotate tank body
+            rotation[i] += turn * deltaTime;
+
+            // Move at enemySpeed, the distance of a tick scales with its duration
+            float angle = rotation[i] + glm::pi<float>();
+            float step = forward * enemySpeed * deltaTime;
+            float newX = positionX[i] + step * cos(angle);
+            float newZ = positionZ[i] - step * sin(angle);
+
+            // Clamping newPosition within the map boundaries
+            nextPositionX[i] = std::max(-arenaBound, std::min(arenaBound, newX));
+            nextPositionZ[i] = std::max(-arenaBound, std::min(arenaBound, newZ));
+        }
+    });
 }
 
 
@@ -438,123 +701,182 @@ glm::vec3 EnemyTanks::EnemyMovement(
 /// Check for collisions between an enemy tank and buildings.
 /// </summary>
 /// <param name="newPosition">New position of the enemy tank.</param>
-/// <param name="buildings">Vector of buildings in the game.</param>
+/// <param name="buildings">Static index of the buildings in the game.</param>
 /// <returns>True if a collision with buildings is detected, false otherwise.</returns>
 bool EnemyTanks::CollisionWithBuildings(
     const glm::vec3& newPosition,
-    const std::vector<Building>& buildings) 
+    const BuildingIndex& buildings)
 {
     // Adjust this based on your game's scale
     const float collisionRadius = 1.0f;
 
-    for (const auto& building : buildings)
+    return buildings.AnySphere(newPosition, collisionRadius, [&](const BuildingRecord& building)
     {
-        if (glm::distance(newPosition, building.position) < collisionRadius + building.radius)
-        {
-            return true; // Collision detected
-        }
-    }
-    return false; // No collision
+        // Collision detected, squared distances
+        const float reach = collisionRadius + building.radius;
+        return glm::distance2(newPosition, building.position) < reach * reach;
+    });
 }
 
 
 /// <summary>
-/// Check for collisions between an enemy tank and other enemy tanks.
+/// Check for collisions between an enemy tank and other enemy tanks, with the tanks
+/// moving one after the other in index order. The tanks after the current one haven't
+/// moved yet, they are tested at their position. A tank before it is either at its
+/// position or at its next position: when only one of the two collides, the answer
+/// depends on that tank's own move and the tank is added to `undecided`.
 /// </summary>
 /// <param name="newPosition">New position of the enemy tank.</param>
-/// <param name="enemies">Vector of enemy tanks in the game.</param>
-/// <param name="currentTank">Current enemy tank being checked.</param>
-/// <returns>True if a collision with other tanks is detected, false otherwise.</returns>
+/// <param name="enemies">Pool of enemy tanks in the game.</param>
+/// <param name="currentTank">Index of the enemy tank being checked.</param>
+/// <param name="grid">Grid built from the enemy positions, only the nearby tanks are tested.</param>
+/// <param name="undecided">Receives the earlier tanks that block the move in one case only.</param>
+/// <returns>True if a collision with other tanks is detected whatever the earlier tanks do.</returns>
 bool EnemyTanks::CollisionWithTanks(
     const glm::vec3& newPosition,
-    const std::vector<EnemyTank>& enemies,
-    const EnemyTank& currentTank)
+    const EnemyTankPool& enemies,
+    std::size_t currentTank,
+    const SpatialGrid& grid,
+    std::vector<std::uint32_t>& undecided)
 {
-    const float collisionRadius = 2.0f; // Adjust this based on your game's scale and tank size
+    const float reach = tankMoveClearance + enemies.radius[currentTank];
+    const float reachSqr = reach * reach;
 
-    for (const auto& enemy : enemies)
+    return grid.Any(newPosition, reach, [&](std::uint32_t index)
     {
-        if (&enemy != &currentTank && 
-            glm::distance(newPosition, enemy.position) < collisionRadius + currentTank.radius)
+        if (index == currentTank)
         {
-            return true; // Collision detected with another enemy tank
+            return false;
         }
-    }
 
-    return false; // No collision with other tanks
+        bool hitsPosition = glm::distance2(newPosition, enemies.GetPosition(index)) < reachSqr;
+        if (index > currentTank)
+        {
+            // Collision detected with a tank that didn't move yet
+            return hitsPosition;
+        }
+
+        glm::vec3 nextPosition(enemies.nextPositionX[index], enemies.positionY[index], enemies.nextPositionZ[index]);
+        bool hitsNextPosition = glm::distance2(newPosition, nextPosition) < reachSqr;
+        if (hitsPosition != hitsNextPosition)
+        {
+            undecided.push_back(index);
+        }
+        // Collision detected wherever the earlier tank ends
+        return hitsPosition && hitsNextPosition;
+    });
 }
 
 
 /// <summary>
 /// Update the movement, turret rotation, and firing of enemy tanks.
+/// The per-tank math runs as parallel loops over the pool arrays. The moves keep the
+/// sequential rule: a tank moves unless its next position hits a building, a later tank
+/// where it stands or an earlier tank where that one ended. The moves are tested in
+/// parallel, the few that depend on an earlier tank's move are settled by a serial pass
+/// in tank order, then every move is committed in parallel. The random draws are keyed
+/// by (seed, tank, tick), so the result doesn't depend on the thread count.
 /// </summary>
-/// <param name="enemies">Vector of enemy tanks.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
 /// <param name="player">Player's tank.</param>
 /// <param name="stopEnemyMovement">Stop enemy movement.</param>
+/// <param name="arenaBound">Half side of the arena the tanks move in.</param>
 /// <param name="deltaTime">Time since the last frame.</param>
+/// <param name="seed">Seed of the simulation, keys the random draws.</param>
+/// <param name="tick">Current tick of the simulation, keys the random draws.</param>
 /// <param name="attackRange">Attack range of enemy tanks.</param>
 /// <param name="fireRate">Firing rate of enemy tanks.</param>
 /// <param name="fireAlignmentThreshold">Alignment threshold for firing at the player.</param>
 /// <param name="turretRotationSpeed">Turret rotation speed of enemy tanks.</param>
 /// <param name="targetRotation">Target rotation of enemy tanks.</param>
-/// <param name="projectiles">Vector of projectiles.</param>
-/// <param name="buildings">Vector of buildings.</param>
+/// <param name="projectiles">Pool of projectiles.</param>
+/// <param name="buildings">Static index of the buildings.</param>
+/// <param name="grid">Grid built from the enemy positions before the movement.</param>
+/// <param name="jobs">Job system running the ranges of tanks.</param>
 void EnemyTanks::UpdateEnemyMovement(
-    std::vector<EnemyTank>& enemies,
+    EnemyTankPool& enemies,
     PlayerTank& player,
     bool stopEnemyMovement,
+    float arenaBound,
     float deltaTime,
-    
+    std::uint64_t seed,
+    std::uint64_t tick,
+
     float attackRange,
     float fireRate,
     float fireAlignmentThreshold,
 
     float& turretRotationSpeed,
     float& targetRotation,
-    
-    std::vector<Projectile>& projectiles,
-    const std::vector<Building>& buildings)
+
+    ProjectilePool& projectiles,
+    const BuildingIndex& buildings,
+    const SpatialGrid& grid,
+    JobSystem& jobs)
 {
-    for (auto& enemy : enemies)
-    {
-        // Randomize movement pattern periodically
-        if (enemy.movementTimer <= 0) {
-            enemy.movementPattern = std::rand() % 4;
-            // Change pattern every 1-5 seconds
-            enemy.movementTimer = (std::rand() % 5) + 1;
-        }
-        else
-        {
-            enemy.movementTimer -= deltaTime;
-        }
+    UpdateMovementTimers(enemies, deltaTime, seed, tick, jobs);
 
-        if (!stopEnemyMovement)
-        {
-            glm::vec3 movement = EnemyMovement(enemy, deltaTime);
-            glm::vec3 newPosition = enemy.position + movement;
+    if (!stopEnemyMovement)
+    {
+        ComputeMovementCandidates(enemies, deltaTime, arenaBound, jobs);
 
-            // Check for collisions with buildings and other enemy tanks
-            if (!CollisionWithBuildings(newPosition, buildings) &&
-                !CollisionWithTanks(newPosition, enemies, enemy))
+        // Check for collisions with buildings and other enemy tanks, every tank
+        // lists the earlier tanks whose move decides whether it is blocked
+        auto tankOrder = [](std::size_t slot) { return static_cast<std::uint32_t>(slot); };
+        GatherNeighbours(enemies.Size(), tankOrder, enemies.neighbours, jobs,
+            [&](std::size_t i, std::vector<std::uint32_t>& undecided)
             {
-                enemy.position = newPosition;
-            }
-            else
-            {
-                ChangeMovementPattern(enemy);
-            }
-        }
+                glm::vec3 newPosition(enemies.nextPositionX[i], enemies.positionY[i], enemies.nextPositionZ[i]);
+                std::size_t first = undecided.size();
 
-        // Turret and firing updates
-        UpdateTurretAndFire(enemy, deltaTime, player.position, fireRate, projectiles);
+                bool blocked = CollisionWithBuildings(newPosition, buildings) ||
+                               CollisionWithTanks(newPosition, enemies, i, grid, undecided);
+                if (blocked)
+                {
+                    undecided.resize(first);
+                }
+                enemies.isMoveBlocked[i] = static_cast<std::uint8_t>(blocked);
+            });
 
-        if (enemy.isPlayerInRange && player.health > 0)
+        // BARRIER: settle the undecided moves in tank order, the earlier tanks are settled first
+        for (const NeighbourBlock& block : enemies.neighbours)
         {
-            TryFireAtPlayer(enemy, deltaTime, targetRotation,
-                   fireAlignmentThreshold, player.position, projectiles);
+            for (std::size_t k = 0; k < block.entities.size(); ++k)
+            {
+                const std::size_t i = block.entities[k];
+                glm::vec3 newPosition(enemies.nextPositionX[i], enemies.positionY[i], enemies.nextPositionZ[i]);
+                const float reach = tankMoveClearance + enemies.radius[i];
+
+                for (std::uint32_t n = block.offsets[k]; n < block.offsets[k + 1] && !enemies.isMoveBlocked[i]; ++n)
+                {
+                    const std::uint32_t j = block.indices[n];
+                    glm::vec3 finalPosition = enemies.isMoveBlocked[j] ? enemies.GetPosition(j) :
+                        glm::vec3(enemies.nextPositionX[j], enemies.positionY[j], enemies.nextPositionZ[j]);
+
+                    enemies.isMoveBlocked[i] = static_cast<std::uint8_t>(glm::distance2(newPosition, finalPosition) < reach * reach);
+                }
+            }
         }
 
-        enemy.timeSinceLastShot += deltaTime;
+        // BARRIER: all the tests are done, commit the moves
+        jobs.ParallelFor(0, enemies.Size(), jobGrainSize, [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                if (!enemies.isMoveBlocked[i])
+                {
+                    enemies.positionX[i] = enemies.nextPositionX[i];
+                    enemies.positionZ[i] = enemies.nextPositionZ[i];
+                }
+                else
+                {
+                    ChangeMovementPattern(enemies, i, seed, tick);
+                }
+            }
+        });
     }
-}
 
+    // Turret and firing updates
+    UpdateTurrets(enemies, deltaTime, player.position, jobs);
+    UpdateFire(enemies, deltaTime, player, fireRate, fireAlignmentThreshold, targetRotation, projectiles);
+}
@@ -8,19 +8,25 @@
 
 #include "Buildings.h"
 #include "Projectiles.h"
+#include "SpatialGrid.h"
+#include "BuildingIndex.h"
+#include "EnemyTankPool.h"
+#include "ProjectilePool.h"
 
 #include <glm/glm.hpp>
 #include <vector>
-#include <map>
 
 
 struct Building;
 struct Projectile;
+class JobSystem;
 
 
 /// <summary>
 /// ENEMY TANKS THAT FOLLOW THE PLAYER TANK AND SHOOT HIM,
 /// TRIES TO AVOID COLLISIONS WITH BUILDINGS
+/// Used to describe a tank when it is spawned, the simulation keeps its
+/// tanks in an EnemyTankPool (structure of arrays).
 /// </summary>
 struct EnemyTank
 {
@@ -31,22 +37,19 @@ struct EnemyTank
     float rotation;            // Rotation angle of the tank's body
     float turretRotation;      // Rotation angle of the tank's turret
 
-    int movementPattern;       // Pattern for tank's movement
+    int movementPattern = 0;   // Pattern for tank's movement
     float movementTimer;       // Timer for movement pattern
 
     int health;                // Tank's health
     float sinkSpeed = 0.5;     // Speed tank sinks
     float sinkDepth = 0.0;     // Depth tank sinks
 
-    bool isRenderable;         // Tank should be rendered
+    bool isRenderable = true;  // Tank should be rendered
     bool isDestroyed = false;  // Tank is destroyed
 
     bool isPlayerInRange;      // Player is in range
     float timeSinceLastShot;   // Time elapsed since the last shot
-    float deformationLevel;    // Level of tank deformation
-
-    /// Count of collisions with buildings
-    std::map<const Building*, int> collisionCounters;
+    float deformationLevel = 0.0f; // Level of tank deformation
 
     // Getter methods
     /// BODY
@@ -87,68 +90,94 @@ public:
                    cannonAngle(0.0f), deformationLevel(0.0f) {}
 };
 
-///
+/// Passes over the enemy tanks of an EnemyTankPool, a tank is given by its index
 class EnemyTanks {
 public:
     /// Collision between an enemy tank and a building
     static bool TankBuildingCollision(
-        EnemyTank& enemy,
-        Building& building
+        glm::vec3& tankPosition,
+        float tankRadius,
+        const BuildingRecord& building
     );
 
     /// Collision between two enemy tanks
     static bool TankTankCollision(
-        const EnemyTank& enemy1,
-        const EnemyTank& enemy2
+        const glm::vec3& position1, float radius1,
+        const glm::vec3& position2, float radius2
     );
 
     /// Collision between an enemy tank and the player tank
     static bool TankPlayerCollision(
         const PlayerTank& player,
-        const EnemyTank& enemy
+        const glm::vec3& tankPosition,
+        float tankRadius
     );
 
     /// Change the movement pattern of an enemy tank
     static void ChangeMovementPattern(
-        EnemyTank& enemy
+        EnemyTankPool& enemies,
+        std::size_t index,
+        std::uint64_t seed,
+        std::uint64_t tick
     );
 
-    /// Enemy tank movement calculated at each moment
-    static glm::vec3 EnemyMovement(
-        EnemyTank& enemy,
-        float deltaTime
+    /// Count down the movement timers, pick a new pattern when one expires
+    static void UpdateMovementTimers(
+        EnemyTankPool& enemies,
+        float deltaTime,
+        std::uint64_t seed,
+        std::uint64_t tick,
+        JobSystem& jobs
+    );
+
+    /// Enemy tank movement calculated at each moment, for all the tanks
+    static void ComputeMovementCandidates(
+        EnemyTankPool& enemies,
+        float deltaTime,
+        float arenaBound,
+        JobSystem& jobs
     );
 
     /// Check collision with buildings
     static bool CollisionWithBuildings(
         const glm::vec3& newPosition,
-        const std::vector<Building>& buildings
+        const BuildingIndex& buildings
     );
 
-    /// Check collision with tanks
+    /// Check collision with tanks, as if the tanks moved one after the other
     static bool CollisionWithTanks(
         const glm::vec3& newPosition,
-        const std::vector<EnemyTank>& enemies,
-        const EnemyTank& currentTank
+        const EnemyTankPool& enemies,
+        std::size_t currentTank,
+        const SpatialGrid& grid,
+        std::vector<std::uint32_t>& undecided
+    );
+
+    /// Rebuild the broadphase grid from the enemy positions
+    static void BuildTankGrid(
+        SpatialGrid& grid,
+        const EnemyTankPool& enemies
     );
 
     /// Fire a projectile from an enemy tank
     static void FireProjectile(
-        EnemyTank& enemy,
-        std::vector<Projectile>& projectiles,
+        const EnemyTankPool& enemies,
+        std::size_t index,
+        ProjectilePool& projectiles,
         const glm::vec3& playerPos
     );
 
     /// Try to fire at the player, best moment to shoot
     static void TryFireAtPlayer(
-        EnemyTank& enemy,
+        const EnemyTankPool& enemies,
+        std::size_t index,
         float deltaTime,
         
         float targetRotation,
         float fireThreshold,
 
-        glm::vec3& playerPos,
-        std::vector<Projectile>& projectiles
+        const glm::vec3& playerPos,
+        ProjectilePool& projectiles
     );
 
     /// Rotate towards a player position
@@ -160,37 +189,63 @@ public:
 
     /// Update sinking enemy tanks
     static void UpdateSinkingTanks(
-        std::vector<EnemyTank>& enemies,
-        float deltaTime
+        EnemyTankPool& enemies,
+        float deltaTime,
+        JobSystem& jobs
     );
 
     /// Update tank collisions enemies and player
     static void UpdateTankCollisions(
-        std::vector<EnemyTank>& enemies,
-        PlayerTank& player
+        EnemyTankPool& enemies,
+        PlayerTank& player,
+        const SpatialGrid& grid,
+        JobSystem& jobs
     );
 
     /// Update tank collisions with buildings
     static void UpdateTankCollisionsWithBuildings(
-        std::vector<EnemyTank>& tanks,
-        std::vector<Building>& buildings
+        EnemyTankPool& tanks,
+        const BuildingIndex& buildings,
+        JobSystem& jobs
     );
 
-    /// Update turret and fire
-    static void UpdateTurretAndFire(
-        EnemyTank& enemy,
+    /// Push a range of tanks out of the buildings (one job of the pass above)
+    static void ResolveTankBuildingCollisions(
+        EnemyTankPool& tanks,
+        const BuildingIndex& buildings,
+        std::size_t begin,
+        std::size_t end
+    );
+
+    /// Rotate the turrets of the alive tanks towards the player
+    static void UpdateTurrets(
+        EnemyTankPool& enemies,
         float deltaTimeSeconds,
         const glm::vec3& playerPos,
+        JobSystem& jobs
+    );
+
+    /// Update fire cooldowns and fire
+    static void UpdateFire(
+        EnemyTankPool& enemies,
+        float deltaTimeSeconds,
+        const PlayerTank& player,
         float fireRate,
-        std::vector<Projectile>& projectiles);
+        float fireAlignmentThreshold,
+        float targetRotation,
+        ProjectilePool& projectiles
+    );
 
     /// Update enemy movement
     static void UpdateEnemyMovement(
-        std::vector<EnemyTank>& enemies,
+        EnemyTankPool& enemies,
         PlayerTank& player,
 
         bool stopEnemyMovement,
+        float arenaBound,
         float deltaTime,
+        std::uint64_t seed,
+        std::uint64_t tick,
 
         float attackRange,
         float fireRate,
@@ -199,8 +254,10 @@ public:
         float& turretRotationSpeed,
         float& targetRotation,
 
-        std::vector<Projectile>& projectiles,
-        const std::vector<Building>& buildings
+        ProjectilePool& projectiles,
+        const BuildingIndex& buildings,
+        const SpatialGrid& grid,
+        JobSystem& jobs
     );
 };
 
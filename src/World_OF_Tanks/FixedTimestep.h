@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <algorithm>
+
+
+/// <summary>
+/// FIXED SIMULATION TICK DECOUPLED FROM THE FRAME RATE.
+/// The frame times are accumulated and spent in ticks of a fixed duration, the time left
+/// (less than one tick) gives the interpolation factor between the last two ticks.
+/// At most maxTicksPerFrame ticks run per frame: after a stall the simulation drops the
+/// time it can't catch up with (it slows down) instead of running a burst of ticks.
+/// </summary>
+class FixedTimestep
+{
+public:
+    FixedTimestep(float tickRate, int maxTicksPerFrame)
+        : tickDuration(1.0f / tickRate), maxTicksPerFrame(std::max(1, maxTicksPerFrame)), accumulator(0.0f)
+    { /* DEFAULT EMPTY CONSTRUCTOR BODY */ }
+
+    /// Add the duration of a frame, returns the number of ticks to run for it.
+    int Advance(float frameSeconds)
+    {
+        // Never more than the tick budget of a frame
+        const float maxFrameSeconds = tickDuration * maxTicksPerFrame;
+        accumulator += std::min(std::max(frameSeconds, 0.0f), maxFrameSeconds);
+
+        int ticks = 0;
+        while (accumulator >= tickDuration && ticks < maxTicksPerFrame)
+        {
+            accumulator -= tickDuration;
+            ticks++;
+        }
+
+        // Rounding may leave a full tick after the budget, drop it
+        accumulator = std::min(accumulator, tickDuration);
+        return ticks;
+    }
+
+    /// Duration of one tick (seconds), the delta time of every simulation step.
+    float GetTickDuration() const { return tickDuration; }
+
+    /// Position between the previous tick (0) and the last one (1) of the rendered frame.
+    float GetAlpha() const { return std::min(accumulator / tickDuration, 1.0f); }
+
+    void SetTickRate(float tickRate) { tickDuration = 1.0f / tickRate; }
+    void SetMaxTicksPerFrame(int maxTicks) { maxTicksPerFrame = std::max(1, maxTicks); }
+
+private:
+    float tickDuration;     // Seconds per tick
+    int maxTicksPerFrame;   // Tick budget of a frame
+    float accumulator;      // Frame time not simulated yet
+};
+
+#endif // FIXED_TIMESTEP_H
@@ -0,0 +1,119 @@
+#include "Frustum.h"
+#include "SphereKernels.h"
+
+
+void SphereBatch::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+
+void SphereBatch::Add(const glm::vec3& center, float r)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+
+void BoxBatch::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+
+void BoxBatch::Add(const glm::vec3& center, const glm::vec3& extents)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    extentX.push_back(extents.x);
+    extentY.push_back(extents.y);
+    extentZ.push_back(extents.z);
+}
+
+
+/// <summary>
+/// Frustum of the identity matrix, the clip space cube.
+/// </summary>
+Frustum::Frustum()
+{
+    SetViewProjection(glm::mat4(1.0f));
+}
+
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    SetViewProjection(viewProjection);
+}
+
+
+/// <summary>
+/// A point is inside when -w <= x, y, z <= w in clip space, each inequality is a plane:
+/// row3 + row0 >= 0 is the left plane, row3 - row0 >= 0 the right one, and so on.
+/// </summary>
+/// <param name="viewProjection">Projection * view of the camera.</param>
+void Frustum::SetViewProjection(const glm::mat4& viewProjection)
+{
+    // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 rows[4];
+    for (int row = 0; row < 4; ++row)
+    {
+        rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+                              viewProjection[2][row], viewProjection[3][row]);
+    }
+
+    planes[PLANE_LEFT] = rows[3] + rows[0];
+    planes[PLANE_RIGHT] = rows[3] - rows[0];
+    planes[PLANE_BOTTOM] = rows[3] + rows[1];
+    planes[PLANE_TOP] = rows[3] - rows[1];
+    planes[PLANE_NEAR] = rows[3] + rows[2];
+    planes[PLANE_FAR] = rows[3] - rows[2];
+
+    // Unit normals, the plane equations give distances
+    for (glm::vec4& plane : planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+}
+
+
+bool Frustum::IsSphereVisible(const glm::vec3& center, float radius) const
+{
+    for (const glm::vec4& plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+
+std::size_t Frustum::Cull(SphereBatch& batch) const
+{
+    batch.visible.resize(batch.Size());
+    if (batch.Size() == 0) return 0;
+
+    return SphereKernels::SpheresInFrustum(planes, &batch.x[0], &batch.y[0], &batch.z[0], &batch.radius[0],
+                                           batch.Size(), &batch.visible[0]);
+}
+
+
+std::size_t Frustum::Cull(BoxBatch& batch) const
+{
+    batch.visible.resize(batch.Size());
+    if (batch.Size() == 0) return 0;
+
+    return SphereKernels::BoxesInFrustum(planes, &batch.x[0], &batch.y[0], &batch.z[0],
+                                         &batch.extentX[0], &batch.extentY[0], &batch.extentZ[0],
+                                         batch.Size(), &batch.visible[0]);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// <summary>
+/// Bounding spheres packed for the frustum test (X, Y, Z and radius in separate arrays).
+/// </summary>
+struct SphereBatch
+{
+    std::vector<float> x, y, z;
+    std::vector<float> radius;
+    std::vector<std::uint8_t> visible;  // Result of the last test, 1 when visible
+
+    void Clear();
+    void Add(const glm::vec3& center, float r);
+    std::size_t Size() const { return x.size(); }
+};
+
+
+/// <summary>
+/// Axis aligned bounding boxes packed for the frustum test (centers and half-extents).
+/// </summary>
+struct BoxBatch
+{
+    std::vector<float> x, y, z;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<std::uint8_t> visible;  // Result of the last test, 1 when visible
+
+    void Clear();
+    void Add(const glm::vec3& center, const glm::vec3& extents);
+    std::size_t Size() const { return x.size(); }
+};
+
+
+/// <summary>
+/// Objects kept and dropped by the culling of one frame.
+/// </summary>
+struct CullCounter
+{
+    std::size_t visible = 0;
+    std::size_t culled = 0;
+
+    void Reset() { visible = 0; culled = 0; }
+};
+
+
+/// <summary>
+/// VIEW FRUSTUM OF A CAMERA.
+/// The 6 planes are extracted from the rows of the view-projection matrix (Gribb and Hartmann)
+/// and normalized, so dot(n, p) + w is the signed distance of p to a plane, positive inside.
+/// The batches are tested with the SIMD kernels of SphereKernels.
+/// </summary>
+class Frustum
+{
+public:
+    enum Plane
+    {
+        PLANE_LEFT, PLANE_RIGHT,
+        PLANE_BOTTOM, PLANE_TOP,
+        PLANE_NEAR, PLANE_FAR
+    };
+
+    Frustum();
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    /// Extract the planes of a view-projection matrix (OpenGL clip space, -w <= z <= w)
+    void SetViewProjection(const glm::mat4& viewProjection);
+
+    const glm::vec4& GetPlane(Plane plane) const { return planes[plane]; }
+
+    /// Sphere not fully outside of one plane
+    bool IsSphereVisible(const glm::vec3& center, float radius) const;
+
+    /// Test every sphere / box of the batch, fills batch.visible and returns the number visible
+    std::size_t Cull(SphereBatch& batch) const;
+    std::size_t Cull(BoxBatch& batch) const;
+
+private:
+    glm::vec4 planes[6];
+};
+
+#endif // FRUSTUM_H
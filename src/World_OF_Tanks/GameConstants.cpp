@@ -63,7 +63,26 @@ const float fireRate = 1.0f; // Time between shots (seconds)
 const float attackRange = 5.0f; // Range within which enemies will attack
 const float fireAlignmentThreshold = 5.0f; // Alignment threshold for turret firing (degrees)
 const float rotationThreshold = 5.0f; // Rotation threshold angle to stop rotation
+const float playerSpeed = 3.0f; // Player's tank speed (units per second)
+const float enemySpeed = 3.0f; // Enemy tanks' speed (units per second), the old 1/20 unit per frame at 60 fps
+const float arenaHalfSize = 20.0f; // Enemy tanks spawn and move within [-20, 20] on X and Z
+
+// Simulation Tick Parameters
+const float simulationTickRate = 60.0f; // Ticks per second, independent from the frame rate
+const int maxTicksPerFrame = 5; // Frames slower than 5 ticks slow the game down
+
+// Render Parameters
+const float tankCullRadius = 2.5f; // Body half-diagonal plus the cannon sticking out of the turret
+const int groundTextureSize = 2048; // Texels per side of the baked ground (mip-mapped)
+const int groundTextureUnit = 1; // Unit 0 is used by the mesh and text textures
+const double gpuTimerLogInterval = 1.0; // Rolling min / avg / max over one second
+const unsigned int cpuTraceFrames = 120; // Two seconds at 60 FPS
+const char* const cpuTraceFile = "cpu_trace.json"; // Written in the working directory
     
 extern const int randInitEnemies = 5; // Randomly initialize enemies
-const static const int planeSize = 40; // Size of the game plane
+const int planeSize = 40; // Size of the game plane
 const float projectileLifetime = 5.0f; // Lifetime of a projectile (seconds)
+
+// Job System Parameters
+const int jobGrainSize = 2048; // A few microseconds of work, less is not worth a job
+const int jobQueryGrainSize = 128; // Tanks per job when each one queries the grids
@@ -62,10 +62,48 @@ extern const float fireRate;                // Seconds between shots
 extern const float attackRange;             // Range within which enemies will attack
 extern const float fireAlignmentThreshold;  // Degrees within which the turret must be aligned to fire
 extern const float rotationThreshold;       // Threshold angle to stop rotation
+extern const float playerSpeed;             // Player's tank speed (units per second)
+extern const float enemySpeed;              // Enemy tanks' speed (units per second)
+extern const float arenaHalfSize;           // Default half side of the square arena
+
+// Simulation Tick Constants
+extern const float simulationTickRate;      // Simulation ticks per second
+extern const int maxTicksPerFrame;          // Tick budget of a rendered frame
+
+// Render Constants
+extern const float tankCullRadius;          // Bounding sphere of a tank for the frustum culling
+extern const int groundTextureSize;         // Resolution of the baked ground texture
+extern const int groundTextureUnit;         // Texture unit of the baked ground texture
+extern const double gpuTimerLogInterval;    // Seconds between two logs of the GPU timers
+extern const unsigned int cpuTraceFrames;   // Frames written to a CPU trace
+extern const char* const cpuTraceFile;      // CPU trace written by the hotkey
+
+// Ground Passes of the plane shader, same values as in FragmentShaderPlane.glsl
+enum GroundPass
+{
+    GROUND_PASS_FULL = 0,               // Whole noise and craters per pixel, every frame
+    GROUND_PASS_BAKE,                   // Time-invariant layers rendered into the ground texture
+    GROUND_PASS_BAKED                   // Baked texture with a cheap animated wave
+};
 
 // Other Constants
 extern const int randInitEnemies;
 extern const int planeSize;               // Declare planeSize as a static constant
 extern const float projectileLifetime;    // Lifetime of a projectile in seconds
 
+// Job System Constants
+extern const int jobGrainSize;            // Minimum entities per job for the light per-entity loops
+extern const int jobQueryGrainSize;       // Minimum entities per job for the loops querying the grids
+
+// Random Streams, one per kind of draw so two draws of the same entity and tick differ
+enum RandomStream
+{
+    RANDOM_STREAM_BUILDINGS = 1,        // Number, sizes and cells of the buildings
+    RANDOM_STREAM_BUILDING_COLORS,      // Vertex colors of the building meshes
+    RANDOM_STREAM_ENEMY_SPAWN,          // Number, positions and angles of the enemy tanks
+    RANDOM_STREAM_TIMER_PATTERN,        // New movement pattern when the movement timer expires
+    RANDOM_STREAM_TIMER_DURATION,       // New duration of the movement timer
+    RANDOM_STREAM_BLOCKED_PATTERN       // New movement pattern when a move is blocked
+};
+
 #endif // GAME_CONSTANTS_H
@@ -1,30 +1,16 @@
 #include "GameInit.h"
-#include "Renderer.h"
-#include "World_OF_Tanks.h"
+#include "TankSim.h"
+
+#include "core/log/log.h"
+#include "utils/random_utils.h"
 
-#include <iostream>
 #include <vector>
-#include <random>
 
 
-GameInit::GameInit(World_OF_Tanks* world) : world(world)
+GameInit::GameInit(TankSim* sim) : sim(sim)
 { /* DEFAULT EMPTY CONSTRUCTOR BODY */ }
 
 
-/// <summary>
-/// Generate a random float within a given range.
-/// </summary>
-/// <param name="min">Minimum value of the range (inclusive).</param>
-/// <param name="max">Maximum value of the range (exclusive).</param>
-/// <returns>
-/// A random float value within the specified range [min, max).
-/// </returns>
-float randP(float min, float max)
-{
-    return ((max - min) * ((float)rand() / RAND_MAX)) + min;
-}
-
-
 /// <summary>
 /// Check if a given object is overlapping with any buildings in the game world.
 /// </summary>
@@ -35,34 +21,34 @@ float randP(float min, float max)
 /// </returns>
 bool GameInit::IsOverlappingWithBuildings(const glm::vec3& position, float tankRadius)
 {
-    // Iterate through all buildings to check for overlap.
-    for (const Building& building : world->GetBuildings())
+    // Check the buildings around the position for overlap.
+    return sim->GetBuildingIndex().AnySphere(position, tankRadius, [&](const BuildingRecord& building)
     {
         // Distance to the building.
         float distance = glm::distance(position, building.position);
         // If within the sum of radius, overlap is detected.
-        if (distance < (tankRadius + building.radius))
-        {
-            // Overlap detected.
-            return true;
-        }
-    }
-    // No overlap.
-    return false;
+        return distance < (tankRadius + building.radius);
+    });
 }
 
 
 /// <summary>
-/// Initialize building meshes by creating a certain number of cubes at random positions on the game map.
+/// Initialize buildings by placing a certain number of cubes at random positions on the game map.
 /// Each building's position is determined so that it does not overlap with any existing buildings.
 /// Buildings are spaced out according to specified minimum and maximum values.
+/// Only the simulation data is created here, the meshes are built by the renderer.
+/// The random numbers come from the simulation seed, the same seed gives the same arena.
 /// </summary>
-void GameInit::InitializeBuildings()
+/// <param name="numBuildings">Number of buildings to place, random (10 to 19) when negative.</param>
+void GameInit::InitializeBuildings(int numBuildings)
 {
+    random_utils::Sequence random(sim->GetSeed(), RANDOM_STREAM_BUILDINGS);
+
     // Generate a random number of cubes to represent buildings
     // Randomly choose a number between 10 and 20 for the number of buildings
-    int numBuildings = rand() % randInitBuildings + randInitBuildings;
-    world->SetNumBuildings(numBuildings);
+    int randomNumBuildings = random.NextInt(randInitBuildings) + randInitBuildings;
+    if (numBuildings < 0) numBuildings = randomNumBuildings;
+    sim->SetNumBuildings(numBuildings);
 
     // Determine the grid size based on the plane size and minimum building spacing
     int numPositionsX = static_cast<int>((planeSize - 2 * maxCubeOffset) / minBuildingSpacing);
@@ -84,11 +70,12 @@ void GameInit::InitializeBuildings()
         while (!validPositionFound && tries < numTries)
         {
             // Randomly scale the building
-            scale = glm::vec3(randP(0.5f, maxCubeOffset), 2 * randP(0.5f, maxCubeOffset), randP(0.5f, maxCubeOffset));
+            scale = glm::vec3(random.NextFloat(0.5f, maxCubeOffset), 2 * random.NextFloat(0.5f, maxCubeOffset),
+                              random.NextFloat(0.5f, maxCubeOffset));
             
             // Choose a random position on the grid
-            int gridX = rand() % numPositionsX;
-            int gridZ = rand() % numPositionsZ;
+            int gridX = random.NextInt(numPositionsX);
+            int gridZ = random.NextInt(numPositionsZ);
 
             // Buildings are centered in the world, battle space!
             float buildingsLimits = static_cast<float>(planeSize / 2);
@@ -120,52 +107,17 @@ void GameInit::InitializeBuildings()
             tries++;
         }
 
-        // Valid position was found, create the mesh for the building
+        // Valid position was found, create the building
         if (validPositionFound)
         {
-            // Create vertices for the cube
-            std::vector<VertexFormat> vertices
-            {
-                VertexFormat(position + glm::vec3(-1, -1,  1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(1, -1,  1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(-1,  1,  1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(1,  1,  1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(-1, -1, -1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(1, -1, -1) * scale,
-                glm::vec3((0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(-1,  1, -1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-                VertexFormat(position + glm::vec3(1,  1, -1) * scale,
-                glm::vec3(randP(0.0f, 1.0f), randP(0.0f, 1.0f), randP(0.0f, 1.0f))),
-            };
-
-            // Create indices for the cube
-            std::vector<unsigned int> indices =
-            {
-                0, 1, 2,  1, 3, 2,
-                2, 3, 7,  2, 7, 6,
-                1, 7, 3,  1, 5, 7,
-                6, 7, 4,  7, 5, 4,
-                0, 4, 1,  1, 4, 5,
-                2, 6, 4,  0, 2, 4,
-            };
-
             // Calculate a radius for collision detection
             float r = 0.5f * sqrt(scale.x * scale.x + scale.y * scale.y + scale.z * scale.z);
 
-            std::string name = "cube" + std::to_string(i);
             // Log the creation of a building
-            std::cout << "Created BUILDING: " << name << std::endl;
+            LOG_DEBUG(Game, "Created BUILDING: %d", i);
 
-            // Add the building to the list of buildings
-            world->AddBuilding(Building(position, scale, name, r));
-            // Use the CreateMesh function to create and store the mesh
-            world->renderer->CreateMesh(name.c_str(), vertices, indices);
+            // Add the building to the simulation
+            sim->AddBuilding(Building(position, scale, r));
         }
     }
 }
@@ -175,10 +127,14 @@ void GameInit::InitializeBuildings()
 /// Initialize enemy tanks by creating a specified number of tanks with random attributes.
 /// Tank is placed in a position that does not overlap with any buildings.
 /// </summary>
-void GameInit::InitializeEnemyTanks()
+/// <param name="numEnemies">Number of tanks to place, random (5 to 9) when negative.</param>
+void GameInit::InitializeEnemyTanks(int numEnemies)
 {
+    random_utils::Sequence random(sim->GetSeed(), RANDOM_STREAM_ENEMY_SPAWN);
+
     // The number of enemy tanks to generate
-    int numEnemies = rand() % randInitEnemies + randInitEnemies;
+    int randomNumEnemies = random.NextInt(randInitEnemies) + randInitEnemies;
+    if (numEnemies < 0) numEnemies = randomNumEnemies;
 
     // Create each enemy tank
     for (int i = 0; i < numEnemies; ++i)
@@ -194,7 +150,8 @@ void GameInit::InitializeEnemyTanks()
         while (!validPositionFound && tries < 30)
         {
             // Randomize position and check for overlap with buildings
-            enemy.position = glm::vec3(randP(-20.0f, 20.0f), 0.0f, randP(-20.0f, 20.0f));
+            enemy.position = glm::vec3(random.NextFloat(-arenaHalfSize, arenaHalfSize), 0.0f,
+                                       random.NextFloat(-arenaHalfSize, arenaHalfSize));
             enemy.radius = 1.5f; // Set the collision radius
 
             // Check for overlap with buildings
@@ -210,21 +167,20 @@ void GameInit::InitializeEnemyTanks()
         if (validPositionFound)
         {
             // Set initial attributes
-            enemy.health = 100;                             // Full health
+            enemy.health = 100;                                     // Full health
             ///
-            enemy.rotation = randP(0.0f, 360.0f);           // Random rotation in degrees
-            enemy.turretRotation = randP(0.0f, 360.0f);     // Random turret rotation in degrees
+            enemy.rotation = random.NextFloat(0.0f, 360.0f);        // Random rotation in degrees
+            enemy.turretRotation = random.NextFloat(0.0f, 360.0f);  // Random turret rotation in degrees
             ///
-            enemy.isPlayerInRange = false;                  // Initial state
-            enemy.movementTimer = randP(3.0f, 10.0f);       // Random timer for changing movement pattern
-            enemy.timeSinceLastShot = 0.0f;                 // Reset shot timer
+            enemy.isPlayerInRange = false;                          // Initial state
+            enemy.movementTimer = random.NextFloat(3.0f, 10.0f);    // Random timer for changing movement pattern
+            enemy.timeSinceLastShot = 0.0f;                         // Reset shot timer
 
-            world->AddEnemy(enemy);
+            sim->AddEnemy(enemy);
         }
         else
         {
-            std::cout << "ERROR: NO OVERLAPING POSITIONS TANKS " 
-                      << i << " could not be found." << std::endl;
+            LOG_WARN(Game, "ERROR: NO OVERLAPING POSITIONS TANKS %d could not be found.", i);
         }
     }
 }
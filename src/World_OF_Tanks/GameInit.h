@@ -7,25 +7,26 @@
 #include <glm/glm.hpp>
 
 
-class World_OF_Tanks;
+class TankSim;
 
 // GameInit class is responsible for initializing environment game elements //
 //                      TANK ENEMIES AND BUILDINGS                          //
 class GameInit {
 public:
-    // GameInit interactions with the buildings and enemies from the game world.
-    GameInit(World_OF_Tanks* world);
+    // GameInit interactions with the buildings and enemies from the simulation.
+    GameInit(TankSim* sim);
 
-    /// Initialize building meshes in the game world.
-    // Buildings are created and placed without overlapping.
-    void InitializeBuildings();
-    // EnemyTanks are placed in valid positions without overlapping with buildings.
-    void InitializeEnemyTanks();
+    /// Initialize buildings in the simulation.
+    // Buildings are created and placed without overlapping, a random number of them when negative.
+    void InitializeBuildings(int numBuildings = -1);
+    // EnemyTanks are placed in valid positions without overlapping with buildings,
+    // a random number of them when negative.
+    void InitializeEnemyTanks(int numEnemies = -1);
 
 private:
-    // Access & Modify the game world, adding buildings and enemies.
-    World_OF_Tanks* world;
-        
+    // Access & Modify the simulation, adding buildings and enemies.
+    TankSim* sim;
+
     /// Check if a given position overlaps with any existing buildings.
     // New TankEnemis don't overlap with buildings.
     bool IsOverlappingWithBuildings(const glm::vec3& position, float tankRadius);
@@ -0,0 +1,134 @@
+#include "ProjectilePool.h"
+#include "Projectiles.h"
+
+
+const std::uint32_t ProjectilePool::hitNothing;
+const std::uint32_t ProjectilePool::hitBuilding;
+const std::uint32_t ProjectilePool::hitPlayer;
+const std::uint32_t ProjectilePool::hitExpired;
+
+
+/// <summary>
+/// Scatter a projectile into the pool arrays.
+/// </summary>
+/// <param name="projectile">Initial state of the projectile.</param>
+/// <returns>Index of the new projectile in the pool.</returns>
+std::size_t ProjectilePool::Add(const Projectile& projectile)
+{
+    positionX.push_back(projectile.position.x);
+    positionY.push_back(projectile.position.y);
+    positionZ.push_back(projectile.position.z);
+    velocityX.push_back(projectile.velocity.x);
+    velocityY.push_back(projectile.velocity.y);
+    velocityZ.push_back(projectile.velocity.z);
+
+    radius.push_back(projectile.radius);
+    lifespan.push_back(projectile.lifespan);
+    maxLifespan.push_back(projectile.maxLifespan);
+
+    hitsPlayer.push_back(0);
+    hitTarget.push_back(hitNothing);
+
+    return Size() - 1;
+}
+
+
+/// <summary>
+/// Gather a projectile from the pool arrays.
+/// </summary>
+/// <param name="index">Index of the projectile.</param>
+/// <returns>Copy of the projectile's state.</returns>
+Projectile ProjectilePool::Get(std::size_t index) const
+{
+    Projectile projectile;
+
+    projectile.position = GetPosition(index);
+    projectile.velocity = glm::vec3(velocityX[index], velocityY[index], velocityZ[index]);
+
+    projectile.radius = radius[index];
+    projectile.lifespan = lifespan[index];
+    projectile.maxLifespan = maxLifespan[index];
+
+    return projectile;
+}
+
+
+/// <summary>
+/// Remove a projectile in O(1): move the last projectile into its slot and pop the back.
+/// </summary>
+/// <param name="index">Index of the projectile to remove.</param>
+void ProjectilePool::Remove(std::size_t index)
+{
+    const std::size_t last = Size() - 1;
+
+    positionX[index] = positionX[last];
+    positionY[index] = positionY[last];
+    positionZ[index] = positionZ[last];
+    velocityX[index] = velocityX[last];
+    velocityY[index] = velocityY[last];
+    velocityZ[index] = velocityZ[last];
+
+    radius[index] = radius[last];
+    lifespan[index] = lifespan[last];
+    maxLifespan[index] = maxLifespan[last];
+
+    hitsPlayer[index] = hitsPlayer[last];
+    hitTarget[index] = hitTarget[last];
+
+    positionX.pop_back();
+    positionY.pop_back();
+    positionZ.pop_back();
+    velocityX.pop_back();
+    velocityY.pop_back();
+    velocityZ.pop_back();
+
+    radius.pop_back();
+    lifespan.pop_back();
+    maxLifespan.pop_back();
+
+    hitsPlayer.pop_back();
+    hitTarget.pop_back();
+}
+
+
+/// <summary>
+/// Reserve room for `capacity` projectiles in every array.
+/// </summary>
+/// <param name="capacity">Number of projectiles.</param>
+void ProjectilePool::Reserve(std::size_t capacity)
+{
+    positionX.reserve(capacity);
+    positionY.reserve(capacity);
+    positionZ.reserve(capacity);
+    velocityX.reserve(capacity);
+    velocityY.reserve(capacity);
+    velocityZ.reserve(capacity);
+
+    radius.reserve(capacity);
+    lifespan.reserve(capacity);
+    maxLifespan.reserve(capacity);
+
+    hitsPlayer.reserve(capacity);
+    hitTarget.reserve(capacity);
+}
+
+
+/// <summary>
+/// Remove all the projectiles, the memory is kept for the next ones.
+/// </summary>
+void ProjectilePool::Clear()
+{
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    velocityX.clear();
+    velocityY.clear();
+    velocityZ.clear();
+
+    radius.clear();
+    lifespan.clear();
+    maxLifespan.clear();
+
+    hitsPlayer.clear();
+    hitTarget.clear();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef PROJECTILE_POOL_H
+#define PROJECTILE_POOL_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+struct Projectile;
+
+
+/// <summary>
+/// LIVE PROJECTILES STORED AS STRUCTURE OF ARRAYS.
+/// Removal swaps the last projectile into the freed slot (swap-and-pop), so it is
+/// O(1) and the arrays stay dense. Indices are not stable across a removal.
+/// </summary>
+class ProjectilePool
+{
+public:
+    /// Append a projectile, returns its index.
+    std::size_t Add(const Projectile& projectile);
+    /// Gather the projectile at `index` back into a Projectile.
+    Projectile Get(std::size_t index) const;
+    /// Remove the projectile at `index`, the last projectile takes its place.
+    void Remove(std::size_t index);
+
+    void Reserve(std::size_t capacity);
+    void Clear();
+
+    std::size_t Size() const { return positionX.size(); }
+    bool Empty() const { return positionX.empty(); }
+
+    glm::vec3 GetPosition(std::size_t index) const
+    {
+        return glm::vec3(positionX[index], positionY[index], positionZ[index]);
+    }
+
+public:
+    std::vector<float> positionX;      // Current position of the projectile.
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> velocityX;      // Velocity of the projectile.
+    std::vector<float> velocityY;
+    std::vector<float> velocityZ;
+
+    std::vector<float> radius;         // Radius of the projectile.
+    std::vector<float> lifespan;       // Current lifespan of the projectile.
+    std::vector<float> maxLifespan;    // Maximum lifespan of the projectile (in seconds).
+
+    // Scratch, written by the batched player hit test of each tick
+    std::vector<std::uint8_t> hitsPlayer;
+    // Scratch, what the projectile hits this tick: the index of a tank or one of the values below
+    std::vector<std::uint32_t> hitTarget;
+
+    static const std::uint32_t hitNothing = 0xFFFFFFFFu;
+    static const std::uint32_t hitBuilding = 0xFFFFFFFEu;
+    static const std::uint32_t hitPlayer = 0xFFFFFFFDu;
+    static const std::uint32_t hitExpired = 0xFFFFFFFCu;    // Not a hit, the lifespan is over
+};
+
+#endif // PROJECTILE_POOL_H
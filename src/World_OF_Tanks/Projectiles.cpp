@@ -1,25 +1,30 @@
 #include "Projectiles.h"
 #include "Buildings.h"
+#include "SphereKernels.h"
+#include "GameConstants.h"
+
+#include "core/jobs/job_system.h"
 
 #include <glm/gtc/constants.hpp>
+#include <algorithm>
 
 
 /// <summary>
 /// Check for collision between a projectile and an enemy tank.
 /// </summary>
-/// <param name="projectile">Projectile to check.</param>
-/// <param name="tank">Enemy tank to check against.</param>
+/// <param name="projectilePosition">Position of the projectile to check.</param>
+/// <param name="tankPosition">Position of the enemy tank to check against.</param>
 /// <returns>True if a collision is detected, otherwise false.</returns>
 bool Projectiles::ProjectileTankCollision(
-    const Projectile& projectile,
-    const EnemyTank& tank)
+    const glm::vec3& projectilePosition,
+    const glm::vec3& tankPosition)
 {
-    // Distance between the projectile and tank centers
-    glm::vec3 dif = tank.position - projectile.position;
-    float distance = glm::length(dif);
+    // Squared distance between the projectile and tank centers, no sqrt
+    glm::vec3 dif = tankPosition - projectilePosition;
+    float distanceSqr = glm::dot(dif, dif);
 
     // Check if a collision occurred
-    if (distance < 1.f)
+    if (distanceSqr < 1.f)
     {
         return true; // Collision
     }
@@ -30,19 +35,19 @@ bool Projectiles::ProjectileTankCollision(
 /// <summary>
 /// Check for collision between a projectile and the player's tank.
 /// </summary>
-/// <param name="projectile">Projectile to check.</param>
+/// <param name="projectilePosition">Position of the projectile to check.</param>
 /// <param name="player">Player's tank to check against.</param>
 /// <returns>True if a collision is detected, otherwise false.</returns>
 bool Projectiles::ProjectilePlayerCollision(
-    const Projectile& projectile,
+    const glm::vec3& projectilePosition,
     const PlayerTank& player)
 {
-    // Distance between the projectile and tank centers
-    glm::vec3 dif = player.position - projectile.position;
-    float distance = glm::length(dif);
+    // Squared distance between the projectile and tank centers, no sqrt
+    glm::vec3 dif = player.position - projectilePosition;
+    float distanceSqr = glm::dot(dif, dif);
 
     // Check if a collision occurred
-    if (distance < 1.f)
+    if (distanceSqr < 1.f)
     {
         return true; // Collision
     }
@@ -53,18 +58,20 @@ bool Projectiles::ProjectilePlayerCollision(
 /// <summary>
 /// Check for collision between a projectile and a building.
 /// </summary>
-/// <param name="projectile">Projectile to check.</param>
+/// <param name="projectilePosition">Position of the projectile to check.</param>
+/// <param name="projectileRadius">Radius of the projectile.</param>
 /// <param name="building">Building to check against.</param>
 /// <returns>True if a collision is detected, otherwise false.</returns>
 bool Projectiles::ProjectileBuildingCollision(
-    const Projectile& projectile,
-    const Building& building)
+    const glm::vec3& projectilePosition,
+    float projectileRadius,
+    const BuildingRecord& building)
 {
-    glm::vec3 projectileMinBox = projectile.position - glm::vec3(projectile.radius);
-    glm::vec3 projectileMaxBox = projectile.position + glm::vec3(projectile.radius);
+    glm::vec3 projectileMinBox = projectilePosition - glm::vec3(projectileRadius);
+    glm::vec3 projectileMaxBox = projectilePosition + glm::vec3(projectileRadius);
 
-    glm::vec3 buildingMinBox = building.position - building.scale * 0.5f;
-    glm::vec3 buildingMaxBox = building.position + building.scale * 0.5f;
+    glm::vec3 buildingMinBox = building.position - building.halfExtents;
+    glm::vec3 buildingMaxBox = building.position + building.halfExtents;
 
     // Check for overlap in each dimension
     bool collisionX = projectileMinBox.x <= buildingMaxBox.x && projectileMaxBox.x >= buildingMinBox.x;
@@ -76,87 +83,174 @@ bool Projectiles::ProjectileBuildingCollision(
 }
 
 
-
 /// <summary>
-/// Update projectiles to check for collisions with the player's tank and apply damage.
+/// Find what a projectile hits among the enemy tanks around it and the buildings
+/// around its AABB. The tanks found in the grid go through the batched sphere test.
+/// Reads the tanks and the buildings only, safe from parallel jobs.
 /// </summary>
-/// <param name="projectiles">Vector of projectiles to update.</param>
-/// <param name="player">Player's tank to check for collisions.</param>
-/// <param name="damage">Damage to apply to the player's tank upon collision.</param>
-void Projectiles::UpdateProjectilesPlayerCollision(
-    std::vector<Projectile>& projectiles,
-    PlayerTank& player,
-    int damage)
+/// <param name="position">Position of the projectile.</param>
+/// <param name="radius">Radius of the projectile.</param>
+/// <param name="enemies">Pool of enemy tanks.</param>
+/// <param name="tankGrid">Grid built from the current enemy positions.</param>
+/// <param name="buildings">Static index of the buildings.</param>
+/// <param name="candidates">Scratch for the tanks around the projectile, one per job.</param>
+/// <returns>Index of the first alive tank hit, ProjectilePool::hitBuilding or ProjectilePool::hitNothing.</returns>
+std::uint32_t Projectiles::FindTarget(
+    const glm::vec3& position,
+    float radius,
+    const EnemyTankPool& enemies,
+    const SpatialGrid& tankGrid,
+    const BuildingIndex& buildings,
+    std::vector<std::uint32_t>& candidates)
 {
-    for (auto itProjectile = projectiles.begin(); itProjectile != projectiles.end(); )
+    // Tanks within 1 unit of the projectile
+    candidates.clear();
+    tankGrid.Collect(position, 1.0f, candidates);
+    std::size_t numHits = SphereKernels::FilterSpheres(position, 1.0f,
+        enemies.positionX.data(), enemies.positionY.data(), enemies.positionZ.data(), nullptr,
+        candidates.data(), candidates.size());
+
+    // The first tank in the pool order takes the hit
+    std::uint32_t hitTank = ProjectilePool::hitNothing;
+    for (std::size_t k = 0; k < numHits; ++k)
     {
-        // Check for collision with the player's tank
-        if (Projectiles::ProjectilePlayerCollision(*itProjectile, player))
+        const std::uint32_t tank = candidates[k];
+        if (tank < hitTank && !enemies.isDestroyed[tank])
         {
-            // Reduce player's health
-            player.health -= damage;
-            // Projectile dissapear
-            itProjectile = projectiles.erase(itProjectile);
-        }
-        else
-        {
-            // Next projectile
-            ++itProjectile;
+            hitTank = tank;
         }
     }
+
+    if (hitTank != ProjectilePool::hitNothing)
+    {
+        return hitTank;
+    }
+
+    // DON'T NEED TO CHECK OTHER BUILDINGS after the first hit
+    bool hitsBuilding = buildings.AnyBox(position - glm::vec3(radius), position + glm::vec3(radius),
+        [&](const BuildingRecord& building)
+        {
+            return ProjectileBuildingCollision(position, radius, building);
+        });
+
+    return hitsBuilding ? ProjectilePool::hitBuilding : ProjectilePool::hitNothing;
 }
 
 
 /// <summary>
-/// Update projectile movements and check for collisions with enemy tanks.
+/// Update all the projectiles: test them against the player, move them, expire the
+/// old ones and test them against the enemy tanks and the buildings.
+/// One pass of parallel jobs over ranges of projectiles runs the batched player test
+/// where the projectiles are, moves them and finds the target of every projectile,
+/// the tanks and the buildings are only read. A short serial pass then applies the hits in pool order, so the
+/// damage doesn't depend on the thread count, and removes the projectiles that expired
+/// or hit something (swap-and-pop, from the back).
 /// </summary>
-/// <param name="projectiles">Vector of projectiles to update.</param>
-/// <param name="enemies">Vector of enemy tanks to check for collisions.</param>
-/// <param name="projectileDamage">Damage to apply to enemy tanks upon collision.</param>
+/// <param name="projectiles">Pool of live projectiles.</param>
+/// <param name="player">Player's tank, damaged on hit.</param>
+/// <param name="enemies">Pool of enemy tanks, damaged on hit.</param>
+/// <param name="tankGrid">Grid built from the current enemy positions.</param>
+/// <param name="buildings">Static index of the buildings, they stop the projectiles.</param>
+/// <param name="damage">Damage to apply to a tank upon collision.</param>
 /// <param name="deltaTime">Time elapsed since the last update.</param>
-void Projectiles::UpdateProjectileMovementsAndCollisions(
-    std::vector<Projectile>& projectiles,
-    std::vector<EnemyTank>& enemies,
-    int projectileDamage,
-    float deltaTime)
+/// <param name="jobs">Job system running the ranges of projectiles.</param>
+void Projectiles::UpdateProjectiles(
+    ProjectilePool& projectiles,
+    PlayerTank& player,
+    EnemyTankPool& enemies,
+    const SpatialGrid& tankGrid,
+    const BuildingIndex& buildings,
+    int damage,
+    float deltaTime,
+    JobSystem& jobs)
 {
-    for (auto itProjectile = projectiles.begin(); itProjectile != projectiles.end(); )
+    float* positionX = projectiles.positionX.data();
+    float* positionY = projectiles.positionY.data();
+    float* positionZ = projectiles.positionZ.data();
+    const float* velocityX = projectiles.velocityX.data();
+    const float* velocityY = projectiles.velocityY.data();
+    const float* velocityZ = projectiles.velocityZ.data();
+    const float* radius = projectiles.radius.data();
+    float* lifespan = projectiles.lifespan.data();
+    const float* maxLifespan = projectiles.maxLifespan.data();
+    std::uint8_t* hitsPlayer = projectiles.hitsPlayer.data();
+    std::uint32_t* hitTarget = projectiles.hitTarget.data();
+
+    jobs.ParallelFor(0, projectiles.Size(), jobQueryGrainSize, [&](std::size_t begin, std::size_t end)
     {
-        itProjectile->position += itProjectile->velocity * deltaTime;
-        itProjectile->lifespan += deltaTime;
+        std::vector<std::uint32_t> candidates;
+
+        // Projectiles within 1 unit of the player's tank center, tested before they move
+        // so a projectile that reached the player hits it even if it expires this tick
+        SphereKernels::TestSpheres(player.position, 1.0f,
+            positionX + begin, positionY + begin, positionZ + begin,
+            nullptr, end - begin, hitsPlayer + begin);
 
-        if (itProjectile->lifespan >= itProjectile->maxLifespan)
+        // Move the projectiles, once per tick
+        for (std::size_t i = begin; i < end; ++i)
         {
-            itProjectile = projectiles.erase(itProjectile); // Erase due to lifespan expiry
+            positionX[i] += velocityX[i] * deltaTime;
+            positionY[i] += velocityY[i] * deltaTime;
+            positionZ[i] += velocityZ[i] * deltaTime;
+            lifespan[i] += deltaTime;
         }
-        else
-        {
-            bool collisionDetected = false;
-            for (auto& enemy : enemies) {
-                if (!enemy.isDestroyed && ProjectileTankCollision(*itProjectile, enemy)) {
-
-                    enemy.health -= projectileDamage;
-                    enemy.deformationLevel = std::min(enemy.deformationLevel + 0.1f, 1.0f);
-
-                    if (enemy.health <= 0) {
-                        enemy.isDestroyed = true;
-                    }
 
-                   collisionDetected = true;
-                    break; // Exit enemy loop
-                }
+        // The player first, then erase due to lifespan expiry, then the tanks and the buildings
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (hitsPlayer[i])
+            {
+                hitTarget[i] = ProjectilePool::hitPlayer;
             }
-
-            if (collisionDetected)
+            else if (lifespan[i] >= maxLifespan[i])
             {
-                // Erase due to collision
-                itProjectile = projectiles.erase(itProjectile);
+                hitTarget[i] = ProjectilePool::hitExpired;
             }
             else
             {
-                // Move to next projectile
-                ++itProjectile;
+                hitTarget[i] = FindTarget(projectiles.GetPosition(i), radius[i], enemies, tankGrid, buildings,
+                                          candidates);
             }
         }
+    });
+
+    // BARRIER: the hits are applied in pool order, they damage the shared tanks and the player
+    const std::size_t count = projectiles.Size();
+    std::vector<std::uint32_t> candidates;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::uint32_t target = hitTarget[i];
+
+        if (target == ProjectilePool::hitPlayer)
+        {
+            // Reduce player's health
+            player.health -= damage;
+        }
+        else if (target < enemies.Size() && enemies.isDestroyed[target])
+        {
+            // An earlier projectile of this tick destroyed the tank, look again
+            target = FindTarget(projectiles.GetPosition(i), radius[i], enemies, tankGrid, buildings, candidates);
+            hitTarget[i] = target;
+        }
+
+        if (target < enemies.Size())
+        {
+            enemies.health[target] -= damage;
+            enemies.cold[target].deformationLevel = std::min(enemies.cold[target].deformationLevel + 0.1f, 1.0f);
+
+            if (enemies.health[target] <= 0)
+            {
+                enemies.isDestroyed[target] = 1;
+            }
+        }
+    }
+
+    // Projectiles dissapear from the back, the last one takes the freed slot and was already kept
+    for (std::size_t i = count; i-- > 0;)
+    {
+        if (hitTarget[i] != ProjectilePool::hitNothing)
+        {
+            projectiles.Remove(i);
+        }
     }
 }
@@ -5,6 +5,10 @@
 
 #include "EnemyTanks.h"
 #include "Buildings.h"
+#include "BuildingIndex.h"
+#include "EnemyTankPool.h"
+#include "ProjectilePool.h"
+#include "SpatialGrid.h"
 
 #include <glm/glm.hpp>
 #include <vector>
@@ -13,6 +17,7 @@
 struct Building;
 struct EnemyTank;
 struct PlayerTank;
+class JobSystem;
 
 
 /// <summary>
@@ -33,35 +38,43 @@ class Projectiles {
 public:
     /// Check if a projectile has collided with an enemy tank
     static bool ProjectileTankCollision(
-        const Projectile& projectile,
-        const EnemyTank& tank
+        const glm::vec3& projectilePosition,
+        const glm::vec3& tankPosition
     );
     
     /// Check if a projectile has collided with the player tank
     static bool ProjectilePlayerCollision(
-        const Projectile& projectile,
+        const glm::vec3& projectilePosition,
         const PlayerTank& player
     );
 
     /// Check if a projectile has collided with a building
     static bool ProjectileBuildingCollision(
-        const Projectile& projectile,
-        const Building& building
+        const glm::vec3& projectilePosition,
+        float projectileRadius,
+        const BuildingRecord& building
     );
 
-    /// Update projectile collisions with the player tank
-    static void UpdateProjectilesPlayerCollision(
-        std::vector<Projectile>& projectiles,
-        PlayerTank& player,
-        int damage
+    /// What a projectile hits: the first alive tank in pool order, else a building (ProjectilePool::hitTarget)
+    static std::uint32_t FindTarget(
+        const glm::vec3& position,
+        float radius,
+        const EnemyTankPool& enemies,
+        const SpatialGrid& tankGrid,
+        const BuildingIndex& buildings,
+        std::vector<std::uint32_t>& candidates
     );
 
-    /// Update projectile movements and collisions with enemy tanks
-    static void UpdateProjectileMovementsAndCollisions(
-        std::vector<Projectile>& projectiles,
-        std::vector<EnemyTank>& enemies,
-        int projectileDamage,
-        float deltaTime
+    /// Move the projectiles and resolve their hits on the player, the tanks and the buildings
+    static void UpdateProjectiles(
+        ProjectilePool& projectiles,
+        PlayerTank& player,
+        EnemyTankPool& enemies,
+        const SpatialGrid& tankGrid,
+        const BuildingIndex& buildings,
+        int damage,
+        float deltaTime,
+        JobSystem& jobs
     );
 };
 
@@ -0,0 +1,171 @@
+#include "RenderQueue.h"
+
+#include "core/gpu/gl_state.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+/// <summary>
+/// Start a frame with the camera the packets are sorted for.
+/// </summary>
+/// <param name="viewMatrix">View matrix of the frame.</param>
+void RenderQueue::Begin(const glm::mat4& viewMatrix)
+{
+    this->viewMatrix = viewMatrix;
+    packets.clear();
+    entries.clear();
+}
+
+
+/// <summary>
+/// Queue a draw, its sort key is built from its state and its depth in view space.
+/// </summary>
+/// <param name="packet">Draw to queue.</param>
+void RenderQueue::Submit(const RenderPacket& packet)
+{
+    if (!packet.shader || !packet.mesh || !packet.shader->GetProgramID()) return;
+
+    // Distance in front of the camera, the float bits of a positive float sort like integers
+    float depth = std::max(-(viewMatrix * glm::vec4(packet.position, 1.0f)).z, 0.0f);
+    std::uint32_t depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+    const std::uint64_t shaderId = GetId(shaderIds, packet.shader) & 0xFF;
+    const std::uint64_t meshId = GetId(meshIds, packet.mesh) & 0xFFFF;
+    const std::uint64_t materialId = GetMaterialId(packet.color, packet.texture) & 0xFF;
+
+    SortEntry entry;
+    entry.key = (shaderId << 56) | (meshId << 40) | (materialId << 32) | depthBits;
+    entry.index = static_cast<std::uint32_t>(packets.size());
+
+    entries.push_back(entry);
+    packets.push_back(packet);
+}
+
+
+/// <summary>
+/// Sort the queued packets by key and draw them in that order.
+/// </summary>
+void RenderQueue::Flush(GpuProfiler* profiler)
+{
+    SortKeys();
+
+    // A scope is timed from its first draw to the first draw of another one, the passes
+    // have their own programs so a scope is usually a single run of the sorted draws
+    const char* scope = nullptr;
+    for (const SortEntry& entry : entries)
+    {
+        const RenderPacket& packet = packets[entry.index];
+        if (profiler && packet.scope != scope)
+        {
+            scope = packet.scope;
+            scope ? profiler->Begin(scope) : profiler->End();
+        }
+
+        Draw(packet);
+    }
+    if (profiler) profiler->End();
+
+    packets.clear();
+    entries.clear();
+}
+
+
+std::uint32_t RenderQueue::GetId(std::unordered_map<const void*, std::uint32_t>& ids, const void* object)
+{
+    auto it = ids.find(object);
+    if (it != ids.end()) return it->second;
+
+    std::uint32_t id = static_cast<std::uint32_t>(ids.size());
+    ids.emplace(object, id);
+    return id;
+}
+
+
+std::uint32_t RenderQueue::GetMaterialId(const glm::vec3& color, GLuint texture)
+{
+    // A handful of materials, a linear search is enough
+    for (std::size_t i = 0; i < materials.size(); ++i)
+    {
+        if (materials[i].color == color && materials[i].texture == texture) return static_cast<std::uint32_t>(i);
+    }
+
+    Material material = { color, texture };
+    materials.push_back(material);
+    return static_cast<std::uint32_t>(materials.size() - 1);
+}
+
+
+/// <summary>
+/// LSD radix sort of the entries by key, one byte per pass (stable).
+/// </summary>
+void RenderQueue::SortKeys()
+{
+    const std::size_t count = entries.size();
+    if (count < 2) return;
+
+    scratch.resize(count);
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        std::size_t offsets[256] = {};
+        for (const SortEntry& entry : entries)
+        {
+            offsets[(entry.key >> shift) & 0xFF]++;
+        }
+
+        // Every key has the same byte, the pass would not move anything
+        if (offsets[(entries[0].key >> shift) & 0xFF] == count) continue;
+
+        std::size_t sum = 0;
+        for (std::size_t& offset : offsets)
+        {
+            std::size_t bucketCount = offset;
+            offset = sum;
+            sum += bucketCount;
+        }
+
+        for (const SortEntry& entry : entries)
+        {
+            scratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+
+/// <summary>
+/// Draw one packet, the GL state and uniform caches skip what the previous packet already set.
+/// </summary>
+/// <param name="packet">Packet to draw.</param>
+void RenderQueue::Draw(const RenderPacket& packet) const
+{
+    Shader* shader = packet.shader;
+    Mesh* mesh = packet.mesh;
+
+    // The view and projection come from the camera uniform block
+    GLState::UseProgram(shader->program);
+
+    shader->SetUniform("Model", packet.model);
+    shader->SetUniform("ObjectColor", packet.color);
+    shader->SetUniform("Health", packet.health);
+    shader->SetUniform("IsTurretPart", packet.isTurretPart);
+    shader->SetUniform("GroundPass", packet.groundPass);
+
+    if (packet.texture)
+    {
+        shader->SetUniform("GroundTexture", packet.textureUnit);
+        GLState::BindTextureToUnit(GL_TEXTURE0 + packet.textureUnit, packet.texture);
+    }
+
+    GLState::BindVertexArray(mesh->GetBuffers()->m_VAO);
+    if (packet.instanceCount > 0)
+    {
+        glDrawElementsInstanced(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, 0,
+                                static_cast<GLsizei>(packet.instanceCount));
+    }
+    else
+    {
+        glDrawElements(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, 0);
+    }
+}
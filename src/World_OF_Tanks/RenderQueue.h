@@ -0,0 +1,100 @@
+#pragma once
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "core/gpu/gpu_profiler.h"
+#include "core/gpu/mesh.h"
+#include "core/gpu/shader.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+/// <summary>
+/// One draw submitted to the render queue: what to draw with which state, and the
+/// per-draw uniforms. The uniforms a shader doesn't declare are ignored.
+/// </summary>
+struct RenderPacket
+{
+    Shader* shader;             // Program of the draw
+    Mesh* mesh;                 // Vertex array and indices
+    glm::vec3 color;            // Material: "ObjectColor"
+    glm::mat4 model;            // "Model"
+    glm::vec3 position;         // World position, gives the view depth of the draw
+    float health;               // "Health"
+    int isTurretPart;           // "IsTurretPart"
+    int groundPass;             // "GroundPass"
+    GLuint texture;             // Material: 2D texture, 0 for none
+    int textureUnit;            // Unit the texture is bound to, "GroundTexture"
+    std::size_t instanceCount;  // 0 for a plain draw, otherwise the instances to draw
+    const char* scope;          // GPU timer scope of the draw, nullptr when not timed
+
+    RenderPacket()
+        : shader(nullptr), mesh(nullptr), color(1.0f), model(1.0f), position(0.0f),
+          health(100.0f), isTurretPart(0), groundPass(0), texture(0), textureUnit(0),
+          instanceCount(0), scope(nullptr) {}
+};
+
+
+/// <summary>
+/// DRAW SUBMISSION DECOUPLED FROM THE SCENE CODE.
+/// The scene submits packets in any order, Flush() sorts them by a 64-bit key and draws them:
+///   [63..56] shader, [55..40] mesh, [39..32] material, [31..0] view depth.
+/// The draws sharing a program are together, then the ones sharing a vertex array and a
+/// material, so the state changes are minimal. Inside a state group the opaque draws go
+/// front to back so the early depth test rejects the hidden fragments.
+/// The keys are sorted with an LSD radix sort (8 passes of 8 bits, the passes over a byte
+/// all the keys share are skipped).
+/// </summary>
+class RenderQueue
+{
+public:
+    /// Start a frame: the view matrix gives the depth of the submitted packets.
+    void Begin(const glm::mat4& viewMatrix);
+
+    /// Queue a draw.
+    void Submit(const RenderPacket& packet);
+
+    /// Sort and draw the queued packets, then empty the queue.
+    /// With a profiler, the runs of draws of a scope are timed on the GPU.
+    void Flush(GpuProfiler* profiler = nullptr);
+
+    std::size_t GetNumPackets() const { return packets.size(); }
+
+private:
+    /// Small stable id of a state object (shader, mesh, material), given the first time it is seen.
+    static std::uint32_t GetId(std::unordered_map<const void*, std::uint32_t>& ids, const void* object);
+    std::uint32_t GetMaterialId(const glm::vec3& color, GLuint texture);
+
+    void SortKeys();
+    void Draw(const RenderPacket& packet) const;
+
+private:
+    struct SortEntry
+    {
+        std::uint64_t key;
+        std::uint32_t index;    // Index of the packet
+    };
+
+    glm::mat4 viewMatrix;
+
+    std::vector<RenderPacket> packets;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;     // Radix sort ping-pong buffer
+
+    std::unordered_map<const void*, std::uint32_t> shaderIds;
+    std::unordered_map<const void*, std::uint32_t> meshIds;
+    struct Material
+    {
+        glm::vec3 color;
+        GLuint texture;
+    };
+    std::vector<Material> materials;    // Materials seen so far, the index is the material id
+};
+
+#endif // RENDER_QUEUE_H
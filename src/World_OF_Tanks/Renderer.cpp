@@ -2,124 +2,312 @@
 #include "EnemyTanks.h"
 #include "GameConstants.h"
 
+#include "core/gpu/gl_state.h"
+
+#include <cstddef>
+
 
 Renderer::Renderer(
     Camera3rdPerson::Camera* camera,
     std::unordered_map<std::string, Mesh*>& meshes,
     std::unordered_map<std::string, Shader*>& shaders
-) : camera(camera), meshes(meshes), shaders(shaders)
+) : camera(camera), meshes(meshes), shaders(shaders), currentScope(nullptr),
+    buildingInstanceBuffer(0), buildingInstanceCapacity(0), buildingInstanceCount(0),
+    enemyInstanceBuffer(0), enemyInstanceCapacity(0), enemyInstanceCount(0)
 { /* DEFAULT EMPTY CONSTRUCTOR */ }
 
 
 /// <summary>
-/// Render a simple mesh using the specified shader and model matrix.
+/// Upload the camera block of the frame and open the render queue for the frame.
+/// The GPU timers of an older frame are read back here.
+/// </summary>
+void Renderer::BeginFrame()
+{
+    gpuProfiler.BeginFrame();
+    UpdateCameraBlock();
+    queue.Begin(GetSceneCamera()->GetViewMatrix());
+    currentScope = nullptr;
+}
+
+
+/// <summary>
+/// Draw the frame: the submitted packets sorted by state, front to back, timed per scope.
+/// </summary>
+void Renderer::EndFrame()
+{
+    queue.Flush(&gpuProfiler);
+    gpuProfiler.EndFrame();
+}
+
+
+/// <summary>
+/// Submit a simple mesh using the specified shader and model matrix.
 /// </summary>
 /// <param name="mesh">Mesh to render.</param>
 /// <param name="shader">Shader to use for rendering.</param>
 /// <param name="modelMatrix">Model transformation matrix.</param>
-void Renderer::RenderSimpleMesh(
+void Renderer::SubmitSimpleMesh(
     Mesh* mesh,
     Shader* shader,
     const glm::mat4& modelMatrix)
 {
-    if (!mesh || !shader || !shader->GetProgramID()) return;
-
-    // Render an object using the specified shader and the specified position
-    glUseProgram(shader->program);
-
-    // Get shader location for uniform mat4 "Model"
-    int modelLocation = glGetUniformLocation(shader->program, "Model");
-    // Set shader uniform "Model" to modelMatrix
-    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(modelMatrix));
-
-    // Get shader location for uniform mat4 "View"
-    int viewLocation = glGetUniformLocation(shader->program, "View");
-    // Set shader uniform "View" to viewMatrix
-    glm::mat4 viewMatrix = GetSceneCamera()->GetViewMatrix();
-    glUniformMatrix4fv(viewLocation, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-
-    // Get shader location for uniform mat4 "Projection"
-    int projectionLocation = glGetUniformLocation(shader->program, "Projection");
-    // Set shader uniform "Projection" to projectionMatrix
-    glm::mat4 projectionMatrix = GetSceneCamera()->GetProjectionMatrix();
-    glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
-
-    float timeLocation = glGetUniformLocation(shader->program, "Time");
-    glUniform1f(timeLocation, Engine::GetElapsedTime());
-
-    // Draw the object
-    glBindVertexArray(mesh->GetBuffers()->m_VAO);
-    glDrawElements(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, 0);
+    RenderPacket packet;
+    packet.shader = shader;
+    packet.mesh = mesh;
+    packet.model = modelMatrix;
+    // The translation of the model gives the depth
+    packet.position = glm::vec3(modelMatrix[3]);
+    packet.scope = currentScope;
+    queue.Submit(packet);
 }
 
 
 /// <summary>
-/// Render an enemy tank using the specified shader and model matrix, applying a color.
+/// Submit the ground plane. The ground pass and the baked texture are part of the packet,
+/// the queue sets them and binds the texture through the GL state cache.
 /// </summary>
-/// <param name="mesh">Mesh of the enemy tank.</param>
-/// <param name="shader">Shader to use for rendering.</param>
+/// <param name="mesh">Plane mesh.</param>
+/// <param name="shader">Ground shader.</param>
 /// <param name="modelMatrix">Model transformation matrix.</param>
-/// <param name="enemy">Enemy tank data.</param>
-/// <param name="color">Color to apply to the tank.</param>
-void Renderer::RenderEnemyTank(
+/// <param name="groundPass">GROUND_PASS_FULL or GROUND_PASS_BAKED.</param>
+/// <param name="texture">Baked ground texture, 0 when the full noise is drawn.</param>
+/// <param name="textureUnit">Texture unit of the baked ground texture.</param>
+void Renderer::SubmitGround(
     Mesh* mesh,
     Shader* shader,
     const glm::mat4& modelMatrix,
-    EnemyTank& enemy,
-    const glm::vec3& color)
+    int groundPass,
+    GLuint texture,
+    int textureUnit)
 {
-    if (!mesh || !shader || !shader->GetProgramID()) return;
+    RenderPacket packet;
+    packet.shader = shader;
+    packet.mesh = mesh;
+    packet.model = modelMatrix;
+    packet.position = glm::vec3(modelMatrix[3]);
+    packet.groundPass = groundPass;
+    packet.texture = texture;
+    packet.textureUnit = textureUnit;
+    packet.scope = currentScope;
+    queue.Submit(packet);
+}
 
-    glUseProgram(shader->program);
 
-    glUniform3fv(glGetUniformLocation(shader->program, "ObjectColor"), 1, glm::value_ptr(color));
+/// <summary>
+/// Projection * view of the scene camera, the same matrix as the camera block of the frame.
+/// </summary>
+glm::mat4 Renderer::GetViewProjection() const
+{
+    return GetSceneCamera()->GetProjectionMatrix() * GetSceneCamera()->GetViewMatrix();
+}
 
-    glUniformMatrix4fv(glGetUniformLocation(shader->program, "Model"), 1, GL_FALSE, glm::value_ptr(modelMatrix));
-    glUniformMatrix4fv(glGetUniformLocation(shader->program, "View"), 1, GL_FALSE, glm::value_ptr(GetSceneCamera()->GetViewMatrix()));
-    glUniformMatrix4fv(glGetUniformLocation(shader->program, "Projection"), 1, GL_FALSE, glm::value_ptr(GetSceneCamera()->GetProjectionMatrix()));
 
-    glUniform1f(glGetUniformLocation(shader->program, "Health"), enemy.health);
+/// <summary>
+/// Create the building instance buffer and attach it to the VAO of the shared cube.
+/// Attributes 4, 5 and 6 hold the position, the scale and the color, advanced once per instance.
+/// </summary>
+/// <param name="cube">Unit cube mesh shared by the buildings.</param>
+void Renderer::InitBuildingInstancing(Mesh* cube)
+{
+    if (!cube) return;
+
+    if (!buildingInstanceBuffer)
+    {
+        buildingInstanceCapacity = 64;
+        glGenBuffers(1, &buildingInstanceBuffer);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, buildingInstanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(BuildingInstance) * buildingInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    GLState::BindVertexArray(cube->GetBuffers()->m_VAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, buildingInstanceBuffer);
+
+    // Set instance position attribute
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(BuildingInstance),
+        (void*)(offsetof(BuildingInstance, position)));
+    glVertexAttribDivisor(4, 1);
+
+    // Set instance scale attribute
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(BuildingInstance),
+        (void*)(offsetof(BuildingInstance, scale)));
+    glVertexAttribDivisor(5, 1);
+
+    // Set instance color attribute
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, sizeof(BuildingInstance),
+        (void*)(offsetof(BuildingInstance, color)));
+    glVertexAttribDivisor(6, 1);
+
+    GLState::BindVertexArray(0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindVertexArray(mesh->GetBuffers()->m_VAO);
-    glDrawElements(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, 0);
+    CheckOpenGLError();
+}
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+
+/// <summary>
+/// Upload the building instances of this frame (the ones in the view frustum),
+/// the buffer grows by doubling and is orphaned like the enemy tank one.
+/// </summary>
+/// <param name="instances">Instances of the buildings to draw.</param>
+void Renderer::UploadBuildingInstances(const std::vector<BuildingInstance>& instances)
+{
+    buildingInstanceCount = instances.size();
+    if (!buildingInstanceBuffer || instances.empty()) return;
+
+    while (buildingInstanceCapacity < instances.size()) buildingInstanceCapacity *= 2;
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, buildingInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(BuildingInstance) * buildingInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(BuildingInstance) * instances.size(), &instances[0]);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 
 /// <summary>
-/// Render player tank using the specified shader and model matrix, applying a color.
+/// Submit all the uploaded buildings as one instanced draw of the shared cube.
+/// </summary>
+/// <param name="cube">Unit cube mesh shared by the buildings.</param>
+/// <param name="shader">Instanced building shader.</param>
+void Renderer::SubmitBuildings(Mesh* cube, Shader* shader)
+{
+    if (buildingInstanceCount == 0) return;
+
+    RenderPacket packet;
+    packet.shader = shader;
+    packet.mesh = cube;
+    packet.instanceCount = buildingInstanceCount;
+    packet.scope = currentScope;
+    queue.Submit(packet);
+}
+
+
+/// <summary>
+/// Create the enemy tank instance buffer and attach it to the VAO of every tank part.
+/// Attributes 4 to 7 hold the body frame, 8 to 11 the turret frame and 12 the (health, sink depth),
+/// all advanced once per instance. The player draws the same meshes without instancing,
+/// the buffer always holds at least one instance so these draws read valid memory.
+/// </summary>
+/// <param name="parts">Meshes of the tank parts (body, turret, cannon, wheels).</param>
+void Renderer::InitEnemyTankInstancing(const std::vector<Mesh*>& parts)
+{
+    if (!enemyInstanceBuffer)
+    {
+        enemyInstanceCapacity = 64;
+        glGenBuffers(1, &enemyInstanceBuffer);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, enemyInstanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(EnemyTankInstance) * enemyInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    for (Mesh* mesh : parts)
+    {
+        if (!mesh) continue;
+
+        GLState::BindVertexArray(mesh->GetBuffers()->m_VAO);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, enemyInstanceBuffer);
+
+        // A mat4 attribute takes 4 vec4 locations
+        for (int column = 0; column < 4; ++column)
+        {
+            glEnableVertexAttribArray(4 + column);
+            glVertexAttribPointer(4 + column, 4, GL_FLOAT, GL_FALSE, sizeof(EnemyTankInstance),
+                (void*)(offsetof(EnemyTankInstance, model) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(4 + column, 1);
+
+            glEnableVertexAttribArray(8 + column);
+            glVertexAttribPointer(8 + column, 4, GL_FLOAT, GL_FALSE, sizeof(EnemyTankInstance),
+                (void*)(offsetof(EnemyTankInstance, turretModel) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(8 + column, 1);
+        }
+
+        // Health and sink depth side by side
+        glEnableVertexAttribArray(12);
+        glVertexAttribPointer(12, 2, GL_FLOAT, GL_FALSE, sizeof(EnemyTankInstance),
+            (void*)(offsetof(EnemyTankInstance, health)));
+        glVertexAttribDivisor(12, 1);
+    }
+
+    GLState::BindVertexArray(0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CheckOpenGLError();
+}
+
+
+/// <summary>
+/// Upload the enemy tank instances of this frame, the buffer grows by doubling.
+/// The storage is orphaned every frame so the upload doesn't wait for the previous draws.
+/// </summary>
+/// <param name="instances">Instances of the enemy tanks to draw.</param>
+void Renderer::UploadEnemyTankInstances(const std::vector<EnemyTankInstance>& instances)
+{
+    enemyInstanceCount = instances.size();
+    if (!enemyInstanceBuffer || instances.empty()) return;
+
+    while (enemyInstanceCapacity < instances.size()) enemyInstanceCapacity *= 2;
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, enemyInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(EnemyTankInstance) * enemyInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(EnemyTankInstance) * instances.size(), &instances[0]);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+/// <summary>
+/// Submit one part of every uploaded enemy tank as one instanced draw.
+/// </summary>
+/// <param name="mesh">Mesh of the tank part.</param>
+/// <param name="shader">Instanced enemy shader.</param>
+/// <param name="partMatrix">Placement of the part in its frame.</param>
+/// <param name="isTurretPart">The part moves with the turret (turret frame), otherwise with the body.</param>
+/// <param name="color">Color to apply to the part.</param>
+void Renderer::SubmitEnemyTankPart(
+    Mesh* mesh,
+    Shader* shader,
+    const glm::mat4& partMatrix,
+    bool isTurretPart,
+    const glm::vec3& color)
+{
+    if (enemyInstanceCount == 0) return;
+
+    RenderPacket packet;
+    packet.shader = shader;
+    packet.mesh = mesh;
+    packet.color = color;
+    packet.model = partMatrix;
+    packet.isTurretPart = isTurretPart ? 1 : 0;
+    packet.instanceCount = enemyInstanceCount;
+    packet.scope = currentScope;
+    queue.Submit(packet);
+}
+
+
+/// <summary>
+/// Submit a player tank part using the specified shader and model matrix, applying a color.
 /// </summary>
 /// <param name="mesh">Mesh of the player tank.</param>
 /// <param name="shader">Shader to use for rendering.</param>
 /// <param name="modelMatrix">Model transformation matrix.</param>
 /// <param name="player">Player tank data.</param>
 /// <param name="color">Color to apply to the tank.</param>
-void Renderer::RenderPlayerTank(
+void Renderer::SubmitPlayerTank(
     Mesh* mesh,
     Shader* shader,
     const glm::mat4& modelMatrix,
     PlayerTank& player,
     const glm::vec3& color)
 {
-    if (!mesh || !shader || !shader->GetProgramID()) return;
-
-    glUseProgram(shader->program);
-
-    glUniform3fv(glGetUniformLocation(shader->program, "ObjectColor"), 1, glm::value_ptr(color));
-    
-    glUniformMatrix4fv(glGetUniformLocation(shader->program, "Model"), 1, GL_FALSE, glm::value_ptr(modelMatrix));
-    glUniformMatrix4fv(glGetUniformLocation(shader->program, "View"), 1, GL_FALSE, glm::value_ptr(GetSceneCamera()->GetViewMatrix()));
-    glUniformMatrix4fv(glGetUniformLocation(shader->program, "Projection"), 1, GL_FALSE, glm::value_ptr(GetSceneCamera()->GetProjectionMatrix()));
-
-    glUniform1f(glGetUniformLocation(shader->program, "Health"), player.health);
-
-    glBindVertexArray(mesh->GetBuffers()->m_VAO);
-    glDrawElements(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, 0);
-
-    glBindVertexArray(0);
-    glUseProgram(0);
+    RenderPacket packet;
+    packet.shader = shader;
+    packet.mesh = mesh;
+    packet.color = color;
+    packet.model = modelMatrix;
+    packet.position = glm::vec3(modelMatrix[3]);
+    packet.health = static_cast<float>(player.health);
+    packet.scope = currentScope;
+    queue.Submit(packet);
 }
 
 
@@ -139,12 +327,12 @@ Mesh* Renderer::CreateMesh(
     unsigned int VAO = 0;
     // Create the VAO and bind it
     glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    GLState::BindVertexArray(VAO);
 
     // Create the VBO and bind it
     unsigned int VBO;
     glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
 
     // Send vertices data into the VBO buffer
     glBufferData(GL_ARRAY_BUFFER,
@@ -153,7 +341,7 @@ Mesh* Renderer::CreateMesh(
     // Create the IBO and bind it
     unsigned int IBO;
     glGenBuffers(1, &IBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
 
     // Send indices data into the IBO buffer
     glBufferData(GL_ELEMENT_ARRAY_BUFFER,
@@ -179,7 +367,7 @@ Mesh* Renderer::CreateMesh(
         sizeof(VertexFormat), (void*)(2 * sizeof(glm::vec3) + sizeof(glm::vec2)));
 
     // Unbind the VAO
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
 
     // Check for OpenGL errors
     CheckOpenGLError();
@@ -10,6 +10,7 @@
 
 #include "Camera3rdPerson.h"
 #include "Transforms3D.h"
+#include "RenderQueue.h"
 
 #include <glm/glm.hpp>
 #include <string>
@@ -17,10 +18,33 @@
 #include <unordered_map>
 
 
-struct EnemyTank;
 struct PlayerTank;
 
 
+/// <summary>
+/// Per-tank data of the instanced enemy tank parts (one entry per tank drawn).
+/// The body parts are placed in the body frame, the turret and the cannon in the turret frame.
+/// </summary>
+struct EnemyTankInstance
+{
+    glm::mat4 model;        // Body frame: position and rotation of the tank
+    glm::mat4 turretModel;  // Turret frame: body frame with the turret rotation
+    float health;           // Health of the tank, shades the damage
+    float sinkDepth;        // Depth the destroyed tank has sunk to (0 while alive)
+};
+
+
+/// <summary>
+/// Per-building data of the instanced unit cube (one entry per building).
+/// </summary>
+struct BuildingInstance
+{
+    glm::vec3 position;     // Center of the building
+    glm::vec3 scale;        // Half-extents of the building (the cube spans -1 to 1)
+    glm::vec3 color;        // Color of the building
+};
+
+
 class Renderer : public gfxc::SimpleScene  {
 public:
     Renderer(
@@ -29,13 +53,35 @@ public:
         std::unordered_map<std::string, Shader*>& shaders
     );
 
-    /// Render a simple mesh using the specified shader and model matrix
-    void RenderSimpleMesh(
+    /// Start a frame: upload the camera block and open the render queue
+    void BeginFrame();
+
+    /// Sort and draw everything submitted since BeginFrame
+    void EndFrame();
+
+    /// GPU timer scope of the next submitted draws (nullptr: not timed)
+    void SetScope(const char* scope) { currentScope = scope; }
+
+    /// GPU time of the scopes, read back a few frames late
+    GpuProfiler& GetGpuProfiler() { return gpuProfiler; }
+
+    /// Submit a simple mesh using the specified shader and model matrix
+    void SubmitSimpleMesh(
         Mesh* mesh,
         Shader* shader,
         const glm::mat4& modelMatrix
     );
 
+    /// Submit the ground plane, drawn with the given ground pass and baked texture (0 for none)
+    void SubmitGround(
+        Mesh* mesh,
+        Shader* shader,
+        const glm::mat4& modelMatrix,
+        int groundPass,
+        GLuint texture,
+        int textureUnit
+    );
+
     /// Create a mesh with the given name, vertices, and indices
     Mesh* CreateMesh(
         const char* name,
@@ -43,18 +89,35 @@ public:
         const std::vector<unsigned int>& indices
     );
 
-    /// Render an enemy tank using the specified shader, model matrix, and color
-    void RenderEnemyTank(
+    /// Projection * view of the scene camera, the frustum of the frame
+    glm::mat4 GetViewProjection() const;
+
+    /// Attach the building instance buffer to the VAO of the shared unit cube
+    void InitBuildingInstancing(Mesh* cube);
+
+    /// Upload the instances of the buildings drawn this frame
+    void UploadBuildingInstances(const std::vector<BuildingInstance>& instances);
+
+    /// Submit all the uploaded buildings as a single instanced draw
+    void SubmitBuildings(Mesh* cube, Shader* shader);
+
+    /// Attach the enemy tank instance buffer to the VAOs of the tank parts
+    void InitEnemyTankInstancing(const std::vector<Mesh*>& parts);
+
+    /// Upload the instances of the enemy tanks drawn this frame
+    void UploadEnemyTankInstances(const std::vector<EnemyTankInstance>& instances);
+
+    /// Submit one part of all the uploaded enemy tanks as a single instanced draw
+    void SubmitEnemyTankPart(
         Mesh* mesh,
         Shader* shader,
-        const glm::mat4& modelMatrix,
-        
-        EnemyTank& enemy,
+        const glm::mat4& partMatrix,
+        bool isTurretPart,
         const glm::vec3& color
     );
 
-    /// Render player tank using the specified shader, model matrix, and color.
-    void RenderPlayerTank(
+    /// Submit a player tank part using the specified shader, model matrix, and color.
+    void SubmitPlayerTank(
         Mesh* mesh,
         Shader* shader,
         const glm::mat4& modelMatrix,
@@ -67,6 +130,18 @@ private:
     Camera3rdPerson::Camera* camera;
     std::unordered_map<std::string, Mesh*>& meshes;
     std::unordered_map<std::string, Shader*>& shaders;
+
+    RenderQueue queue;                  // Draws of the frame, sorted by state and depth
+    GpuProfiler gpuProfiler;            // GPU time of the scopes of the frame
+    const char* currentScope;           // Scope of the submitted draws
+
+    GLuint buildingInstanceBuffer;          // Instance buffer of the building cube
+    std::size_t buildingInstanceCapacity;   // Instances the buffer can hold
+    std::size_t buildingInstanceCount;      // Instances uploaded this frame
+
+    GLuint enemyInstanceBuffer;         // Instance buffer shared by the tank parts
+    std::size_t enemyInstanceCapacity;  // Instances the buffer can hold
+    std::size_t enemyInstanceCount;     // Instances uploaded this frame
 };
 
 #endif // RENDERER_H
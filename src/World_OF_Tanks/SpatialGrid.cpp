@@ -0,0 +1,78 @@
+#include "SpatialGrid.h"
+
+
+SpatialGrid::SpatialGrid(float cellSize, float slack)
+    : cellSize(cellSize), invCellSize(1.0f / cellSize), slack(slack), bucketMask(0), rowShift(0)
+{ /* DEFAULT EMPTY CONSTRUCTOR BODY */ }
+
+
+/// <summary>
+/// Rebuild the grid from the current positions using a counting sort on the buckets.
+/// </summary>
+/// <param name="count">Number of entities.</param>
+/// <param name="xs">Pointer to the X coordinate of the first entity.</param>
+/// <param name="zs">Pointer to the Z coordinate of the first entity.</param>
+/// <param name="strideBytes">Distance in bytes between two consecutive entities.</param>
+void SpatialGrid::Build(std::size_t count, const float* xs, const float* zs, std::size_t strideBytes)
+{
+    // Power of two table with at least two buckets per entity, keeps the chains short
+    std::uint32_t numBuckets = 16;
+    rowShift = 2;
+    while (numBuckets < 2 * count)
+    {
+        numBuckets <<= 1;
+        // A square table: the row length grows every other doubling
+        rowShift += numBuckets > (1u << (2 * rowShift)) ? 1 : 0;
+    }
+    bucketMask = numBuckets - 1;
+
+    bucketStart.assign(numBuckets + 1, 0);
+    entries.resize(count);
+    scratch.resize(count);
+
+    const char* xBytes = reinterpret_cast<const char*>(xs);
+    const char* zBytes = reinterpret_cast<const char*>(zs);
+
+    // Count the entities in every bucket
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float x = *reinterpret_cast<const float*>(xBytes + i * strideBytes);
+        float z = *reinterpret_cast<const float*>(zBytes + i * strideBytes);
+
+        std::uint32_t bucket = Bucket(CellCoord(x), CellCoord(z));
+        scratch[i] = bucket;
+        bucketStart[bucket + 1]++;
+    }
+
+    // Prefix sum: where every bucket starts in the entries array
+    for (std::uint32_t b = 0; b < numBuckets; ++b)
+    {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // Scatter, a running cursor per bucket keeps the entities in index order
+    cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float x = *reinterpret_cast<const float*>(xBytes + i * strideBytes);
+        float z = *reinterpret_cast<const float*>(zBytes + i * strideBytes);
+
+        Entry& entry = entries[cursor[scratch[i]]++];
+        entry.cellX = CellCoord(x);
+        entry.cellZ = CellCoord(z);
+        entry.index = static_cast<std::uint32_t>(i);
+    }
+}
+
+
+/// <summary>
+/// Collect the candidates around a position. The cells are visited in rows and Build
+/// keeps the entities of a bucket in index order, so the order is stable from tick to tick.
+/// </summary>
+/// <param name="center">Center of the query.</param>
+/// <param name="radius">Interaction distance around the center.</param>
+/// <param name="out">Receives the candidate indices (appended).</param>
+void SpatialGrid::Collect(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const
+{
+    Query(center, radius, [&out](std::uint32_t index) { out.push_back(index); });
+}
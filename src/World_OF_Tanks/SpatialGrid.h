@@ -0,0 +1,143 @@
+#pragma once
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// <summary>
+/// UNIFORM SPATIAL HASH ON THE XZ PLANE (BROADPHASE FOR MOVING ENTITIES).
+/// Entities are bucketed by the cell that contains their position, the cells are
+/// hashed into a table sized from the entity count, so the memory does not depend
+/// on the arena size. Rebuilt from scratch every tick with a counting sort: O(n).
+/// The cells of a row go to consecutive buckets, a query reads a few short runs of
+/// the table and walking the entities in grid order keeps the queries in the cache.
+/// </summary>
+class SpatialGrid
+{
+public:
+    /// Cell size should be close to the largest interaction distance.
+    explicit SpatialGrid(float cellSize = 4.0f, float slack = 1.0f);
+
+    /// Bucket `count` positions, the X and Z coordinates are read every `strideBytes`.
+    void Build(std::size_t count, const float* xs, const float* zs, std::size_t strideBytes);
+
+    /// <summary>
+    /// Call fn(index) for every entity whose cell overlaps the square of half size
+    /// (radius + slack) around the center. Each entity is reported once, the exact
+    /// distance test is left to the caller.
+    /// </summary>
+    template <typename Fn>
+    void Query(const glm::vec3& center, float radius, Fn fn) const;
+
+    /// Same search as Query, stops at the first entity for which pred(index) is true.
+    template <typename Pred>
+    bool Any(const glm::vec3& center, float radius, Pred pred) const;
+
+    /// <summary>
+    /// Append the indices returned by Query to out, cell by cell and in index order inside
+    /// a cell: the order only depends on the positions, no sort is needed for a stable iteration.
+    /// </summary>
+    void Collect(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const;
+
+    void SetCellSize(float newCellSize) { cellSize = newCellSize; invCellSize = 1.0f / newCellSize; }
+    float GetCellSize() const { return cellSize; }
+    // Extra query margin for entities that moved since the last Build
+    void SetSlack(float newSlack) { slack = newSlack; }
+    float GetSlack() const { return slack; }
+
+    std::size_t GetCount() const { return entries.size(); }
+    /// Entity at a slot of the grid order: cell by cell along the rows, index order in a cell.
+    std::uint32_t GetEntity(std::size_t slot) const { return entries[slot].index; }
+
+private:
+    int CellCoord(float v) const { return static_cast<int>(std::floor(v * invCellSize)); }
+    std::uint32_t Bucket(int cx, int cz) const
+    {
+        // Row major: neighbour cells of a row are neighbour buckets, the rows wrap around the table
+        std::uint32_t h = static_cast<std::uint32_t>(cx) +
+                          (static_cast<std::uint32_t>(cz) << rowShift);
+        return h & bucketMask;
+    }
+
+private:
+    struct Entry
+    {
+        std::int32_t cellX;     // Cell of the entity, filters hash collisions
+        std::int32_t cellZ;
+        std::uint32_t index;    // Index of the entity in the caller's array
+    };
+
+    float cellSize;
+    float invCellSize;
+    float slack;
+
+    std::uint32_t bucketMask;
+    std::uint32_t rowShift;                 // Buckets per row of cells (log2)
+
+    std::vector<std::uint32_t> bucketStart; // Offset of every bucket in entries (size buckets + 1)
+    std::vector<Entry> entries;             // Entities sorted by bucket
+    std::vector<std::uint32_t> scratch;     // Bucket of every entity during Build
+    std::vector<std::uint32_t> cursor;      // Write offset of every bucket during Build
+};
+
+
+/// <summary>
+/// Neighbour lists of a block of entities, gathered by one job.
+/// The list of entities[k] is indices[offsets[k], offsets[k + 1]).
+/// </summary>
+struct NeighbourBlock
+{
+    std::vector<std::uint32_t> entities;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> indices;
+};
+
+
+template <typename Pred>
+bool SpatialGrid::Any(const glm::vec3& center, float radius, Pred pred) const
+{
+    if (entries.empty())
+    {
+        return false;
+    }
+
+    float reach = radius + slack;
+    int minX = CellCoord(center.x - reach);
+    int maxX = CellCoord(center.x + reach);
+    int minZ = CellCoord(center.z - reach);
+    int maxZ = CellCoord(center.z + reach);
+
+    for (int cz = minZ; cz <= maxZ; ++cz)
+    {
+        for (int cx = minX; cx <= maxX; ++cx)
+        {
+            std::uint32_t bucket = Bucket(cx, cz);
+            for (std::uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; ++i)
+            {
+                const Entry& entry = entries[i];
+                // Different cells can share a bucket, skip the ones not queried
+                if (entry.cellX == cx && entry.cellZ == cz && pred(entry.index))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+template <typename Fn>
+void SpatialGrid::Query(const glm::vec3& center, float radius, Fn fn) const
+{
+    Any(center, radius, [&fn](std::uint32_t index) { fn(index); return false; });
+}
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,333 @@
+#include "SphereKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#   include <immintrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#   define SPHERE_KERNELS_X86 1
+#endif
+
+
+namespace
+{
+    /// <summary>
+    /// Ask the CPU (and the OS, for the AVX registers) which instruction sets are usable.
+    /// </summary>
+    void QueryCpu(bool& hasSse4, bool& hasAvx2)
+    {
+        hasSse4 = false;
+        hasAvx2 = false;
+
+#if defined(SPHERE_KERNELS_X86) && defined(_MSC_VER)
+        int info[4] = { 0, 0, 0, 0 };
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        hasSse4 = (info[2] & (1 << 19)) != 0;                 // SSE4.1
+        const bool osUsesXsave = (info[2] & (1 << 27)) != 0;  // OSXSAVE
+        const bool hasAvx = (info[2] & (1 << 28)) != 0;
+
+        // The OS must save the YMM registers on context switches
+        bool ymmEnabled = osUsesXsave && hasAvx && ((_xgetbv(0) & 0x6) == 0x6);
+        if (maxLeaf >= 7 && ymmEnabled)
+        {
+            __cpuidex(info, 7, 0);
+            hasAvx2 = (info[1] & (1 << 5)) != 0;
+        }
+#elif defined(SPHERE_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        hasSse4 = __builtin_cpu_supports("sse4.1") != 0;
+        hasAvx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+
+    std::atomic<int>& SelectedIsa()
+    {
+        static std::atomic<int> selected(static_cast<int>(SphereKernels::DetectIsa()));
+        return selected;
+    }
+}
+
+
+/// <summary>
+/// Scalar kernel, also used for the tails of the SIMD kernels.
+/// </summary>
+std::size_t SphereKernels::TestSpheresScalar(
+    const glm::vec3& center, float radius,
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* hits)
+{
+    std::size_t numHits = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float dx = xs[i] - center.x;
+        float dy = ys[i] - center.y;
+        float dz = zs[i] - center.z;
+        float reach = radius + (radii ? radii[i] : 0.0f);
+
+        std::uint8_t hit = static_cast<std::uint8_t>(dx * dx + dy * dy + dz * dz < reach * reach);
+        hits[i] = hit;
+        numHits += hit;
+    }
+    return numHits;
+}
+
+
+/// <summary>
+/// Scalar frustum kernel for spheres, also used for the tails of the SIMD kernels.
+/// </summary>
+std::size_t SphereKernels::SpheresInFrustumScalar(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* visible)
+{
+    std::size_t numVisible = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float radius = radii ? radii[i] : 0.0f;
+
+        // No early out, the SIMD kernels test all the planes too
+        bool inside = true;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const glm::vec4& p = planes[plane];
+            float distance = p.x * xs[i] + p.y * ys[i] + p.z * zs[i] + p.w;
+            inside = inside && distance >= -radius;
+        }
+
+        visible[i] = static_cast<std::uint8_t>(inside);
+        numVisible += inside;
+    }
+    return numVisible;
+}
+
+
+/// <summary>
+/// Scalar frustum kernel for boxes, also used for the tails of the SIMD kernels.
+/// The box reaches |n.x| * e.x + |n.y| * e.y + |n.z| * e.z towards a plane of normal n.
+/// </summary>
+std::size_t SphereKernels::BoxesInFrustumScalar(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs,
+    const float* extentsX, const float* extentsY, const float* extentsZ,
+    std::size_t count, std::uint8_t* visible)
+{
+    std::size_t numVisible = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bool inside = true;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const glm::vec4& p = planes[plane];
+            float distance = p.x * xs[i] + p.y * ys[i] + p.z * zs[i] + p.w;
+            float reach = std::fabs(p.x) * extentsX[i] + std::fabs(p.y) * extentsY[i] + std::fabs(p.z) * extentsZ[i];
+            inside = inside && distance >= -reach;
+        }
+
+        visible[i] = static_cast<std::uint8_t>(inside);
+        numVisible += inside;
+    }
+    return numVisible;
+}
+
+
+/// <summary>
+/// Best kernel supported by this build and by the CPU running it.
+/// </summary>
+SphereKernels::Isa SphereKernels::DetectIsa()
+{
+    bool hasSse4 = false;
+    bool hasAvx2 = false;
+    QueryCpu(hasSse4, hasAvx2);
+
+    if (hasAvx2 && HasAvx2Kernel()) return Isa::AVX2;
+    if (hasSse4 && HasSse4Kernel()) return Isa::SSE4;
+    return Isa::Scalar;
+}
+
+
+bool SphereKernels::IsSupported(Isa isa)
+{
+    return static_cast<int>(isa) <= static_cast<int>(DetectIsa());
+}
+
+
+SphereKernels::Isa SphereKernels::GetIsa()
+{
+    return static_cast<Isa>(SelectedIsa().load(std::memory_order_relaxed));
+}
+
+
+void SphereKernels::SetIsa(Isa isa)
+{
+    // AVX2 machines also run SSE4, so the supported kernels are a prefix of the enum
+    Isa best = DetectIsa();
+    if (static_cast<int>(isa) > static_cast<int>(best))
+    {
+        isa = best;
+    }
+    SelectedIsa().store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+
+const char* SphereKernels::GetIsaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::AVX2: return "avx2";
+    case Isa::SSE4: return "sse4";
+    default:        return "scalar";
+    }
+}
+
+
+/// <summary>
+/// Test with the kernel selected for this CPU.
+/// </summary>
+std::size_t SphereKernels::TestSpheres(
+    const glm::vec3& center, float radius,
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* hits)
+{
+    return TestSpheres(GetIsa(), center, radius, xs, ys, zs, radii, count, hits);
+}
+
+
+/// <summary>
+/// Test with a given kernel, unsupported kernels fall back to the best supported one.
+/// </summary>
+std::size_t SphereKernels::TestSpheres(
+    Isa isa,
+    const glm::vec3& center, float radius,
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* hits)
+{
+    static const Isa best = DetectIsa();
+    if (static_cast<int>(isa) > static_cast<int>(best))
+    {
+        isa = best;
+    }
+
+    switch (isa)
+    {
+    case Isa::AVX2: return TestSpheresAvx2(center, radius, xs, ys, zs, radii, count, hits);
+    case Isa::SSE4: return TestSpheresSse4(center, radius, xs, ys, zs, radii, count, hits);
+    default:        return TestSpheresScalar(center, radius, xs, ys, zs, radii, count, hits);
+    }
+}
+
+
+/// <summary>
+/// Gather the listed entities in packed lanes on the stack, test them with the
+/// selected kernel and compact the indices of the hits in place.
+/// </summary>
+std::size_t SphereKernels::FilterSpheres(
+    const glm::vec3& center, float radius,
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::uint32_t* indices, std::size_t count)
+{
+    const std::size_t lanes = 64;
+    float x[lanes], y[lanes], z[lanes], r[lanes];
+    std::uint8_t hits[lanes];
+
+    std::size_t kept = 0;
+    for (std::size_t first = 0; first < count; first += lanes)
+    {
+        const std::size_t n = std::min(lanes, count - first);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            const std::uint32_t entity = indices[first + k];
+            x[k] = xs[entity];
+            y[k] = ys[entity];
+            z[k] = zs[entity];
+            r[k] = radii ? radii[entity] : 0.0f;
+        }
+
+        TestSpheres(center, radius, x, y, z, r, n, hits);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            // kept <= first + k, the entries not read yet are never overwritten
+            if (hits[k])
+            {
+                indices[kept++] = indices[first + k];
+            }
+        }
+    }
+    return kept;
+}
+
+
+/// <summary>
+/// Frustum test of spheres with the kernel selected for this CPU.
+/// </summary>
+std::size_t SphereKernels::SpheresInFrustum(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* visible)
+{
+    return SpheresInFrustum(GetIsa(), planes, xs, ys, zs, radii, count, visible);
+}
+
+
+std::size_t SphereKernels::SpheresInFrustum(
+    Isa isa,
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* visible)
+{
+    static const Isa best = DetectIsa();
+    if (static_cast<int>(isa) > static_cast<int>(best))
+    {
+        isa = best;
+    }
+
+    switch (isa)
+    {
+    case Isa::AVX2: return SpheresInFrustumAvx2(planes, xs, ys, zs, radii, count, visible);
+    case Isa::SSE4: return SpheresInFrustumSse4(planes, xs, ys, zs, radii, count, visible);
+    default:        return SpheresInFrustumScalar(planes, xs, ys, zs, radii, count, visible);
+    }
+}
+
+
+/// <summary>
+/// Frustum test of boxes with the kernel selected for this CPU.
+/// </summary>
+std::size_t SphereKernels::BoxesInFrustum(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs,
+    const float* extentsX, const float* extentsY, const float* extentsZ,
+    std::size_t count, std::uint8_t* visible)
+{
+    return BoxesInFrustum(GetIsa(), planes, xs, ys, zs, extentsX, extentsY, extentsZ, count, visible);
+}
+
+
+std::size_t SphereKernels::BoxesInFrustum(
+    Isa isa,
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs,
+    const float* extentsX, const float* extentsY, const float* extentsZ,
+    std::size_t count, std::uint8_t* visible)
+{
+    static const Isa best = DetectIsa();
+    if (static_cast<int>(isa) > static_cast<int>(best))
+    {
+        isa = best;
+    }
+
+    switch (isa)
+    {
+    case Isa::AVX2: return BoxesInFrustumAvx2(planes, xs, ys, zs, extentsX, extentsY, extentsZ, count, visible);
+    case Isa::SSE4: return BoxesInFrustumSse4(planes, xs, ys, zs, extentsX, extentsY, extentsZ, count, visible);
+    default:        return BoxesInFrustumScalar(planes, xs, ys, zs, extentsX, extentsY, extentsZ, count, visible);
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#ifndef SPHERE_KERNELS_H
+#define SPHERE_KERNELS_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// <summary>
+/// BATCHED SPHERE-VS-SPHERE HIT TESTS AND FRUSTUM TESTS.
+/// One sphere is tested against N packed positions (X, Y and Z in separate arrays)
+/// with squared distances, no sqrt per pair. The frustum tests check N packed spheres
+/// or boxes against the 6 planes of a view frustum. The AVX2 (8 lanes) and SSE4 (4 lanes)
+/// kernels live in their own translation units compiled for those instruction sets,
+/// the best one supported by the CPU is chosen at runtime.
+/// </summary>
+class SphereKernels
+{
+public:
+    enum class Isa
+    {
+        Scalar,
+        SSE4,
+        AVX2
+    };
+
+    /// <summary>
+    /// hits[i] = 1 when |p_i - center|^2 < (radius + radii[i])^2, otherwise 0.
+    /// `radii` may be null, then every position is a point (radius 0).
+    /// Returns the number of hits. Uses the kernel selected for this CPU.
+    /// </summary>
+    static std::size_t TestSpheres(
+        const glm::vec3& center, float radius,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* hits);
+
+    /// Same test with a given kernel, falls back to the best supported one.
+    static std::size_t TestSpheres(
+        Isa isa,
+        const glm::vec3& center, float radius,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* hits);
+
+    /// <summary>
+    /// Same test on the entities listed in indices[0, count) (grid query results): their
+    /// positions are gathered into packed lanes and tested with TestSpheres. The entities
+    /// that hit are kept at the front of `indices`, in order. Returns how many were kept.
+    /// </summary>
+    static std::size_t FilterSpheres(
+        const glm::vec3& center, float radius,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::uint32_t* indices, std::size_t count);
+
+    /// <summary>
+    /// visible[i] = 1 when the sphere (p_i, radii[i]) is not fully behind one of the 6
+    /// normalized frustum planes (dot(n, p) + w < -r), otherwise 0.
+    /// `radii` may be null, then every position is a point. Returns the number visible.
+    /// </summary>
+    static std::size_t SpheresInFrustum(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* visible);
+
+    /// Same test with a given kernel, falls back to the best supported one.
+    static std::size_t SpheresInFrustum(
+        Isa isa,
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* visible);
+
+    /// <summary>
+    /// visible[i] = 1 when the axis aligned box (center c_i, half-extents e_i) is not fully
+    /// behind one of the 6 frustum planes, otherwise 0. Returns the number visible.
+    /// </summary>
+    static std::size_t BoxesInFrustum(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs,
+        const float* extentsX, const float* extentsY, const float* extentsZ,
+        std::size_t count, std::uint8_t* visible);
+
+    /// Same test with a given kernel, falls back to the best supported one.
+    static std::size_t BoxesInFrustum(
+        Isa isa,
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs,
+        const float* extentsX, const float* extentsY, const float* extentsZ,
+        std::size_t count, std::uint8_t* visible);
+
+    /// Best kernel supported by both this build and the CPU.
+    static Isa DetectIsa();
+    /// Kernel used by TestSpheres, DetectIsa() unless overridden.
+    static Isa GetIsa();
+    /// Force a kernel (benchmarks, debugging), clamped to the supported ones.
+    static void SetIsa(Isa isa);
+    static bool IsSupported(Isa isa);
+    static const char* GetIsaName(Isa isa);
+
+    /// Kernels, one per instruction set (SphereKernels_sse4.cpp, SphereKernels_avx2.cpp)
+    static std::size_t TestSpheresScalar(
+        const glm::vec3& center, float radius,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* hits);
+    static std::size_t TestSpheresSse4(
+        const glm::vec3& center, float radius,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* hits);
+    static std::size_t TestSpheresAvx2(
+        const glm::vec3& center, float radius,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* hits);
+
+    static std::size_t SpheresInFrustumScalar(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* visible);
+    static std::size_t SpheresInFrustumSse4(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* visible);
+    static std::size_t SpheresInFrustumAvx2(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        std::size_t count, std::uint8_t* visible);
+    static std::size_t BoxesInFrustumScalar(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs,
+        const float* extentsX, const float* extentsY, const float* extentsZ,
+        std::size_t count, std::uint8_t* visible);
+    static std::size_t BoxesInFrustumSse4(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs,
+        const float* extentsX, const float* extentsY, const float* extentsZ,
+        std::size_t count, std::uint8_t* visible);
+    static std::size_t BoxesInFrustumAvx2(
+        const glm::vec4 planes[6],
+        const float* xs, const float* ys, const float* zs,
+        const float* extentsX, const float* extentsY, const float* extentsZ,
+        std::size_t count, std::uint8_t* visible);
+
+    /// The SIMD kernels are only compiled on x86 targets
+    static bool HasSse4Kernel();
+    static bool HasAvx2Kernel();
+};
+
+#endif // SPHERE_KERNELS_H
@@ -0,0 +1,197 @@
+/// AVX2 sphere kernel, this file is compiled with AVX2 enabled (see CMakeLists.txt).
+/// It is only called after SphereKernels::DetectIsa() found AVX2 on the CPU.
+
+#include "SphereKernels.h"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#   define SPHERE_KERNELS_AVX2 1
+#   include <immintrin.h>
+#endif
+
+
+bool SphereKernels::HasAvx2Kernel()
+{
+#if defined(SPHERE_KERNELS_AVX2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/// <summary>
+/// 8 positions per iteration: squared distances, compare, pack the lane masks to bytes.
+/// </summary>
+std::size_t SphereKernels::TestSpheresAvx2(
+    const glm::vec3& center, float radius,
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* hits)
+{
+#if defined(SPHERE_KERNELS_AVX2)
+    const __m256 cx = _mm256_set1_ps(center.x);
+    const __m256 cy = _mm256_set1_ps(center.y);
+    const __m256 cz = _mm256_set1_ps(center.z);
+    const __m256 r = _mm256_set1_ps(radius);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    // Per lane hit counters, the compare masks are -1 on hits
+    __m256i laneHits = _mm256_setzero_si256();
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), cx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), cy);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(zs + i), cz);
+        __m256 distanceSqr = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                           _mm256_mul_ps(dz, dz));
+
+        __m256 reach = radii ? _mm256_add_ps(r, _mm256_loadu_ps(radii + i)) : r;
+        __m256 mask = _mm256_cmp_ps(distanceSqr, _mm256_mul_ps(reach, reach), _CMP_LT_OQ);
+
+        // 0/1 per lane, the two 128 bit halves packed 32 -> 16 -> 8 bits
+        __m256i lanes = _mm256_and_si256(_mm256_castps_si256(mask), one);
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+        __m128i bytes = _mm_packus_epi16(words, words);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(hits + i), bytes);
+        laneHits = _mm256_sub_epi32(laneHits, _mm256_castps_si256(mask));
+    }
+
+    std::uint32_t counters[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(counters), laneHits);
+    std::size_t numHits = 0;
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        numHits += counters[lane];
+    }
+
+    // Remaining positions
+    return numHits + TestSpheresScalar(center, radius, xs + i, ys + i, zs + i,
+                                       radii ? radii + i : nullptr, count - i, hits + i);
+#else
+    return TestSpheresScalar(center, radius, xs, ys, zs, radii, count, hits);
+#endif
+}
+
+
+namespace
+{
+#if defined(SPHERE_KERNELS_AVX2)
+    /// 0/1 bytes of the 8 lanes of a mask, the two 128 bit halves packed 32 -> 16 -> 8 bits
+    void StoreMask(__m256 mask, std::uint8_t* out)
+    {
+        __m256i lanes = _mm256_and_si256(_mm256_castps_si256(mask), _mm256_set1_epi32(1));
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+        __m128i bytes = _mm_packus_epi16(words, words);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bytes);
+    }
+
+    /// Sum of the per lane counters
+    std::size_t SumLanes(__m256i laneCounters)
+    {
+        std::uint32_t counters[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(counters), laneCounters);
+        std::size_t sum = 0;
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            sum += counters[lane];
+        }
+        return sum;
+    }
+#endif
+}
+
+
+/// <summary>
+/// 8 spheres per iteration: signed distances to the 6 planes, the lanes outside of one
+/// plane are cleared from the mask, then packed to bytes.
+/// </summary>
+std::size_t SphereKernels::SpheresInFrustumAvx2(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* visible)
+{
+#if defined(SPHERE_KERNELS_AVX2)
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    __m256i laneVisible = _mm256_setzero_si256();
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 z = _mm256_loadu_ps(zs + i);
+        __m256 negRadius = radii ? _mm256_xor_ps(_mm256_loadu_ps(radii + i), signBit) : _mm256_setzero_ps();
+
+        __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const glm::vec4& p = planes[plane];
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x), x), _mm256_mul_ps(_mm256_set1_ps(p.y), y)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.z), z), _mm256_set1_ps(p.w)));
+            mask = _mm256_and_ps(mask, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+
+        StoreMask(mask, visible + i);
+        laneVisible = _mm256_sub_epi32(laneVisible, _mm256_castps_si256(mask));
+    }
+
+    // Remaining spheres
+    return SumLanes(laneVisible) + SpheresInFrustumScalar(planes, xs + i, ys + i, zs + i,
+                                                          radii ? radii + i : nullptr, count - i, visible + i);
+#else
+    return SpheresInFrustumScalar(planes, xs, ys, zs, radii, count, visible);
+#endif
+}
+
+
+/// <summary>
+/// 8 boxes per iteration, same as the spheres with the reach of the box towards each plane.
+/// </summary>
+std::size_t SphereKernels::BoxesInFrustumAvx2(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs,
+    const float* extentsX, const float* extentsY, const float* extentsZ,
+    std::size_t count, std::uint8_t* visible)
+{
+#if defined(SPHERE_KERNELS_AVX2)
+    __m256i laneVisible = _mm256_setzero_si256();
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 z = _mm256_loadu_ps(zs + i);
+        __m256 ex = _mm256_loadu_ps(extentsX + i);
+        __m256 ey = _mm256_loadu_ps(extentsY + i);
+        __m256 ez = _mm256_loadu_ps(extentsZ + i);
+
+        __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const glm::vec4& p = planes[plane];
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x), x), _mm256_mul_ps(_mm256_set1_ps(p.y), y)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.z), z), _mm256_set1_ps(p.w)));
+            __m256 reach = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::fabs(p.x)), ex),
+                              _mm256_mul_ps(_mm256_set1_ps(std::fabs(p.y)), ey)),
+                _mm256_mul_ps(_mm256_set1_ps(std::fabs(p.z)), ez));
+            mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(distance, reach), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        StoreMask(mask, visible + i);
+        laneVisible = _mm256_sub_epi32(laneVisible, _mm256_castps_si256(mask));
+    }
+
+    // Remaining boxes
+    return SumLanes(laneVisible) + BoxesInFrustumScalar(planes, xs + i, ys + i, zs + i, extentsX + i, extentsY + i,
+                                                        extentsZ + i, count - i, visible + i);
+#else
+    return BoxesInFrustumScalar(planes, xs, ys, zs, extentsX, extentsY, extentsZ, count, visible);
+#endif
+}
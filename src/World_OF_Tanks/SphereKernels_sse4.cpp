@@ -0,0 +1,178 @@
+/// SSE4.1 sphere kernel, this file is compiled with SSE4.1 enabled (see CMakeLists.txt).
+/// It is only called after SphereKernels::DetectIsa() found SSE4.1 on the CPU.
+
+#include "SphereKernels.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE4_1__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define SPHERE_KERNELS_SSE4 1
+#   include <smmintrin.h>
+#endif
+
+
+bool SphereKernels::HasSse4Kernel()
+{
+#if defined(SPHERE_KERNELS_SSE4)
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/// <summary>
+/// 4 positions per iteration: squared distances, compare, pack the lane masks to bytes.
+/// </summary>
+std::size_t SphereKernels::TestSpheresSse4(
+    const glm::vec3& center, float radius,
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* hits)
+{
+#if defined(SPHERE_KERNELS_SSE4)
+    const __m128 cx = _mm_set1_ps(center.x);
+    const __m128 cy = _mm_set1_ps(center.y);
+    const __m128 cz = _mm_set1_ps(center.z);
+    const __m128 r = _mm_set1_ps(radius);
+    const __m128i one = _mm_set1_epi32(1);
+
+    // Per lane hit counters, the compare masks are -1 on hits
+    __m128i laneHits = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), cx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), cy);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(zs + i), cz);
+        __m128 distanceSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+        __m128 reach = radii ? _mm_add_ps(r, _mm_loadu_ps(radii + i)) : r;
+        __m128 mask = _mm_cmplt_ps(distanceSqr, _mm_mul_ps(reach, reach));
+
+        // 0/1 per lane, packed 32 -> 16 -> 8 bits (packus_epi32 is SSE4.1)
+        __m128i lanes = _mm_and_si128(_mm_castps_si128(mask), one);
+        __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(lanes, lanes), lanes);
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(hits + i, &packed, 4);
+        laneHits = _mm_sub_epi32(laneHits, _mm_castps_si128(mask));
+    }
+
+    std::uint32_t counters[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(counters), laneHits);
+    std::size_t numHits = counters[0] + counters[1] + counters[2] + counters[3];
+
+    // Remaining positions
+    return numHits + TestSpheresScalar(center, radius, xs + i, ys + i, zs + i,
+                                       radii ? radii + i : nullptr, count - i, hits + i);
+#else
+    return TestSpheresScalar(center, radius, xs, ys, zs, radii, count, hits);
+#endif
+}
+
+
+/// <summary>
+/// 4 spheres per iteration: signed distances to the 6 planes, the lanes outside of one
+/// plane are cleared from the mask, then packed to bytes.
+/// </summary>
+std::size_t SphereKernels::SpheresInFrustumSse4(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs, const float* radii,
+    std::size_t count, std::uint8_t* visible)
+{
+#if defined(SPHERE_KERNELS_SSE4)
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128i laneVisible = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 z = _mm_loadu_ps(zs + i);
+        __m128 negRadius = radii ? _mm_xor_ps(_mm_loadu_ps(radii + i), signBit) : _mm_setzero_ps();
+
+        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const glm::vec4& p = planes[plane];
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y)),
+                                         _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), z), _mm_set1_ps(p.w)));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        __m128i lanes = _mm_and_si128(_mm_castps_si128(mask), one);
+        __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(lanes, lanes), lanes);
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(visible + i, &packed, 4);
+        laneVisible = _mm_sub_epi32(laneVisible, _mm_castps_si128(mask));
+    }
+
+    std::uint32_t counters[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(counters), laneVisible);
+    std::size_t numVisible = counters[0] + counters[1] + counters[2] + counters[3];
+
+    // Remaining spheres
+    return numVisible + SpheresInFrustumScalar(planes, xs + i, ys + i, zs + i,
+                                               radii ? radii + i : nullptr, count - i, visible + i);
+#else
+    return SpheresInFrustumScalar(planes, xs, ys, zs, radii, count, visible);
+#endif
+}
+
+
+/// <summary>
+/// 4 boxes per iteration, same as the spheres with the reach of the box towards each plane.
+/// </summary>
+std::size_t SphereKernels::BoxesInFrustumSse4(
+    const glm::vec4 planes[6],
+    const float* xs, const float* ys, const float* zs,
+    const float* extentsX, const float* extentsY, const float* extentsZ,
+    std::size_t count, std::uint8_t* visible)
+{
+#if defined(SPHERE_KERNELS_SSE4)
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i laneVisible = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 z = _mm_loadu_ps(zs + i);
+        __m128 ex = _mm_loadu_ps(extentsX + i);
+        __m128 ey = _mm_loadu_ps(extentsY + i);
+        __m128 ez = _mm_loadu_ps(extentsZ + i);
+
+        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const glm::vec4& p = planes[plane];
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y)),
+                                         _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), z), _mm_set1_ps(p.w)));
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(p.x)), ex),
+                                                 _mm_mul_ps(_mm_set1_ps(std::fabs(p.y)), ey)),
+                                      _mm_mul_ps(_mm_set1_ps(std::fabs(p.z)), ez));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+        }
+
+        __m128i lanes = _mm_and_si128(_mm_castps_si128(mask), one);
+        __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(lanes, lanes), lanes);
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(visible + i, &packed, 4);
+        laneVisible = _mm_sub_epi32(laneVisible, _mm_castps_si128(mask));
+    }
+
+    std::uint32_t counters[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(counters), laneVisible);
+    std::size_t numVisible = counters[0] + counters[1] + counters[2] + counters[3];
+
+    // Remaining boxes
+    return numVisible + BoxesInFrustumScalar(planes, xs + i, ys + i, zs + i, extentsX + i, extentsY + i,
+                                             extentsZ + i, count - i, visible + i);
+#else
+    return BoxesInFrustumScalar(planes, xs, ys, zs, extentsX, extentsY, extentsZ, count, visible);
+#endif
+}
@@ -0,0 +1,185 @@
+#include "TankSim.h"
+
+#include "core/profiler/cpu_profiler.h"
+
+#include <glm/gtc/constants.hpp>
+
+
+TankSim::TankSim(std::uint64_t seed, unsigned int numThreads)
+    : jobs(numThreads), gameInit(this), tankGrid(4.0f, 1.5f), numBuildings(0), seed(seed),
+    stopEnemyMovement(false), stopGameRender(false), playerDestroyed(false)
+{
+    BuildStepGraph();
+}
+
+
+/// <summary>
+/// Populate the arena: buildings first, then enemy tanks placed around them.
+/// </summary>
+void TankSim::Init()
+{
+    gameInit.InitializeBuildings();
+    // Buildings never move, index them once before the tanks are placed
+    BuildBuildingIndex();
+    gameInit.InitializeEnemyTanks();
+    // Nothing to interpolate from before the first tick
+    SavePreviousState();
+}
+
+
+/// <summary>
+/// Build the static building grid from the compact building records.
+/// </summary>
+void TankSim::BuildBuildingIndex()
+{
+    std::vector<BuildingRecord> records;
+    records.reserve(buildings.size());
+    for (std::size_t i = 0; i < buildings.size(); ++i)
+    {
+        records.push_back(buildings[i].GetRecord(static_cast<std::uint32_t>(i)));
+    }
+    // Buildings are placed on a grid of minBuildingSpacing, one building per cell at most
+    buildingIndex.Build(records, minBuildingSpacing);
+}
+
+
+/// <summary>
+/// Update the round timers and the game over conditions.
+/// </summary>
+/// <param name="deltaTimeSeconds">Time elapsed since the last tick.</param>
+void TankSim::UpdateGameState(float deltaTimeSeconds)
+{
+    elapsedTime += deltaTimeSeconds;
+    // Check if enemy movement should stop after 1 minute
+    stopEnemyMovement = elapsedTime >= 60.0f;
+    // Check if game rendering should stop after 70 seconds
+    stopGameRender = elapsedTime >= 70.f;
+
+    // Check if 1 minute has passed
+    if (stopEnemyMovement)
+    {
+        projectiles.Clear();
+    }
+    // Check for game over condition if player's health reaches 0
+    if (player.health <= 0 && !stopEnemyMovement)
+    {
+        stopEnemyMovement = true;
+        playerDestroyed = true;
+        projectiles.Clear();
+    }
+}
+
+
+/// <summary>
+/// Describe the passes of a tick and the order they need, built once.
+/// An edge is needed whenever a pass reads what another one writes, or both write the same data:
+///  - the projectiles damage the tanks the enemy AI and the sinking read,
+///  - the enemy AI moves the tanks, the grid is rebuilt from the new positions,
+///  - the tank collisions push the player and the tanks, the building passes follow.
+/// The sinking (sink depth) runs next to the enemy AI (positions, turrets, firing),
+/// the two building passes (enemy tanks, player) run next to each other.
+/// </summary>
+void TankSim::BuildStepGraph()
+{
+    TaskGraph::TaskID gameState = stepGraph.AddTask("GameState", [this]()
+    {
+        UpdateGameState(stepDeltaTime);
+    });
+    // Same grid for the projectile hits and the enemy moves, tanks don't move in between
+    TaskGraph::TaskID gridBeforeMoves = stepGraph.AddTask("TankGridBeforeMoves", [this]()
+    {
+        EnemyTanks::BuildTankGrid(tankGrid, enemies);
+    });
+    TaskGraph::TaskID projectileHits = stepGraph.AddTask("Projectiles", [this]()
+    {
+        Projectiles::UpdateProjectiles(projectiles, player, enemies, tankGrid, buildingIndex, damage,
+                                       stepDeltaTime, jobs);
+    });
+    TaskGraph::TaskID enemyMovement = stepGraph.AddTask("EnemyMovement", [this]()
+    {
+        EnemyTanks::UpdateEnemyMovement(enemies, player, stopEnemyMovement, arenaBound, stepDeltaTime, seed, tick, attackRange,
+                                        fireRate, fireAlignmentThreshold, turretRotationSpeed, targetRotation,
+                                        projectiles, buildingIndex, tankGrid, jobs);
+    });
+    TaskGraph::TaskID sinking = stepGraph.AddTask("SinkingTanks", [this]()
+    {
+        EnemyTanks::UpdateSinkingTanks(enemies, stepDeltaTime, jobs);
+    });
+    // Tanks moved, bucket them again before resolving the overlaps
+    TaskGraph::TaskID gridAfterMoves = stepGraph.AddTask("TankGridAfterMoves", [this]()
+    {
+        EnemyTanks::BuildTankGrid(tankGrid, enemies);
+    });
+    TaskGraph::TaskID tankCollisions = stepGraph.AddTask("TankCollisions", [this]()
+    {
+        EnemyTanks::UpdateTankCollisions(enemies, player, tankGrid, jobs);
+    });
+    TaskGraph::TaskID tankBuildingCollisions = stepGraph.AddTask("TankBuildingCollisions", [this]()
+    {
+        EnemyTanks::UpdateTankCollisionsWithBuildings(enemies, buildingIndex, jobs);
+    });
+    TaskGraph::TaskID playerBuildingCollisions = stepGraph.AddTask("PlayerBuildingCollisions", [this]()
+    {
+        Buildings::UpdateTankBuildingCollision(buildingIndex, player);
+    });
+
+    stepGraph.AddDependency(gameState, projectileHits);
+    stepGraph.AddDependency(gridBeforeMoves, projectileHits);
+    stepGraph.AddDependency(projectileHits, enemyMovement);
+    stepGraph.AddDependency(projectileHits, sinking);
+    stepGraph.AddDependency(enemyMovement, gridAfterMoves);
+    stepGraph.AddDependency(gridAfterMoves, tankCollisions);
+    stepGraph.AddDependency(tankCollisions, tankBuildingCollisions);
+    stepGraph.AddDependency(tankCollisions, playerBuildingCollisions);
+}
+
+
+/// <summary>
+/// Copy the state that moves during a tick, rendering interpolates from it.
+/// </summary>
+void TankSim::SavePreviousState()
+{
+    previousState.playerPosition = player.position;
+    previousState.playerTrajectoryAngle = player.trajectoryAngle;
+    previousState.playerTurretRotation = player.turretRotation;
+
+    previousState.enemyPositionX = enemies.positionX;
+    previousState.enemyPositionZ = enemies.positionZ;
+    previousState.enemyRotation = enemies.rotation;
+    previousState.enemyTurretRotation = enemies.turretRotation;
+    previousState.enemySinkDepth = enemies.sinkDepth;
+}
+
+
+/// <summary>
+/// Move the player's tank with the current controls, at a speed independent from the frame rate.
+/// The tank only drives while the round is running, the turret always turns.
+/// </summary>
+/// <param name="deltaTimeSeconds">Duration of the tick.</param>
+void TankSim::ApplyPlayerInput(float deltaTimeSeconds)
+{
+    if (!stopEnemyMovement)
+    {
+        float angle = player.trajectoryAngle + glm::pi<float>();
+        player.position += glm::vec3(cos(angle), 0.0f, -sin(angle)) * (playerInput.move * playerSpeed * deltaTimeSeconds);
+        player.trajectoryAngle += playerInput.turn * deltaTimeSeconds;
+    }
+    player.turretRotation += playerInput.turretTurn * deltaTimeSeconds;
+}
+
+
+/// <summary>
+/// Advance the simulation by one tick, running all the gameplay passes.
+/// </summary>
+/// <param name="deltaTimeSeconds">Time elapsed since the last tick.</param>
+void TankSim::Step(float deltaTimeSeconds)
+{
+    PROFILE_ZONE("TankSim::Step");
+
+    SavePreviousState();
+    ApplyPlayerInput(deltaTimeSeconds);
+
+    stepDeltaTime = deltaTimeSeconds;
+    stepGraph.Run(jobs);
+    tick++;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#ifndef TANK_SIM_H
+#define TANK_SIM_H
+
+#include "GameInit.h"
+#include "GameConstants.h"
+
+#include "Buildings.h"
+#include "Projectiles.h"
+#include "EnemyTanks.h"
+#include "EnemyTankPool.h"
+#include "ProjectilePool.h"
+#include "SpatialGrid.h"
+#include "BuildingIndex.h"
+
+#include "core/jobs/job_system.h"
+#include "core/jobs/task_graph.h"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+
+/// <summary>
+/// Player controls, sampled once per frame and applied at every tick.
+/// </summary>
+struct PlayerInput
+{
+    float move = 0.0f;          // 1 forward, -1 backward
+    float turn = 0.0f;          // 1 left, -1 right
+    float turretTurn = 0.0f;    // 1 left, -1 right
+};
+
+
+/// <summary>
+/// Moving state of the previous tick, rendering interpolates from it to the current state.
+/// Enemy tanks are never removed, their arrays follow the pool indices.
+/// </summary>
+struct TankSimPreviousState
+{
+    glm::vec3 playerPosition = glm::vec3(0.0f);
+    float playerTrajectoryAngle = 0.0f;
+    float playerTurretRotation = 0.0f;
+
+    std::vector<float> enemyPositionX;
+    std::vector<float> enemyPositionZ;
+    std::vector<float> enemyRotation;
+    std::vector<float> enemyTurretRotation;
+    std::vector<float> enemySinkDepth;
+};
+
+
+/// <summary>
+/// HEADLESS GAMEPLAY SIMULATION: BUILDINGS, ENEMIES, PROJECTILES AND THE PLAYER.
+/// Owns the whole game state and advances it with Step(dt), it does not touch
+/// OpenGL or GLFW so it can run (and be profiled) without a window.
+/// The passes of a tick form a task graph run on a work-stealing job system,
+/// passes without conflicting writes run at the same time.
+/// </summary>
+class TankSim
+{
+public:
+    /// The seed keys every random number of the simulation, the same seed replays the same game.
+    /// numThreads counts the calling thread, 0 uses every hardware thread.
+    explicit TankSim(std::uint64_t seed = 0, unsigned int numThreads = 0);
+
+    /// Place the buildings and the enemy tanks in the arena.
+    void Init();
+    /// Index the buildings added so far, done by Init() (tools that place buildings themselves).
+    void BuildBuildingIndex();
+
+    /// Advance the gameplay by one tick: timers, projectiles, enemies and collisions.
+    void Step(float deltaTimeSeconds);
+
+    /// Player controls used by the next ticks.
+    void SetPlayerInput(const PlayerInput& input) { playerInput = input; }
+
+    /// Spawn a projectile in the world (fired by the player).
+    void AddProjectile(const Projectile& projectile) { projectiles.Add(projectile); }
+
+    void AddBuilding(const Building& building) { buildings.push_back(building); }
+    void AddEnemy(const EnemyTank& enemy) { enemies.Add(enemy); }
+
+    int GetNumBuildings() const { return numBuildings; }
+    void SetNumBuildings(int newNumBuildings) { numBuildings = newNumBuildings; }
+
+    /// Half side of the square arena the enemy tanks are clamped in (default arenaHalfSize).
+    float GetArenaBound() const { return arenaBound; }
+    void SetArenaBound(float newArenaBound) { arenaBound = newArenaBound; }
+
+    JobSystem& GetJobs() { return jobs; }
+    PlayerTank& GetPlayer() { return player; }
+    const PlayerTank& GetPlayer() const { return player; }
+    const std::vector<Building>& GetBuildings() const { return buildings; }
+    const BuildingIndex& GetBuildingIndex() const { return buildingIndex; }
+    const EnemyTankPool& GetEnemies() const { return enemies; }
+    const ProjectilePool& GetProjectiles() const { return projectiles; }
+    /// State before the last Step(), for render interpolation.
+    const TankSimPreviousState& GetPreviousState() const { return previousState; }
+
+    std::uint64_t GetSeed() const { return seed; }
+    // Number of ticks done, keys the random draws of the next tick
+    std::uint64_t GetTick() const { return tick; }
+    float GetElapsedTime() const { return elapsedTime; }
+    // Enemies froze, the round is over (time limit or player destroyed)
+    bool IsEnemyMovementStopped() const { return stopEnemyMovement; }
+    // The round ended long enough ago that the game should close
+    bool IsFinished() const { return stopGameRender; }
+    // Player's health reached 0 before the time limit
+    bool IsPlayerDestroyed() const { return playerDestroyed; }
+
+private:
+    void BuildStepGraph();
+    void SavePreviousState();
+    void ApplyPlayerInput(float deltaTimeSeconds);
+    void UpdateGameState(float deltaTimeSeconds);
+
+private:
+    JobSystem jobs;          // Worker threads running the passes
+    TaskGraph stepGraph;     // Passes of one tick and their dependencies
+    float stepDeltaTime = 0.0f; // Delta time of the tick being run by the graph
+
+    GameInit gameInit; // Game initialization
+    PlayerTank player; // Player's tank
+    PlayerInput playerInput; // Player's controls
+    TankSimPreviousState previousState; // State before the last tick
+
+    std::vector<Building> buildings;        // buildings in the arena
+    BuildingIndex buildingIndex;            // static grid over the buildings, used by every building query
+    ProjectilePool projectiles;             // live projectiles (structure of arrays)
+    EnemyTankPool enemies;                  // enemy tanks (structure of arrays)
+
+    // Broadphase over the enemy positions, rebuilt before the passes that query it
+    // Cells of 4 units (two tank radii + margin), 1.5 units of slack for tanks that
+    // moved during the pass
+    SpatialGrid tankGrid;
+
+    float targetRotation = 0.f;         // Target rotation for the turret
+    float turretRotationSpeed = 1.0f;   // Turret rotation speed
+
+    int numBuildings; // Number of buildings in the arena
+    float arenaBound = arenaHalfSize; // Half side of the arena the enemy tanks move in
+
+    std::uint64_t seed;          // Seed of the random draws
+    std::uint64_t tick = 0;      // Ticks done since the start
+
+    float elapsedTime = 0.0f;    // Timer to track elapsed time
+    bool stopEnemyMovement;      // Stop enemy movement
+    bool stopGameRender;         // Stop game rendering
+    bool playerDestroyed;        // Player's tank was destroyed
+};
+
+#endif // TANK_SIM_H
@@ -4,8 +4,13 @@
 #include "TankComponent.h"
 #include "Renderer.h"
 
+#include "core/gpu/gl_state.h"
+#include "core/log/log.h"
+#include "core/managers/asset_loader.h"
+#include "core/profiler/cpu_profiler.h"
+#include "utils/random_utils.h"
+
 #include <utility>
-#include <random>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -14,17 +19,16 @@
 using namespace std;
 
 
-World_OF_Tanks::World_OF_Tanks()
+World_OF_Tanks::World_OF_Tanks(std::uint64_t seed)
     : tankComponent(TankComponent::TankComponent(
         [this](const char* name,
             const std::vector<VertexFormat>& vertices,
             const std::vector<unsigned int>& indices) -> Mesh* {
                 return renderer->CreateMesh(name, vertices, indices);
         })),
-    numBuildings(0), gameInit(this),
     polygonMode(GL_FILL), resolution(800, 600), modelMatrix(glm::mat4(1.0f)),
     cannonMatrix(glm::mat4(1.0f)), projectileMatrix(glm::mat4(1.0f)), projectionMatrix(glm::mat4(1.0f)),
-    stopEnemyMovement(false), stopGameRender(false)
+    sim(seed), timestep(simulationTickRate, maxTicksPerFrame), useBakedGround(true)
 {
     // Initialize the renderer with camera, meshes, and shaders
     renderer = new Renderer(&camera, meshes, shaders);
@@ -69,27 +73,23 @@ void World_OF_Tanks::FrameEnd()
 /// </summary>
 void World_OF_Tanks::Init()
 {
-    srand(static_cast<unsigned int>(time(NULL)));
+    // The files are read on the simulation workers, the GL objects are created at the end
+    AssetLoader loader(sim.GetJobs());
 
     /// MESHES LOADING
     {
         Mesh* mesh = new Mesh("sphere");
-        mesh->LoadMesh(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "sphere.obj");
+        loader.LoadMesh(mesh, PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "sphere.obj");
         meshes[mesh->GetMeshID()] = mesh;
     }
     {
         Mesh* mesh = new Mesh("box");
-        mesh->LoadMesh(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "box.obj");
-        meshes[mesh->GetMeshID()] = mesh;
-    }
-    {
-        Mesh* mesh = new Mesh("sphere");
-        mesh->LoadMesh(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "sphere.obj");
+        loader.LoadMesh(mesh, PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "box.obj");
         meshes[mesh->GetMeshID()] = mesh;
     }
     {
         Mesh* mesh = new Mesh("plane");
-        mesh->LoadMesh(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "plane50.obj");
+        loader.LoadMesh(mesh, PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "plane50.obj");
         meshes[mesh->GetMeshID()] = mesh;
     }
     /// MESHES LOADING
@@ -101,16 +101,26 @@ void World_OF_Tanks::Init()
                                          "World_OF_Tanks", "shaders", "VertexShaderPlane.glsl"), GL_VERTEX_SHADER);
         planeShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
                                          "World_OF_Tanks", "shaders", "FragmentShaderPlane.glsl"), GL_FRAGMENT_SHADER);
-        planeShader->CreateAndLink();
+        loader.LoadShader(planeShader);
         shaders[planeShader->GetName()] = planeShader;
     }
+    {
+        // Same fragment shader as the plane, drawn over the whole ground texture
+        Shader* bakeShader = new Shader("GroundBake");
+        bakeShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
+                                        "World_OF_Tanks", "shaders", "VertexShaderGroundBake.glsl"), GL_VERTEX_SHADER);
+        bakeShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
+                                        "World_OF_Tanks", "shaders", "FragmentShaderPlane.glsl"), GL_FRAGMENT_SHADER);
+        loader.LoadShader(bakeShader);
+        shaders[bakeShader->GetName()] = bakeShader;
+    }
     {
         Shader* buildingShader = new Shader("Building");
         buildingShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
                                             "World_OF_Tanks", "shaders", "VertexShaderBuilding.glsl"), GL_VERTEX_SHADER);
         buildingShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
                                             "World_OF_Tanks", "shaders", "FragmentShaderBuilding.glsl"), GL_FRAGMENT_SHADER);
-        buildingShader->CreateAndLink();
+        loader.LoadShader(buildingShader);
         shaders[buildingShader->GetName()] = buildingShader;
     }
     {
@@ -119,7 +129,7 @@ void World_OF_Tanks::Init()
                                         "World_OF_Tanks", "shaders", "VertexShaderEnemy.glsl"), GL_VERTEX_SHADER);
         tankShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
                                         "World_OF_Tanks", "shaders", "FragmentShaderEnemy.glsl"), GL_FRAGMENT_SHADER);
-        tankShader->CreateAndLink();
+        loader.LoadShader(tankShader);
         shaders[tankShader->GetName()] = tankShader;
     }
     {
@@ -128,143 +138,297 @@ void World_OF_Tanks::Init()
             "World_OF_Tanks", "shaders", "VertexShaderPlayer.glsl"), GL_VERTEX_SHADER);
         tankShader->AddShader(PATH_JOIN(window->props.selfDir, SOURCE_PATH::PATH_PROJECT,
             "World_OF_Tanks", "shaders", "FragmentShaderPlayer.glsl"), GL_FRAGMENT_SHADER);
-        tankShader->CreateAndLink();
+        loader.LoadShader(tankShader);
         shaders[tankShader->GetName()] = tankShader;
     }
     /// SHADERS LOADING
 
+    loader.Finish();
+
     // Sets the resolution of the small viewport
     resolution = window->GetResolution();
 
-    gameInit.InitializeBuildings();
-    gameInit.InitializeEnemyTanks();
+    // The enemy tanks draw every part of all the tanks at once
+    renderer->InitEnemyTankInstancing({ meshes["tankBody"], meshes["tankTurret"], meshes["tankCannon"],
+                                        meshes["tankWheel1"], meshes["tankWheel2"] });
+
+    sim.Init();
+    CreateBuildingInstances();
+    BakeGroundTexture();
+}
+
+
+/// <summary>
+/// Render the time-invariant layers of the ground shader (the noise frozen at time 0 and
+/// the craters) once into a mip-mapped texture. The plane then samples it every frame
+/// instead of evaluating the 18 noise layers per pixel, only a cheap wave stays animated.
+/// </summary>
+void World_OF_Tanks::BakeGroundTexture()
+{
+    Shader* shader = shaders["GroundBake"];
+
+    // One 8 bit RGBA target, no depth
+    groundBake.Generate(groundTextureSize, groundTextureSize, 1, false, 8);
+    groundBake.Bind(true);
+
+    GLState::UseProgram(shader->program);
+    shader->SetUniform("GroundPass", static_cast<int>(GROUND_PASS_BAKE));
+
+    // The full-target triangle comes from gl_VertexID, an empty VAO is enough
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    GLState::BindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLState::BindVertexArray(0);
+    glDeleteVertexArrays(1, &vao);
+    GLState::Invalidate();
+
+    FrameBuffer::BindDefault(window->GetResolution());
+
+    // The wave shifts the lookups past the borders, mirror instead of repeating the seams
+    Texture2D* texture = groundBake.GetTexture(0);
+    texture->SetWrappingMode(GL_MIRRORED_REPEAT);
+    texture->GenerateMipmaps();
+
+    CheckOpenGLError();
+}
+
+
+/// <summary>
+/// Create the unit cube shared by the buildings, one instance and one bounding box per simulated building.
+/// </summary>
+void World_OF_Tanks::CreateBuildingInstances()
+{
+    // Create indices for the cube
+    const std::vector<unsigned int> indices =
+    {
+        0, 1, 2,  1, 3, 2,
+        2, 3, 7,  2, 7, 6,
+        1, 7, 3,  1, 5, 7,
+        6, 7, 4,  7, 5, 4,
+        0, 4, 1,  1, 4, 5,
+        2, 6, 4,  0, 2, 4,
+    };
+
+    // Create vertices for the unit cube, the instances place and scale it
+    const std::vector<VertexFormat> vertices
+    {
+        VertexFormat(glm::vec3(-1, -1,  1)),
+        VertexFormat(glm::vec3(1, -1,  1)),
+        VertexFormat(glm::vec3(-1,  1,  1)),
+        VertexFormat(glm::vec3(1,  1,  1)),
+        VertexFormat(glm::vec3(-1, -1, -1)),
+        VertexFormat(glm::vec3(1, -1, -1)),
+        VertexFormat(glm::vec3(-1,  1, -1)),
+        VertexFormat(glm::vec3(1,  1, -1)),
+    };
+    Mesh* cube = renderer->CreateMesh("buildingCube", vertices, indices);
+
+    const std::vector<Building>& buildings = sim.GetBuildings();
+    buildingInstances.resize(buildings.size());
+    buildingBounds.Clear();
+    for (std::size_t i = 0; i < buildings.size(); ++i)
+    {
+        // Random color, from the seed so the same game gets the same colors
+        random_utils::Sequence random(sim.GetSeed(), RANDOM_STREAM_BUILDING_COLORS, i);
+
+        buildingInstances[i].position = buildings[i].position;
+        buildingInstances[i].scale = buildings[i].scale;
+        buildingInstances[i].color = glm::vec3(random.NextFloat(0.0f, 1.0f), random.NextFloat(0.0f, 1.0f),
+                                               random.NextFloat(0.0f, 1.0f));
+
+        // The cube spans -1 to 1, the scale is the half-extents of the box
+        buildingBounds.Add(buildings[i].position, buildings[i].scale);
+    }
+
+    // The buildings in the view frustum are uploaded every frame
+    renderer->InitBuildingInstancing(cube);
 }
 
 
 /// <summary>
 /// RENDER ALL THE SCNEE OBJECTS PLAYER, ENEMIES, BUILDINGS AND PLANE
+/// The draws are submitted to the render queue of the renderer, it picks the draw order.
+/// The enemy tanks, the projectiles and the buildings outside of the view frustum are culled
+/// before they are submitted (or uploaded), the counters of the frame are in cullStats.
 /// </summary>
 /// <param name="viewMatrix">View matrix</param>
 /// <param name="projectionMatrix">Projection matrix</param>
+/// <param name="alpha">Position between the previous tick (0) and the last one (1)</param>
 void World_OF_Tanks::RenderScene(
     const glm::mat4& viewMatrix,
-    const glm::mat4& projectionMatrix)
+    const glm::mat4& projectionMatrix,
+    float alpha)
 {
+    PlayerTank& player = sim.GetPlayer();
+    // State of the previous tick, everything that moves is drawn in between
+    const TankSimPreviousState& previous = sim.GetPreviousState();
+
+    // Frustum of the camera of the frame
+    frustum.SetViewProjection(renderer->GetViewProjection());
+
     /// TANK PLAYER
+    renderer->SetScope("Player");
     {
         Shader* shader = shaders["TankPlayer"];
-        shader->Use();
-
-        glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera.GetTargetPosition()));
-        glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
 
         // Render tank body
+        glm::vec3 position = glm::mix(previous.playerPosition, player.position, alpha);
+        float trajectoryAngle = lerp(previous.playerTrajectoryAngle, player.trajectoryAngle, alpha);
+        float turretRotation = lerp(previous.playerTurretRotation, player.turretRotation, alpha);
+
         glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = Transforms3D::Translate(player.position.x, player.position.y, player.position.z);
-        modelMatrix = modelMatrix * Transforms3D::RotateOY(player.trajectoryAngle);
+        modelMatrix = Transforms3D::Translate(position.x, position.y, position.z);
+        modelMatrix = modelMatrix * Transforms3D::RotateOY(trajectoryAngle);
 
         player.cannonAngle = player.trajectoryAngle;
-        renderer->RenderPlayerTank(meshes["tankBody"], shader, modelMatrix, player, bodyColor);
+        renderer->SubmitPlayerTank(meshes["tankBody"], shader, modelMatrix, player, bodyColor);
 
         // Turret positioned on the body
         turretMatrix = modelMatrix * Transforms3D::Translate(0.0f, 0.1f, 0.0f);
-        turretMatrix = turretMatrix * Transforms3D::RotateOY(player.turretRotation);
-        renderer->RenderPlayerTank(meshes["tankTurret"], shader, turretMatrix, player, turretColor);
+        turretMatrix = turretMatrix * Transforms3D::RotateOY(turretRotation);
+        renderer->SubmitPlayerTank(meshes["tankTurret"], shader, turretMatrix, player, turretColor);
 
         // Cannon positioned at the front of the turret
         cannonMatrix = turretMatrix * Transforms3D::Translate(0.5, cannonHeight / 2 + 0.2, 0);
         cannonMatrix = cannonMatrix * Transforms3D::RotateOZ(M_PI / 2);
-        renderer->RenderPlayerTank(meshes["tankCannon"], shader, cannonMatrix, player, cannonColor);
+        renderer->SubmitPlayerTank(meshes["tankCannon"], shader, cannonMatrix, player, cannonColor);
 
         glm::mat4 wheelMatrixLeft = modelMatrix * Transforms3D::Translate(0, liftHeight, -wheelOffsetFromCenter);
-        renderer->RenderPlayerTank(meshes["tankWheel1"], shader, wheelMatrixLeft, player, wheelColor);
+        renderer->SubmitPlayerTank(meshes["tankWheel1"], shader, wheelMatrixLeft, player, wheelColor);
 
         // Right side wheels
         glm::mat4 wheelMatrixRight = modelMatrix * Transforms3D::Translate(0, liftHeight, wheelOffsetFromCenter);
-        renderer->RenderPlayerTank(meshes["tankWheel2"], shader, wheelMatrixRight, player, wheelColor);
+        renderer->SubmitPlayerTank(meshes["tankWheel2"], shader, wheelMatrixRight, player, wheelColor);
     }
     /// TANK PLAYER
 
-    float wheelWidth = 1.2f;
+    /// ENEMY TANKS
+    // One instance per tank, then one instanced draw call per tank part
+    renderer->SetScope("Enemies");
     float largerBaseWidth = wheelWidth_ENEMY * 1.2f;
     float wheelOutwardOffset = largerBaseWidth / 2;
 
-    for (auto& enemy : enemies)
+    const EnemyTankPool& enemies = sim.GetEnemies();
+
+    // Bounding spheres of the renderable tanks, between the last two ticks
+    tankBounds.Clear();
+    for (std::size_t i = 0; i < enemies.Size(); ++i)
+    {
+        if (!enemies.isRenderable[i]) continue;
+
+        glm::vec3 position(lerp(previous.enemyPositionX[i], enemies.positionX[i], alpha), enemies.positionY[i],
+                           lerp(previous.enemyPositionZ[i], enemies.positionZ[i], alpha));
+        tankBounds.Add(position, tankCullRadius);
+    }
+    cullStats.tanks.visible = frustum.Cull(tankBounds);
+    cullStats.tanks.culled = tankBounds.Size() - cullStats.tanks.visible;
+
+    enemyInstances.clear();
+    std::size_t bound = 0;  // Sphere of the tank in tankBounds
+    for (std::size_t i = 0; i < enemies.Size(); ++i)
     {
-        if (!enemy.isRenderable) continue;
+        if (!enemies.isRenderable[i]) continue;
+
+        const std::size_t b = bound++;
+        if (!tankBounds.visible[b]) continue;
 
-        glm::mat4 tankModelMatrix = viewMatrix;
-        tankModelMatrix = glm::translate(tankModelMatrix, enemy.position);
+        glm::vec3 position(tankBounds.x[b], tankBounds.y[b], tankBounds.z[b]);
+        float rotation = lerp(previous.enemyRotation[i], enemies.rotation[i], alpha);
+        float turretRotation = lerpAngle(previous.enemyTurretRotation[i], enemies.turretRotation[i], alpha);
+        float sinkDepth = lerp(previous.enemySinkDepth[i], enemies.sinkDepth[i], alpha);
 
+        EnemyTankInstance instance;
+        instance.model = glm::translate(viewMatrix, position);
+        instance.model = glm::rotate(instance.model, rotation, glm::vec3(0, 1, 0));
+        // Turret positioned on the body
+        instance.turretModel = instance.model * Transforms3D::Translate(0.0f, 0.1f, 0.0f) * Transforms3D::RotateOY(turretRotation - rotation);
+        instance.health = static_cast<float>(enemies.health[i]);
         // Sinking effect if the tank is destroyed
-        if (enemy.isDestroyed) tankModelMatrix = glm::translate(tankModelMatrix, glm::vec3(0, -enemy.sinkDepth, 0));
+        instance.sinkDepth = enemies.isDestroyed[i] ? sinkDepth : 0.0f;
 
-        tankModelMatrix = glm::rotate(tankModelMatrix, enemy.rotation, glm::vec3(0, 1, 0));
+        enemyInstances.push_back(instance);
+    }
+    renderer->UploadEnemyTankInstances(enemyInstances);
 
+    {
         Shader* shader = shaders["TankEnemy"];
-        shader->Use();
-        glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-        glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
 
         // Render tank body
-        renderer->RenderEnemyTank(meshes["tankBody"], shader, tankModelMatrix, enemy, enemyBodyColor);
+        renderer->SubmitEnemyTankPart(meshes["tankBody"], shader, glm::mat4(1.0f), false, enemyBodyColor);
 
-        // Render turret (positioned on the body)
-        glm::mat4 turretMatrix = tankModelMatrix * Transforms3D::Translate(0.0f, 0.1f, 0.0f) * Transforms3D::RotateOY(enemy.turretRotation - enemy.rotation);
-        renderer->RenderEnemyTank(meshes["tankTurret"], shader, turretMatrix, enemy, enemyTurretColor);
+        // Render turret (turret frame)
+        renderer->SubmitEnemyTankPart(meshes["tankTurret"], shader, glm::mat4(1.0f), true, enemyTurretColor);
 
         // Render cannon (positioned at the front of the turret)
-        glm::mat4 cannonMatrix = turretMatrix * Transforms3D::Translate(0.5, cannonHeight / 2 + 0.2, 0);
-        cannonMatrix = cannonMatrix * Transforms3D::RotateOZ(M_PI / 2);
-        renderer->RenderEnemyTank(meshes["tankCannon"], shader, cannonMatrix, enemy, enemyCannonColor);
+        glm::mat4 cannonPart = Transforms3D::Translate(0.5, cannonHeight / 2 + 0.2, 0) * Transforms3D::RotateOZ(M_PI / 2);
+        renderer->SubmitEnemyTankPart(meshes["tankCannon"], shader, cannonPart, true, enemyCannonColor);
 
         // Left side wheels
-        glm::mat4 wheelMatrixLeft = tankModelMatrix * glm::translate(viewMatrix, glm::vec3(0, liftHeight, -wheelOutwardOffset));
-        renderer->RenderEnemyTank(meshes["tankWheel1"], shader, wheelMatrixLeft, enemy, enemyWheelColor);
+        glm::mat4 wheelPartLeft = Transforms3D::Translate(0, liftHeight, -wheelOutwardOffset);
+        renderer->SubmitEnemyTankPart(meshes["tankWheel1"], shader, wheelPartLeft, false, enemyWheelColor);
 
         // Right side wheels
-        glm::mat4 wheelMatrixRight = tankModelMatrix * glm::translate(viewMatrix, glm::vec3(0, liftHeight, wheelOutwardOffset));
-        renderer->RenderEnemyTank(meshes["tankWheel2"], shader, wheelMatrixRight, enemy, enemyWheelColor);
+        glm::mat4 wheelPartRight = Transforms3D::Translate(0, liftHeight, wheelOutwardOffset);
+        renderer->SubmitEnemyTankPart(meshes["tankWheel2"], shader, wheelPartRight, false, enemyWheelColor);
     }
- 
+    /// ENEMY TANKS
+
     /// PROJECTILES
-    for (const auto& projectile : projectiles)
+    // Projectiles fly straight, their previous position is one tick of velocity behind
+    // (the pool indices change on removals, no copy of the previous tick is needed)
+    const float timeBehind = (1.0f - alpha) * timestep.GetTickDuration();
+    const ProjectilePool& projectiles = sim.GetProjectiles();
+    renderer->SetScope("Projectiles");
+    Shader* projectileShader = shaders["VertexColor"];
+    Mesh* projectileMesh = meshes["sphere"];
+
+    projectileBounds.Clear();
+    for (std::size_t i = 0; i < projectiles.Size(); ++i)
     {
-        Shader* shader = shaders["VertexColor"];
-        shader->Use();
-        glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-        glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
+        glm::vec3 velocity(projectiles.velocityX[i], projectiles.velocityY[i], projectiles.velocityZ[i]);
+        projectileBounds.Add(projectiles.GetPosition(i) - velocity * timeBehind, projectiles.radius[i]);
+    }
+    cullStats.projectiles.visible = frustum.Cull(projectileBounds);
+    cullStats.projectiles.culled = projectileBounds.Size() - cullStats.projectiles.visible;
 
+    for (std::size_t i = 0; i < projectileBounds.Size(); ++i)
+    {
+        if (!projectileBounds.visible[i]) continue;
 
-        glm::mat4 modelMatrix = glm::translate(viewMatrix, projectile.position);
-        modelMatrix = modelMatrix * Transforms3D::Scale(projectile.radius, projectile.radius, projectile.radius);
-        renderer->RenderSimpleMesh(meshes["sphere"], shader, modelMatrix);
+        const float radius = projectileBounds.radius[i];
+        glm::vec3 position(projectileBounds.x[i], projectileBounds.y[i], projectileBounds.z[i]);
+        glm::mat4 modelMatrix = glm::translate(viewMatrix, position);
+        modelMatrix = modelMatrix * Transforms3D::Scale(radius, radius, radius);
+        renderer->SubmitSimpleMesh(projectileMesh, projectileShader, modelMatrix);
     }
 
     /// PLANE HORIZONTAL
+    renderer->SetScope("Plane");
     {
-        Shader* shader = shaders["Plane"];
-        shader->Use();
-        glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-        glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
-
+        // Baked ground texture, or the full noise per pixel for comparison
+        int groundPass = useBakedGround ? GROUND_PASS_BAKED : GROUND_PASS_FULL;
+        GLuint groundTexture = useBakedGround ? groundBake.GetTextureID(0) : 0;
 
         glm::mat4 modelMatrix = viewMatrix;
         modelMatrix = glm::translate(modelMatrix, glm::vec3(0, 0, 0));
-        renderer->RenderSimpleMesh(meshes["plane"], shader, modelMatrix);
+        renderer->SubmitGround(meshes["plane"], shaders["Plane"], modelMatrix, groundPass, groundTexture,
+                               groundTextureUnit);
     }
 
     /// BUILDINGS
-    for (int i = 0; i < numBuildings; i++)
-    {
-        Shader* shader = shaders["Building"];
-        shader->Use();
-        glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-        glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
+    // The buildings in the frustum, in one instanced draw call
+    renderer->SetScope("Buildings");
+    cullStats.buildings.visible = frustum.Cull(buildingBounds);
+    cullStats.buildings.culled = buildingBounds.Size() - cullStats.buildings.visible;
 
-        string name = "cube" + to_string(i);
-        renderer->RenderSimpleMesh(meshes[name.c_str()], shader, viewMatrix);
+    visibleBuildings.clear();
+    for (std::size_t i = 0; i < buildingBounds.Size(); ++i)
+    {
+        if (buildingBounds.visible[i]) visibleBuildings.push_back(buildingInstances[i]);
     }
+    renderer->UploadBuildingInstances(visibleBuildings);
+    renderer->SubmitBuildings(meshes["buildingCube"], shaders["Building"]);
 }
 
 
@@ -273,90 +437,74 @@ void World_OF_Tanks::Update(float deltaTimeSeconds)
     glLineWidth(3);
     glPointSize(5);
 
-    elapsedTime += deltaTimeSeconds;
-    // Check if enemy movement should stop after 1 minute
-    stopEnemyMovement = elapsedTime >= 60.0f;
-    // Check if game rendering should stop after 70 seconds
-    stopGameRender = elapsedTime >= 70.f;
+    /// Update game elements and collisions
+    // Fixed ticks, as many as the frame time covers (bounded by the tick budget)
+    bool wasPlayerDestroyed = sim.IsPlayerDestroyed();
+    int ticks = timestep.Advance(deltaTimeSeconds);
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        sim.Step(timestep.GetTickDuration());
+    }
 
-    std::cout << "ELAPSED TIME: " << elapsedTime << std::endl;
+    LOG_DEBUG(Game, "ELAPSED TIME: %g", sim.GetElapsedTime());
     // Check if 1 minute has passed
-    if (stopEnemyMovement)
+    if (sim.IsEnemyMovementStopped() && !sim.IsPlayerDestroyed())
     {
-        projectiles.clear();
-        std::cout << "!GAME ENDED!" << std::endl;
+        LOG_INFO(Game, "!GAME ENDED!");
     }
     // Check for game over condition if player's health reaches 0
-    if (stopGameRender)
+    if (sim.IsPlayerDestroyed() && !wasPlayerDestroyed)
     {
-        std::cout << "!CLOSED GAME!" << std::endl;
-        window->Close();
+        LOG_INFO(Game, "!GAME OVER! PLAYER DESTROYED.");
     }
-    // Check for game over condition
-    if (player.health <= 0 && !stopEnemyMovement)
+    // Check if the game should be closed
+    if (sim.IsFinished())
     {
-        stopEnemyMovement = true;
-        projectiles.clear();
-        std::cout << "!GAME OVER! PLAYER DESTROYED." << std::endl;
+        LOG_INFO(Game, "!CLOSED GAME!");
+        window->Close();
     }
 
     // Initialize view and projection matrices for rendering
     glm::mat4 viewMatrix = glm::mat4(1);
     glm::mat4 projectionMatrix = this->projectionMatrix;
 
-    // Render the main scene using perspective projection
-    RenderScene(viewMatrix, projectionMatrix);
+    // Camera of the frame, every shader reads it from the camera uniform block
+    renderer->BeginFrame();
 
-    /// Update game elements and collisions
-    ///
-    Projectiles::UpdateProjectilesPlayerCollision(projectiles, player, damage);
-    Projectiles::UpdateProjectileMovementsAndCollisions(projectiles, enemies, damage, deltaTimeSeconds);
-    ///
-    EnemyTanks::UpdateEnemyMovement(enemies, player, stopEnemyMovement, deltaTimeSeconds, attackRange,
-                                    fireRate, fireAlignmentThreshold, turretRotationSpeed, targetRotation, projectiles, buildings);
-    EnemyTanks::UpdateSinkingTanks(enemies, deltaTimeSeconds);
-    EnemyTanks::UpdateTankCollisions(enemies, player);
-    EnemyTanks::UpdateTankCollisionsWithBuildings(enemies, buildings);
-    ///
-    Buildings::UpdateTankBuildingCollision(buildings, player);
-    Buildings::UpdateProjectileBuildingCollisiong(buildings, projectiles, deltaTimeSeconds);
+    // Render the main scene using perspective projection, between the last two ticks
+    {
+        PROFILE_ZONE("RenderScene");
+        RenderScene(viewMatrix, projectionMatrix, timestep.GetAlpha());
+    }
+
+    // Draw the submitted scene, sorted by state and depth
+    {
+        PROFILE_ZONE("Renderer::EndFrame");
+        renderer->EndFrame();
+    }
 }
 
 
+/// <summary>
+/// Sample the player controls once per frame, the simulation applies them at every tick.
+/// </summary>
 void World_OF_Tanks::OnInputUpdate(float deltaTime, int mods)
-{   
+{
+    PlayerInput input;
+
     /// Tank PLAYER movement
-    if (!stopEnemyMovement)
-    {
-        // Move the player forward
-        if (window->KeyHold(GLFW_KEY_W)) { 
-            player.position += glm::vec3(
-                cos(player.trajectoryAngle + M_PI) / 20,
-                0,
-                -sin(player.trajectoryAngle + M_PI) / 20);
-        }
-        // Move the player backward
-        if (window->KeyHold(GLFW_KEY_S))
-        {
-            player.position += glm::vec3(
-                -cos(player.trajectoryAngle + M_PI) / 20,
-                0,
-                sin(player.trajectoryAngle + M_PI) / 20);
-        }
-        // Rotate the player's trajectory to the left
-        if (window->KeyHold(GLFW_KEY_A))
-        {
-            player.trajectoryAngle += deltaTime;
-        }
-        // Rotate the player's trajectory to the right
-        if (window->KeyHold(GLFW_KEY_D))
-        {
-            player.trajectoryAngle -= deltaTime;
-        }
-    }
+    // Move the player forward / backward
+    if (window->KeyHold(GLFW_KEY_W)) input.move += 1.0f;
+    if (window->KeyHold(GLFW_KEY_S)) input.move -= 1.0f;
+    // Rotate the player's trajectory to the left / right
+    if (window->KeyHold(GLFW_KEY_A)) input.turn += 1.0f;
+    if (window->KeyHold(GLFW_KEY_D)) input.turn -= 1.0f;
+
     /// Turret PLAYER rotation
-    if (window->KeyHold(GLFW_KEY_Q)) player.turretRotation += deltaTime;
-    if (window->KeyHold(GLFW_KEY_E)) player.turretRotation -= deltaTime;
+    if (window->KeyHold(GLFW_KEY_Q)) input.turretTurn += 1.0f;
+    if (window->KeyHold(GLFW_KEY_E)) input.turretTurn -= 1.0f;
+
+    sim.SetPlayerInput(input);
 }
 
 
@@ -364,12 +512,12 @@ void World_OF_Tanks::OnMouseBtnPress(int mouseX, int mouseY, int button, int mod
 {
     // Check if enemy movement is not stopped and also ensure that
     // enough time has passed since the last shot (2 seconds in this case)
-    if (!stopEnemyMovement)
+    if (!sim.IsEnemyMovementStopped())
     {
         if (button == GLFW_MOUSE_BUTTON_2 && (Engine::GetElapsedTime() - lastShotTime >= 2.0f))
         {
             Projectile newProjectile;
-            float projectileSpeed = 10;
+            float projectileSpeed = 20; // Moved once per tick
             float cannonLength = 1.0f;
 
             // Transformation matrix for the turret and cannon, necessary to render the projectile
@@ -391,15 +539,53 @@ void World_OF_Tanks::OnMouseBtnPress(int mouseX, int mouseY, int button, int mod
             // Update the time of the last shot
             lastShotTime = Engine::GetElapsedTime();
 
-            // Add the new projectile to the list
-            projectiles.push_back(newProjectile);
+            // Add the new projectile to the simulation
+            sim.AddProjectile(newProjectile);
         }
     }
 }
 
 
 void World_OF_Tanks::OnMouseMove(int mouseX, int mouseY, int deltaX, int deltaY) {}
-void World_OF_Tanks::OnKeyPress(int key, int mods) {}
+void World_OF_Tanks::OnKeyPress(int key, int mods)
+{
+    // Switch between the baked ground and the full ground shader
+    if (key == GLFW_KEY_G)
+    {
+        useBakedGround = !useBakedGround;
+        LOG_INFO(Game, "GROUND: %s", useBakedGround ? "BAKED" : "FULL");
+    }
+
+    // Print the GPU time of the render passes every second
+    if (key == GLFW_KEY_T)
+    {
+        GpuProfiler& profiler = renderer->GetGpuProfiler();
+        profiler.SetLogging(!profiler.IsLogging(), gpuTimerLogInterval);
+        LOG_INFO(Gpu, "GPU TIMERS: %s", profiler.IsLogging() ? "ON" : "OFF");
+    }
+
+    // Print the frame time percentiles of the last seconds
+    if (key == GLFW_KEY_F)
+    {
+        const FrameStats& stats = GetFrameStats();
+        FrameTimeSummary frame = stats.GetFrameSummary();
+        LOG_INFO(Profiler, "FRAME TIME: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms, %llu hitches",
+                 frame.p50Ms, frame.p95Ms, frame.p99Ms, frame.maxMs, static_cast<unsigned long long>(frame.hitches));
+        for (std::size_t i = 0; i < static_cast<std::size_t>(FramePhase::Count); ++i)
+        {
+            FramePhase phase = static_cast<FramePhase>(i);
+            FrameTimeSummary summary = stats.GetPhaseSummary(phase);
+            LOG_INFO(Profiler, "  %s: p50 %.3f ms, p99 %.3f ms, max %.3f ms", FrameStats::GetPhaseName(phase),
+                     summary.p50Ms, summary.p99Ms, summary.maxMs);
+        }
+    }
+
+    // Write the CPU zones of the last frames, open the file in chrome://tracing
+    if (key == GLFW_KEY_P)
+    {
+        CpuProfiler::WriteChromeTrace(cpuTraceFile, cpuTraceFrames);
+    }
+}
 void World_OF_Tanks::OnKeyRelease(int key, int mods) {}
 void World_OF_Tanks::OnMouseBtnRelease(int mouseX, int mouseY, int button, int mods) {}
 void World_OF_Tanks::OnMouseScroll(int mouseX, int mouseY, int offsetX, int offsetY) {}
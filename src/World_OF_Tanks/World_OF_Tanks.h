@@ -4,27 +4,24 @@
 #define WORLD_OF_TANKS_H
 
 #include "components/simple_scene.h"
+#include "core/gpu/frame_buffer.h"
 
 #include "Camera3rdPerson.h"
 #include "TankComponent.h"
 
 #include "Renderer.h"
-#include "GameInit.h"
-
-#include "Buildings.h"
-#include "Projectiles.h"
-#include "EnemyTanks.h"
+#include "TankSim.h"
+#include "FixedTimestep.h"
+#include "Frustum.h"
 
 #include <map>
-#include <random>
+#include <cstdint>
 #include <vector>
 #include <functional>
 #include <unordered_map>
 #include <unordered_set>
 
 
-class GameInit;
-
 class World_OF_Tanks : public gfxc::SimpleScene
 {
     const float Z_NEAR = 0.1f;
@@ -43,19 +40,26 @@ public:
                         x(x), y(y), width(width), height(height) {}
     };
         
-    World_OF_Tanks();
+    // The seed keys every random number of the game (arena, enemies, colors)
+    explicit World_OF_Tanks(std::uint64_t seed);
     ~World_OF_Tanks();
     void Init() override;
 
-    void AddBuilding(const Building& building) { buildings.push_back(building); }
-    void AddEnemy(const EnemyTank& enemy) { enemies.push_back(enemy); }
+    const TankSim& GetSim() const { return sim; }
 
-    int GetNumBuildings() const { return numBuildings; }
-    void SetNumBuildings(int newNumBuildings) { numBuildings = newNumBuildings; }
-    const std::vector<Building>& GetBuildings() const { return buildings; }
+    /// Objects kept and dropped by the frustum culling of the last frame
+    struct CullStats
+    {
+        CullCounter tanks;
+        CullCounter buildings;
+        CullCounter projectiles;
+    };
+    const CullStats& GetCullStats() const { return cullStats; }
 
 private:
-    void RenderScene(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+    void CreateBuildingInstances();
+    void BakeGroundTexture();
+    void RenderScene(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, float alpha);
 
     void FrameStart() override;
     void FrameEnd() override;
@@ -79,28 +83,33 @@ protected:
     glm::mat4 projectionMatrix;
     glm::mat4 modelMatrix;
 
-    GameInit gameInit; // Game initialization
-    PlayerTank player; // Player's tank
-
-    std::vector<Building> buildings;        // buildings in the scene
-    std::vector<Projectile> projectiles;    // projectiles
-    std::vector<EnemyTank> enemies;         // enemy tanks
+    TankSim sim; // Gameplay simulation (buildings, enemies, projectiles, player)
+    FixedTimestep timestep; // Fixed simulation ticks, the frames render between the last two
 
     float lastShotTime = 0.0f;  // Time of the last shot
 
+    std::vector<EnemyTankInstance> enemyInstances;      // Enemy tanks drawn this frame (reused)
+    std::vector<BuildingInstance> buildingInstances;    // Every building of the arena
+    std::vector<BuildingInstance> visibleBuildings;     // Buildings drawn this frame (reused)
+
+    /// GROUND
+    FrameBuffer groundBake;     // Time-invariant layers of the ground shader, baked at startup
+    bool useBakedGround;        // Baked ground, otherwise the full shader (G toggles)
+    /// GROUND
+
+    /// FRUSTUM CULLING
+    Frustum frustum;            // View frustum of the frame
+    SphereBatch tankBounds;     // Bounding spheres of the renderable enemy tanks
+    SphereBatch projectileBounds;
+    BoxBatch buildingBounds;    // Boxes of the buildings, built with the arena
+    CullStats cullStats;
+    /// FRUSTUM CULLING
+
     /// PLAYER TANK
     glm::mat4 cannonMatrix;
     glm::mat4 turretMatrix;
     glm::mat4 projectileMatrix;
-    float targetRotation = 0.f;         // Target rotation for the turret
-    float turretRotationSpeed = 1.0f;   // Turret rotation speed
     /// PLAYER TANK
-
-    int numBuildings; // Number of buildings in the scene
-
-    float elapsedTime = 0.0f;    // Timer to track elapsed time
-    bool stopEnemyMovement;      // Stop enemy movement
-    bool stopGameRender;         // Stop game rendering
 };
 
 #endif // WORLD_OF_TANKS_H
@@ -1,9 +1,34 @@
 #version 330
 
 in vec2 fragment_texture_coord;
-uniform float Time;
 out vec4 out_color; 
 
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
+
+// Ground passes
+// FULL:  the whole noise and the craters, every frame (reference quality)
+// BAKE:  the time-invariant layers packed in a texture, rendered once at startup
+// BAKED: the baked texture with a cheap animated wave
+#define GROUND_PASS_FULL  0
+#define GROUND_PASS_BAKE  1
+#define GROUND_PASS_BAKED 2
+
+uniform int GroundPass;
+uniform sampler2D GroundTexture;  // R: noise, G: crater coverage, B: crater gradient
+
+// Adjust the scale for more or fewer spots
+const float noiseScale = 10.0;
+// Frequency of the base wave
+const float waveFrequency = 2.0;
+
 // Perlin Noise Smooth Interpolation With Fractal Brownian Motion
 // https://www.shadertoy.com/view/lltcWl
 // https://rtouti.github.io/graphics/perlin-noise-algorithm
@@ -45,8 +70,6 @@ float layeredNoise(vec2 position, float time)
 
     // Parameters for non-periodic wave
     float waveSpeed = 1.0;  
-    // Frequency of the base wave
-    float waveFrequency = 2.0;
     // How much the noise affects the wave
     float noiseInfluence = 0.5;
 
@@ -116,19 +139,12 @@ vec4 getCraterColor(float randValue, float dist)
     return mix(centerColor, edgeColor, dist);       // Interpolate based on distance from center
 }
 
-void main()
+// Crater coverage (x) and gradient (y) summed over the crater grid, the crater color is
+// centerColor * coverage + (edgeColor - centerColor) * gradient since getCraterColor is linear
+vec2 craterLayers(vec2 uv)
 {
-    // Adjust the scale for more or fewer spots
-    float scale = 10.0;
-    // Generate noise based on fragment position
-    float randValue = layeredNoise(fragment_texture_coord * scale, Time);
-
-    // Base color from Perlin noise
-    vec4 baseColor = getGrayColor(randValue);
-
-    // Heat histogram effect with static crater circles
-    vec4 craterColor = vec4(0.0);
     float craterEffect = 0.0;
+    float craterGradient = 0.0;
 
     // Define the number of craters along each axis
     int numCratersX = 3;
@@ -148,12 +164,56 @@ void main()
             vec2 circlePos = vec2(x + offsetX, y + offsetY);
             float randRadius = 0.05 + 0.05 * fract(sin(float(i * numCratersY + j) * 12.345) * 54321.1234);
 
-            float dist = length(fragment_texture_coord - circlePos) / randRadius;
-            craterEffect += craterCircle(fragment_texture_coord, circlePos, randRadius);
-            craterColor += getCraterColor(randValue, dist) * craterCircle(fragment_texture_coord, circlePos, randRadius);
+            float dist = length(uv - circlePos) / randRadius;
+            float crater = craterCircle(uv, circlePos, randRadius);
+            craterEffect += crater;
+            craterGradient += dist * crater;
         }
     }
 
+    return vec2(craterEffect, craterGradient);
+}
+
+// Base color blended with the heat histogram effect of the static crater circles
+vec4 groundColor(float randValue, vec2 craters)
+{
+    // Base color from Perlin noise
+    vec4 baseColor = getGrayColor(randValue);
+
+    vec4 centerColor = getCraterColor(randValue, 0.0);
+    vec4 edgeColor = getCraterColor(randValue, 1.0);
+    vec4 craterColor = centerColor * craters.x + (edgeColor - centerColor) * craters.y;
+
     // Blend the crater effect with the base color
-    out_color = mix(baseColor, craterColor, craterEffect);
+    return mix(baseColor, craterColor, craters.x);
+}
+
+void main()
+{
+    if (GroundPass == GROUND_PASS_BAKE)
+    {
+        // The noise frozen at time 0 and the craters, they never change
+        float randValue = layeredNoise(fragment_texture_coord * noiseScale, 0.0);
+        out_color = vec4(randValue, craterLayers(fragment_texture_coord), 1.0);
+        return;
+    }
+
+    if (GroundPass == GROUND_PASS_BAKED)
+    {
+        // The wave moves every noise layer by the same amount in noise space, so layer i
+        // (frequency 2^i) by wave / 2^i on the ground: weighted by the amplitudes (0.5^i)
+        // that is about 2/3 of the wave. The baked noise is shifted by that much.
+        vec2 position = fragment_texture_coord * noiseScale;
+        float wave = sin(position.x * waveFrequency + Time) - sin(position.x * waveFrequency);
+        vec2 shift = vec2(wave * (2.0 / 3.0) / noiseScale);
+
+        float randValue = texture(GroundTexture, fragment_texture_coord + shift).r;
+        vec2 craters = texture(GroundTexture, fragment_texture_coord).gb;
+        out_color = groundColor(randValue, craters);
+        return;
+    }
+
+    // Generate noise based on fragment position
+    float randValue = layeredNoise(fragment_texture_coord * noiseScale, Time);
+    out_color = groundColor(randValue, craterLayers(fragment_texture_coord));
 }
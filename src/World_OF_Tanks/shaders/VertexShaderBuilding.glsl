@@ -5,9 +5,20 @@ layout(location = 1) in vec3 vertex_normal;
 layout(location = 2) in vec2 vertex_texture_coord;
 layout(location = 3) in vec3 vertex_color;
 
-uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+// Per instance (one building)
+layout(location = 4) in vec3 instance_position;
+layout(location = 5) in vec3 instance_scale;
+layout(location = 6) in vec3 instance_color;
+
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
 
 out vec3 fragment_position;
 out vec3 interpolated_color;
@@ -16,16 +27,16 @@ out vec2 fragment_texture_coord;
 
 void main()
 {
-    fragment_position = vec3(Model * vec4(vertex_position, 1.0));
-    // Pass vertex color to fragment shader
-    interpolated_color = vertex_color; 
+    // Unit cube scaled and moved to the building
+    fragment_position = instance_position + vertex_position * instance_scale;
+    // Pass building color to fragment shader
+    interpolated_color = instance_color;
 
-    // Calculate fragment normal by transforming vertex normal
-    // with the inverse-transpose of the model matrix
-    fragment_normal = mat3(transpose(inverse(Model))) * vertex_normal;
+    // Calculate fragment normal, the inverse-transpose of a scale is the inverse scale
+    fragment_normal = normalize(vertex_normal / instance_scale);
     
     // Pass vertex texture coordinate to fragment shader
     fragment_texture_coord = vertex_texture_coord;
 
-    gl_Position = Projection * View * Model * vec4(vertex_position, 1.0f);
+    gl_Position = ViewProjection * vec4(fragment_position, 1.0f);
 }
\ No newline at end of file
@@ -3,23 +3,34 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 
-uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
-
-uniform float Time;         // Animation time
-uniform float Health;       // Object health
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
+
+// Per instance (one enemy tank)
+layout(location = 4) in mat4 aModel;        // Body frame
+layout(location = 8) in mat4 aTurretModel;  // Turret frame
+layout(location = 12) in vec2 aState;       // Health, sink depth
+
+uniform mat4 Model;         // Placement of the part in its frame
+uniform int IsTurretPart;   // Part moves with the turret
 uniform vec3 ObjectColor;   // Object color
 
 out vec3 VertexColor;
 
-float deform(vec3 position, out float doffset_dx, out float doffset_dy)
+float deform(vec3 position, float health, out float doffset_dx, out float doffset_dy)
 {
     float freqX = 3.0;    // X-axis frequency
     float freqY = 4.0;    // Y-axis frequency
 
-    float ampX = 0.2 * (1.0 - Health / 100.0); // X-axis amplitude
-    float ampY = 0.15 * (1.0 - Health / 100.0); // Y-axis amplitude
+    float ampX = 0.2 * (1.0 - health / 100.0); // X-axis amplitude
+    float ampY = 0.15 * (1.0 - health / 100.0); // Y-axis amplitude
     float phase = Time * 5.0;  // Animation phase
 
     // Calculate displacement
@@ -35,8 +46,11 @@ float deform(vec3 position, out float doffset_dx, out float doffset_dy)
 
 void main()
 {
+    float health = aState.x;
+    float sinkDepth = aState.y;
+
     float doffset_dx, doffset_dy;
-    float offset = deform(aPos, doffset_dx, doffset_dy);
+    float offset = deform(aPos, health, doffset_dx, doffset_dy);
 
     vec3 newPosition = aPos;
     newPosition.z += offset; // Apply deformation in the z-axis
@@ -47,10 +61,15 @@ void main()
     vec3 newNormal = normalize(cross(tangentX, tangentY));
 
     vec3 damageColor = vec3(1.0, 0.0, 0.0); // Red color for damage
-    float healthFactor = Health / 100.0;
+    float healthFactor = health / 100.0;
 
     // Mix object color with damage color based on health
     VertexColor = mix(damageColor, ObjectColor, healthFactor);
 
-    gl_Position = Projection * View * Model * vec4(newPosition, 1.0);
+    // Part in its frame, then the destroyed tank sinks straight down
+    mat4 frame = IsTurretPart != 0 ? aTurretModel : aModel;
+    vec4 worldPosition = frame * Model * vec4(newPosition, 1.0);
+    worldPosition.y -= sinkDepth;
+
+    gl_Position = ViewProjection * worldPosition;
 }
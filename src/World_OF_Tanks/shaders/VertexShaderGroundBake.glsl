@@ -0,0 +1,14 @@
+#version 330
+
+// Output
+out vec2 fragment_texture_coord;
+
+// One triangle covering the whole render target, no vertex buffer:
+// the vertices 0, 1, 2 are (-1, -1), (3, -1) and (-1, 3) in clip space
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    fragment_texture_coord = position;
+
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
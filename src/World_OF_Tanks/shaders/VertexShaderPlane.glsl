@@ -6,11 +6,18 @@ layout(location = 1) in vec3 vertex_normal;
 layout(location = 2) in vec2 vertex_texture_coord;
 layout(location = 3) in vec3 vertex_color;
 
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
+
 // Uniform properties
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
-uniform float Time;
 
 // Output
 out vec3 fragment_position;
@@ -26,5 +33,5 @@ void main()
     fragment_normal = vertex_normal;
     fragment_texture_coord = vertex_texture_coord;
 
-    gl_Position =  Projection * View * Model * vec4(vertex_position, 1.0f);
+    gl_Position =  ViewProjection * Model * vec4(vertex_position, 1.0f);
 }
\ No newline at end of file
@@ -3,11 +3,18 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 
+// Per-frame camera data, shared by all the shaders
+layout(std140) uniform CameraBlock
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec3 EyePosition;
+    float Time;
+};
+
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
 
-uniform float Time;         // Animation time
 uniform float Health;       // Object health
 uniform vec3 ObjectColor;   // Object color
 
@@ -52,5 +59,5 @@ void main()
     // Mix object color with damage color based on health
     VertexColor = mix(damageColor, ObjectColor, healthFactor);
 
-    gl_Position = Projection * View * Model * vec4(newPosition, 1.0);
+    gl_Position = ViewProjection * Model * vec4(newPosition, 1.0);
 }
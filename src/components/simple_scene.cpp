@@ -6,6 +6,8 @@
 #include "components/camera_input.h"
 #include "components/scene_input.h"
 #include "components/transform.h"
+#include "core/log/log.h"
+#include "core/managers/asset_loader.h"
 
 using namespace gfxc;
 
@@ -18,6 +20,7 @@ SimpleScene::SimpleScene()
 
 SimpleScene::~SimpleScene()
 {
+    SAFE_FREE(cameraBlock);
 }
 
 
@@ -48,13 +51,17 @@ void SimpleScene::InitResources()
     camera->Update();
 
     cameraInput = new CameraInput(camera);
+    cameraBlock = new UniformBuffer<CameraBlock>();
     window = Engine::GetWindow();
 
     SceneInput *SI = new SceneInput(this);
     (void)SI;
 
+    // The files are read on worker threads, uploaded at the end
+    AssetLoader loader;
+
     xozPlane = new Mesh("plane");
-    xozPlane->LoadMesh(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "plane50.obj");
+    loader.LoadMesh(xozPlane, PATH_JOIN(window->props.selfDir, RESOURCE_PATH::MODELS, "primitives"), "plane50.obj");
 
     {
         std::vector<VertexFormat> vertices =
@@ -74,7 +81,7 @@ void SimpleScene::InitResources()
         Shader *shader = new Shader("Simple");
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "MVP.Texture.VS.glsl"), GL_VERTEX_SHADER);
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "Default.FS.glsl"), GL_FRAGMENT_SHADER);
-        shader->CreateAndLink();
+        loader.LoadShader(shader);
         shaders[shader->GetName()] = shader;
     }
 
@@ -83,7 +90,7 @@ void SimpleScene::InitResources()
         Shader *shader = new Shader("Color");
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "MVP.Texture.VS.glsl"), GL_VERTEX_SHADER);
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "Color.FS.glsl"), GL_FRAGMENT_SHADER);
-        shader->CreateAndLink();
+        loader.LoadShader(shader);
         shaders[shader->GetName()] = shader;
     }
 
@@ -92,7 +99,7 @@ void SimpleScene::InitResources()
         Shader *shader = new Shader("VertexNormal");
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "MVP.Texture.VS.glsl"), GL_VERTEX_SHADER);
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "Normals.FS.glsl"), GL_FRAGMENT_SHADER);
-        shader->CreateAndLink();
+        loader.LoadShader(shader);
         shaders[shader->GetName()] = shader;
     }
 
@@ -101,10 +108,12 @@ void SimpleScene::InitResources()
         Shader *shader = new Shader("VertexColor");
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "MVP.Texture.VS.glsl"), GL_VERTEX_SHADER);
         shader->AddShader(PATH_JOIN(window->props.selfDir, RESOURCE_PATH::SHADERS, "VertexColor.FS.glsl"), GL_FRAGMENT_SHADER);
-        shader->CreateAndLink();
+        loader.LoadShader(shader);
         shaders[shader->GetName()] = shader;
     }
 
+    loader.Finish();
+
     // Default rendering mode will use depth buffer
     glDepthMask(GL_TRUE);
     glEnable(GL_DEPTH_TEST);
@@ -131,12 +140,13 @@ void SimpleScene::DrawCoordinateSystem(const glm::mat4 & viewMatrix, const glm::
     glLineWidth(1);
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // The shaders read the camera from the uniform block
+    UpdateCameraBlock(viewMatrix, projectionMaxtix);
+
     // Render the coordinate system
     {
         Shader *shader = shaders["Color"];
         shader->Use();
-        glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-        glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMaxtix));
 
         if (drawGroundPlane)
         {
@@ -178,10 +188,9 @@ void SimpleScene::RenderMesh(Mesh * mesh, Shader * shader, glm::vec3 position, g
     if (!mesh || !shader || !shader->program)
         return;
 
-    // Render an object using the specified shader and the specified position
+    // Render an object using the specified shader and the specified position,
+    // the view and projection come from the camera uniform block
     shader->Use();
-    glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
-    glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 
     glm::mat4 model(1);
     model = glm::translate(model, position);
@@ -202,9 +211,8 @@ void SimpleScene::RenderMesh2D(Mesh * mesh, Shader * shader, const glm::mat3 &mo
     if (!mesh || !shader || !shader->program)
         return;
 
+    // The view and projection come from the camera uniform block
     shader->Use();
-    glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
-    glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 
     glm::mat3 mm = modelMatrix;
     glm::mat4 model = glm::mat4(
@@ -232,10 +240,9 @@ void SimpleScene::RenderMesh2D(Mesh * mesh, const glm::mat3 & modelMatrix, const
         0.f, 0.f, mm[2][2], 0.f,
         mm[2][0], mm[2][1], 0.f, 1.f);
 
-    // Render an object using the specified shader and the specified position
+    // Render an object using the specified shader and the specified position,
+    // the view and projection come from the camera uniform block
     shader->Use();
-    glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
-    glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
     glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(model));
     glUniform3f(shader->GetUniformLocation("color"), color.r, color.g, color.b);
 
@@ -248,10 +255,9 @@ void SimpleScene::RenderMesh(Mesh * mesh, Shader * shader, const glm::mat4 & mod
     if (!mesh || !shader || !shader->program)
         return;
 
-    // Render an object using the specified shader and the specified position
+    // Render an object using the specified shader and the specified position,
+    // the view and projection come from the camera uniform block
     shader->Use();
-    glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
-    glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
     glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(modelMatrix));
 
     mesh->Render();
@@ -260,11 +266,7 @@ void SimpleScene::RenderMesh(Mesh * mesh, Shader * shader, const glm::mat4 & mod
 
 void SimpleScene::ReloadShaders() const
 {
-    std::cout << std::endl;
-    std::cout << "=============================" << std::endl;
-    std::cout << "Reloading Shaders" << std::endl;
-    std::cout << "=============================" << std::endl;
-    std::cout << std::endl;
+    LOG_INFO(Shader, "Reloading Shaders");
 
     for (auto &shader : shaders)
     {
@@ -279,6 +281,27 @@ Camera * SimpleScene::GetSceneCamera() const
 }
 
 
+void SimpleScene::UpdateCameraBlock()
+{
+    UpdateCameraBlock(camera->GetViewMatrix(), camera->GetProjectionMatrix());
+}
+
+
+void SimpleScene::UpdateCameraBlock(const glm::mat4 & viewMatrix, const glm::mat4 & projectionMatrix)
+{
+    CameraBlock block;
+    block.view = viewMatrix;
+    block.projection = projectionMatrix;
+    block.viewProjection = projectionMatrix * viewMatrix;
+    // The eye is the translation of the inverse view
+    block.eyePosition = glm::vec3(glm::inverse(viewMatrix)[3]);
+    block.time = static_cast<float>(Engine::GetElapsedTime());
+
+    cameraBlock->SetData(block);
+    cameraBlock->BindBuffer(CAMERA_BLOCK_BINDING);
+}
+
+
 InputController * SimpleScene::GetCameraInput() const
 {
     return cameraInput;
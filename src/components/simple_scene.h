@@ -9,6 +9,8 @@
 #include "core/engine.h"
 #include "core/gpu/mesh.h"
 #include "core/gpu/shader.h"
+#include "core/gpu/camera_block.h"
+#include "core/gpu/uniform_buffer.h"
 #include "core/gpu/texture2D.h"
 #include "core/managers/resource_path.h"
 #include "core/managers/texture_manager.h"
@@ -32,6 +34,10 @@ namespace gfxc
         bool ToggleGroundPlane();
         void ReloadShaders() const;
 
+        // Upload the camera uniform block read by the shaders, once per frame
+        void UpdateCameraBlock();
+        void UpdateCameraBlock(const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix);
+
         protected:
         virtual void AddMeshToList(Mesh *mesh);
         virtual void DrawCoordinateSystem();
@@ -69,6 +75,7 @@ namespace gfxc
      private:
         Camera *camera;
         InputController *cameraInput;
+        UniformBuffer<CameraBlock> *cameraBlock;
 
         bool drawGroundPlane;
         Mesh *xozPlane;
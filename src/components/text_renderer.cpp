@@ -10,6 +10,9 @@
 
 #include <iostream>
 
+#include "core/gpu/gl_state.h"
+#include "core/log/log.h"
+
 #include "utils/text_utils.h"
 #include "glm/gtc/matrix_transform.hpp"
 #include "core/managers/resource_path.h"
@@ -37,13 +40,13 @@ gfxc::TextRenderer::TextRenderer(const std::string &selfDir, GLuint width, GLuin
     // Configure VAO/VBO for texture quads
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    GLState::BindVertexArray(this->VAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
 }
 
 
@@ -58,14 +61,14 @@ void gfxc::TextRenderer::Load(std::string font, GLuint fontSize)
 
     if (FT_Init_FreeType(&ft))
     {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        LOG_ERROR(Assets, "ERROR::FREETYPE: Could not init FreeType Library");
     }
 
     // Load font as face
     FT_Face face;
     if (FT_New_Face(ft, font.c_str(), 0, &face))
     {
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        LOG_ERROR(Assets, "ERROR::FREETYPE: Failed to load font %s", font.c_str());
     }
 
     // Set size to load glyphs as
@@ -80,14 +83,14 @@ void gfxc::TextRenderer::Load(std::string font, GLuint fontSize)
         // Load character glyph 
         if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            LOG_ERROR(Assets, "ERROR::FREETYTPE: Failed to load Glyph %d", static_cast<int>(c));
             continue;
         }
 
         // Generate texture
         GLuint texture;
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        GLState::BindTexture(GL_TEXTURE_2D, texture);
         glTexImage2D(
             GL_TEXTURE_2D,
             0,
@@ -117,7 +120,7 @@ void gfxc::TextRenderer::Load(std::string font, GLuint fontSize)
         Characters.insert(std::pair<GLchar, Character>(c, character));
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::BindTexture(GL_TEXTURE_2D, 0);
 
     // Destroy freetype once we're finished
     FT_Done_Face(face);
@@ -130,16 +133,15 @@ void gfxc::TextRenderer::RenderText(std::string text, GLfloat x, GLfloat y, GLfl
     // Activate corresponding render state    
     if (this->m_textShader)
     {
-        glUseProgram(this->m_textShader->program);
+        GLState::UseProgram(this->m_textShader->program);
         CheckOpenGLError();
     }
 
     // TODO(developer): Update this class
-    int loc_text_color = glGetUniformLocation(this->m_textShader->program, "textColor");
-    glUniform3f(loc_text_color, color.r, color.g, color.b);
+    this->m_textShader->SetUniform("textColor", color);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    GLState::ActiveTexture(GL_TEXTURE0);
+    GLState::BindVertexArray(this->VAO);
 
     // Iterate through all characters
     for (auto c = text.cbegin(); c != text.cend(); c++)
@@ -164,14 +166,12 @@ void gfxc::TextRenderer::RenderText(std::string text, GLfloat x, GLfloat y, GLfl
         };
 
         // Render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+        GLState::BindTexture(GL_TEXTURE_2D, ch.TextureID);
 
         // Update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, this->VBO);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
         // Render quad
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         glEnable(GL_BLEND);
@@ -183,7 +183,4 @@ void gfxc::TextRenderer::RenderText(std::string text, GLfloat x, GLfloat y, GLfl
         // to get value in pixels.
         x += (ch.Advance >> 6) * scale; 
     }
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
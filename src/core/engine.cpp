@@ -1,32 +1,53 @@
 #include "core/engine.h"
 
-#include <iostream>
+#include <chrono>
 
+#include "core/gpu/mesh_cache.h"
+#include "core/gpu/program_cache.h"
+#include "core/log/log.h"
+#include "core/managers/asset_loader.h"
 #include "core/managers/texture_manager.h"
 #include "utils/gl_utils.h"
 
 
 WindowObject* Engine::window = nullptr;
 
+// Time origin of a headless run, GLFW isn't initialized then
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
 
 WindowObject* Engine::Init(const WindowProperties & props)
 {
-    /* Initialize the library */
-    if (!glfwInit())
+    /* Initialize the library, a headless window doesn't use it */
+    if (!props.headless && !glfwInit())
         exit(0);
 
     window = new WindowObject(props);
 
     glewExperimental = true;
     GLenum err = glewInit();
+    // EGL context: a GLEW built for GLX loads the GL functions, then fails on the
+    // missing X display (GLEW_ERROR_NO_GLX_DISPLAY, not defined by every glew.h).
+    // Only the GL part matters, accept it when the core functions are there.
+    if (props.headless && err != GLEW_OK && glGenVertexArrays != nullptr && glGetString(GL_VERSION) != nullptr)
+        err = GLEW_OK;
     if (GLEW_OK != err)
     {
         // Serious problem
-        fprintf(stderr, "Error: %s\n", glewGetErrorString(err));
+        LOG_ERROR(Engine, "Error: %s", reinterpret_cast<const char *>(glewGetErrorString(err)));
         exit(0);
     }
 
-    TextureManager::Init(window->props.selfDir);
+    // Headless: draw into the offscreen target from now on
+    window->InitRenderTarget();
+
+    MeshCache::Init(window->props.selfDir);
+    ProgramCache::Init(window->props.selfDir);
+
+    // The default textures are decoded in parallel
+    AssetLoader loader;
+    TextureManager::Init(window->props.selfDir, loader);
+    loader.Finish();
 
     return window;
 }
@@ -40,13 +61,19 @@ WindowObject* Engine::GetWindow()
 
 void Engine::Exit()
 {
-    std::cout << "=====================================================" << std::endl;
-    std::cout << "Engine closed. Exit" << std::endl;
+    LOG_INFO(Engine, "Engine closed. Exit");
     glfwTerminate();
 }
 
 
 double Engine::GetElapsedTime()
 {
+    if (window && window->props.headless)
+    {
+        // Fixed step, the time only depends on the frame
+        if (window->props.frameTime > 0)
+            return window->GetFrameID() * window->props.frameTime;
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
     return glfwGetTime();
 }
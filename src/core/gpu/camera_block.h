@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+#include "utils/gl_utils.h"
+#include "utils/glm_utils.h"
+
+
+// Binding point of the camera uniform block, every shader
+// program declaring `CameraBlock` is bound to it when linked
+#define CAMERA_BLOCK_BINDING    (0)
+
+
+// Per-frame camera data, uploaded once per frame and read by all the shaders:
+//
+//     layout(std140) uniform CameraBlock
+//     {
+//         mat4 View;
+//         mat4 Projection;
+//         mat4 ViewProjection;
+//         vec3 EyePosition;
+//         float Time;
+//     };
+//
+// The std140 vec3 takes 16 bytes, Time sits in its padding.
+struct CameraBlock
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec3 eyePosition;
+    float time;
+};
+
+static_assert(offsetof(CameraBlock, projection) == 64, "CameraBlock does not match the std140 layout");
+static_assert(offsetof(CameraBlock, viewProjection) == 128, "CameraBlock does not match the std140 layout");
+static_assert(offsetof(CameraBlock, eyePosition) == 192, "CameraBlock does not match the std140 layout");
+static_assert(offsetof(CameraBlock, time) == 204, "CameraBlock does not match the std140 layout");
+static_assert(sizeof(CameraBlock) == 208, "CameraBlock does not match the std140 layout");
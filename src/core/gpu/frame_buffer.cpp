@@ -1,14 +1,15 @@
 #include "core/gpu/frame_buffer.h"
 
-#include <iostream>
 #include <utility>
 
 #include "core/window/window_callbacks.h"
+#include "core/log/log.h"
 #include "utils/gl_utils.h"
 #include "utils/memory_utils.h"
 
 
 glm::vec4 FrameBuffer::defaultClearColor = glm::vec4(0);
+unsigned int FrameBuffer::defaultFBO = 0;
 
 
 FrameBuffer::FrameBuffer()
@@ -42,9 +43,7 @@ void FrameBuffer::Generate(int width, int height, int nrTextures, bool hasDepthT
 
     precision = (precision / 8) * 8;
 
-    #ifdef DEBUG_INFO
-        cout << "FBO: " << width << " * " << height << " textures attached: " << nrTextures << endl;
-    #endif
+    LOG_DEBUG(Gpu, "FBO: %d * %d textures attached: %d", width, height, nrTextures);
 
     this->width = width;
     this->height = height;
@@ -78,9 +77,9 @@ void FrameBuffer::Generate(int width, int height, int nrTextures, bool hasDepthT
     }
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "FRAMEBUFFER NOT COMPLETE" << std::endl;
+        LOG_ERROR(Gpu, "FRAMEBUFFER NOT COMPLETE");
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
     CheckOpenGLError();
 }
 
@@ -132,6 +131,12 @@ glm::ivec2 FrameBuffer::GetResolution() const {
 }
 
 
+unsigned int FrameBuffer::GetFramebufferID() const
+{
+    return FBO;
+}
+
+
 unsigned int FrameBuffer::GetNumberOfRenderTargets() const
 {
     return nrTextures;
@@ -178,13 +183,13 @@ void FrameBuffer::BindAllTextures() const
 
 void FrameBuffer::BindDefault()
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
 }
 
 
 void FrameBuffer::BindDefault(const glm::ivec2 &viewportSize, bool clearBuffer)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
     glViewport(0, 0, viewportSize.x, viewportSize.y);
     if (clearBuffer) {
         glClearColor(defaultClearColor.r, defaultClearColor.g, defaultClearColor.b, defaultClearColor.a);
@@ -206,6 +211,12 @@ void FrameBuffer::SetDefaultClearColor(glm::vec4 clearColor)
 }
 
 
+void FrameBuffer::SetDefaultFramebuffer(unsigned int framebufferID)
+{
+    defaultFBO = framebufferID;
+}
+
+
 void FrameBuffer::Clear()
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -27,6 +27,7 @@ class FrameBuffer
     unsigned int GetNumberOfRenderTargets() const;
 
     glm::ivec2 GetResolution() const;
+    unsigned int GetFramebufferID() const;
 
     void SendResolution(Shader *shader) const;
     void SetClearColor(glm::vec4 clearColor);
@@ -37,6 +38,9 @@ class FrameBuffer
     static void SetViewport(const glm::ivec2 &viewportSize, const glm::ivec2 offset = glm::ivec2(0, 0));
     static void SetDefaultClearColor(glm::vec4 clearColor);
 
+    // Target of BindDefault, 0 (the window) unless the context has no window
+    static void SetDefaultFramebuffer(unsigned int framebufferID);
+
  private:
     Texture2D *textures;
     Texture2D *depthTexture;
@@ -49,4 +53,5 @@ class FrameBuffer
     unsigned int nrTextures;
     glm::vec4 clearColor;
     static glm::vec4 defaultClearColor;
+    static unsigned int defaultFBO;
 };
@@ -0,0 +1,154 @@
+#include "core/gpu/gl_state.h"
+
+
+// Name no object has: the state is unknown, the next bind goes to the driver
+static const GLuint UNKNOWN = ~0u;
+
+// Start with the default state of a new context
+GLuint GLState::program = 0;
+GLuint GLState::vertexArray = 0;
+GLuint GLState::activeTexture = GL_TEXTURE0;
+GLuint GLState::textures[GL_STATE_MAX_TEXTURE_UNITS] = {};
+GLuint GLState::arrayBuffer = 0;
+GLuint GLState::uniformBuffer = 0;
+GLuint GLState::shaderStorageBuffer = 0;
+
+unsigned int GLState::issuedCount = 0;
+unsigned int GLState::skippedCount = 0;
+
+
+bool GLState::Changed(GLuint &cached, GLuint value)
+{
+    if (cached == value)
+    {
+        skippedCount++;
+        return false;
+    }
+
+    cached = value;
+    issuedCount++;
+    return true;
+}
+
+
+void GLState::UseProgram(GLuint program)
+{
+    if (Changed(GLState::program, program)) {
+        glUseProgram(program);
+    }
+}
+
+
+void GLState::BindVertexArray(GLuint vao)
+{
+    if (Changed(vertexArray, vao)) {
+        glBindVertexArray(vao);
+    }
+}
+
+
+void GLState::ActiveTexture(GLenum unit)
+{
+    if (Changed(activeTexture, unit)) {
+        glActiveTexture(unit);
+    }
+}
+
+
+void GLState::BindTexture(GLenum target, GLuint texture)
+{
+    GLuint unit = activeTexture - GL_TEXTURE0;
+    if (target != GL_TEXTURE_2D || activeTexture == UNKNOWN || unit >= GL_STATE_MAX_TEXTURE_UNITS)
+    {
+        issuedCount++;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (Changed(textures[unit], texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+
+void GLState::BindTextureToUnit(GLenum unit, GLuint texture)
+{
+    ActiveTexture(unit);
+    BindTexture(GL_TEXTURE_2D, texture);
+}
+
+
+void GLState::BindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint *cached = nullptr;
+    switch (target)
+    {
+        case GL_ARRAY_BUFFER:           cached = &arrayBuffer; break;
+        case GL_UNIFORM_BUFFER:         cached = &uniformBuffer; break;
+        case GL_SHADER_STORAGE_BUFFER:  cached = &shaderStorageBuffer; break;
+        default: break;
+    }
+
+    if (!cached)
+    {
+        issuedCount++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (Changed(*cached, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+
+void GLState::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    // The indexed binding points are not tracked, only the generic one it changes
+    issuedCount++;
+    glBindBufferBase(target, index, buffer);
+
+    switch (target)
+    {
+        case GL_UNIFORM_BUFFER:         uniformBuffer = buffer; break;
+        case GL_SHADER_STORAGE_BUFFER:  shaderStorageBuffer = buffer; break;
+        default: break;
+    }
+}
+
+
+void GLState::Invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeTexture = UNKNOWN;
+    for (int i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; i++) {
+        textures[i] = UNKNOWN;
+    }
+    arrayBuffer = UNKNOWN;
+    uniformBuffer = UNKNOWN;
+    shaderStorageBuffer = UNKNOWN;
+}
+
+
+void GLState::ForgetTexture(GLuint texture)
+{
+    for (int i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; i++) {
+        if (textures[i] == texture) {
+            textures[i] = UNKNOWN;
+        }
+    }
+}
+
+
+void GLState::GetCounters(unsigned int &issued, unsigned int &skipped, bool reset)
+{
+    issued = issuedCount;
+    skipped = skippedCount;
+
+    if (reset)
+    {
+        issuedCount = 0;
+        skippedCount = 0;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "utils/gl_utils.h"
+
+
+#define GL_STATE_MAX_TEXTURE_UNITS      (32)
+
+
+// Shadow copy of the GL binding state: the program, the vertex array, the
+// active texture unit with its 2D textures, and the array, uniform and
+// shader storage buffers. A bind of what is already bound is skipped.
+//
+// The cache only stays right if every bind goes through it. Code that
+// binds with raw GL calls, or deletes a bound object (a new object may get
+// the same name), has to call Invalidate() afterwards, or ForgetTexture()
+// for a deleted texture.
+class GLState
+{
+ public:
+    static void UseProgram(GLuint program);
+    static void BindVertexArray(GLuint vao);
+
+    // `unit` is GL_TEXTURE0 + i, like glActiveTexture
+    static void ActiveTexture(GLenum unit);
+    // Bind to the active texture unit, only GL_TEXTURE_2D is tracked
+    static void BindTexture(GLenum target, GLuint texture);
+    static void BindTextureToUnit(GLenum unit, GLuint texture);
+
+    // GL_ELEMENT_ARRAY_BUFFER belongs to the vertex array, it is not tracked
+    static void BindBuffer(GLenum target, GLuint buffer);
+    // Also binds the generic binding point of the target, like GL does
+    static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+    // Forget everything, the next binds go to the driver
+    static void Invalidate();
+    // Forget the units a deleted texture was bound to, the rest of the cache stays
+    static void ForgetTexture(GLuint texture);
+
+    // Binds sent to the driver and binds skipped since the last call
+    static void GetCounters(unsigned int &issued, unsigned int &skipped, bool reset = true);
+
+ private:
+    static bool Changed(GLuint &cached, GLuint value);
+
+ private:
+    static GLuint program;
+    static GLuint vertexArray;
+    static GLuint activeTexture;
+    static GLuint textures[GL_STATE_MAX_TEXTURE_UNITS];
+    static GLuint arrayBuffer;
+    static GLuint uniformBuffer;
+    static GLuint shaderStorageBuffer;
+
+    static unsigned int issuedCount;
+    static unsigned int skippedCount;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include "core/gpu/vertex_format.h"
@@ -45,4 +46,8 @@ namespace gpu_utils
 
     GPUBuffers UploadData(const std::vector<VertexFormat> &vertices,
                           const std::vector<unsigned int>& indices);
+
+    // One interleaved vertex buffer, e.g. straight from a mapped mesh cache file
+    GPUBuffers UploadData(const PackedVertex *vertices, std::size_t nrVertices,
+                          const unsigned int *indices, std::size_t nrIndices);
 }   // namespace gpu_utils
@@ -0,0 +1,233 @@
+#include "core/gpu/gpu_profiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+
+#include "core/log/log.h"
+
+
+GpuProfiler::GpuProfiler(unsigned int latency)
+    : ring(std::max(latency, 2u)), frameIndex(0), inFrame(false), inScope(false),
+      logging(false), logInterval(1.0), windowStart(std::chrono::steady_clock::now()), droppedFrames(0)
+{
+    for (FrameQueries &frame : ring)
+    {
+        frame.frameBegin = 0;
+        frame.frameEnd = 0;
+        frame.used = 0;
+        frame.pending = false;
+    }
+
+    // The "Frame" scope always comes first
+    GetScopeIndex("Frame");
+}
+
+
+GpuProfiler::~GpuProfiler()
+{
+    for (FrameQueries &frame : ring)
+    {
+        if (frame.frameBegin)
+        {
+            glDeleteQueries(1, &frame.frameBegin);
+            glDeleteQueries(1, &frame.frameEnd);
+        }
+        if (!frame.queries.empty())
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), &frame.queries[0]);
+    }
+}
+
+
+void GpuProfiler::BeginFrame()
+{
+    FrameQueries &frame = ring[frameIndex % ring.size()];
+    if (frame.pending)
+        ReadBack(frame);
+
+    if (!frame.frameBegin)
+    {
+        glGenQueries(1, &frame.frameBegin);
+        glGenQueries(1, &frame.frameEnd);
+    }
+
+    frame.used = 0;
+    frame.scopes.clear();
+    glQueryCounter(frame.frameBegin, GL_TIMESTAMP);
+    inFrame = true;
+
+    // Roll the window even when nothing is logged, GetScope gives its stats
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - windowStart).count();
+    if (elapsed >= logInterval)
+        CloseWindow();
+}
+
+
+void GpuProfiler::EndFrame()
+{
+    if (!inFrame)
+        return;
+
+    End();
+
+    FrameQueries &frame = ring[frameIndex % ring.size()];
+    glQueryCounter(frame.frameEnd, GL_TIMESTAMP);
+    frame.pending = true;
+
+    inFrame = false;
+    frameIndex++;
+}
+
+
+void GpuProfiler::Begin(const char *scope)
+{
+    if (!inFrame)
+        return;
+
+    End();
+
+    FrameQueries &frame = ring[frameIndex % ring.size()];
+    if (frame.used == frame.queries.size())
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+
+    frame.scopes.push_back(GetScopeIndex(scope));
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used++]);
+    inScope = true;
+}
+
+
+void GpuProfiler::End()
+{
+    if (!inScope)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    inScope = false;
+}
+
+
+const GpuScopeStats *GpuProfiler::GetScope(const char *name) const
+{
+    for (const GpuScopeStats &stats : scopes)
+    {
+        if (stats.name == name)
+            return stats.lastMs >= 0.0 ? &stats : nullptr;
+    }
+    return nullptr;
+}
+
+
+void GpuProfiler::SetLogging(bool enabled, double intervalSeconds)
+{
+    logging = enabled;
+    logInterval = std::max(intervalSeconds, 0.01);
+}
+
+
+std::size_t GpuProfiler::GetScopeIndex(const char *name)
+{
+    // A handful of scopes, a linear search is enough
+    for (std::size_t i = 0; i < scopes.size(); i++)
+    {
+        if (scopes[i].name == name)
+            return i;
+    }
+
+    GpuScopeStats stats;
+    stats.name = name;
+    stats.lastMs = -1.0;
+    stats.minMs = stats.avgMs = stats.maxMs = 0.0;
+    stats.windowMinMs = DBL_MAX;
+    stats.windowMaxMs = 0.0;
+    stats.windowSumMs = 0.0;
+    stats.windowFrames = 0;
+    scopes.push_back(stats);
+    return scopes.size() - 1;
+}
+
+
+void GpuProfiler::ReadBack(FrameQueries &frame)
+{
+    frame.pending = false;
+
+    // Still running `latency` frames later: drop the frame rather than wait
+    GLint available = 0;
+    glGetQueryObjectiv(frame.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    for (std::size_t i = 0; available && i < frame.used; i++)
+    {
+        glGetQueryObjectiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if (!available)
+    {
+        droppedFrames++;
+        return;
+    }
+
+    frameMs.assign(scopes.size(), 0.0);
+    frameSeen.assign(scopes.size(), 0);
+
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(frame.frameBegin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(frame.frameEnd, GL_QUERY_RESULT, &end);
+    frameMs[0] = (end - begin) * 1e-6;
+    frameSeen[0] = 1;
+
+    for (std::size_t i = 0; i < frame.used; i++)
+    {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+        frameMs[frame.scopes[i]] += elapsed * 1e-6;
+        frameSeen[frame.scopes[i]] = 1;
+    }
+
+    for (std::size_t i = 0; i < scopes.size(); i++)
+    {
+        if (frameSeen[i])
+            AddSample(i, frameMs[i]);
+    }
+}
+
+
+void GpuProfiler::AddSample(std::size_t scope, double ms)
+{
+    GpuScopeStats &stats = scopes[scope];
+    stats.lastMs = ms;
+    stats.windowMinMs = std::min(stats.windowMinMs, ms);
+    stats.windowMaxMs = std::max(stats.windowMaxMs, ms);
+    stats.windowSumMs += ms;
+    stats.windowFrames++;
+}
+
+
+void GpuProfiler::CloseWindow()
+{
+    windowStart = std::chrono::steady_clock::now();
+
+    if (logging)
+        LOG_INFO(Gpu, "GPU TIMERS (ms)            min      avg      max   frames");
+
+    for (GpuScopeStats &stats : scopes)
+    {
+        if (stats.windowFrames == 0)
+            continue;
+
+        stats.minMs = stats.windowMinMs;
+        stats.avgMs = stats.windowSumMs / stats.windowFrames;
+        stats.maxMs = stats.windowMaxMs;
+
+        if (logging)
+        {
+            LOG_INFO(Gpu, "  %-20s %8.3f %8.3f %8.3f %8u", stats.name.c_str(), stats.minMs, stats.avgMs, stats.maxMs,
+                     stats.windowFrames);
+        }
+
+        stats.windowMinMs = DBL_MAX;
+        stats.windowMaxMs = 0.0;
+        stats.windowSumMs = 0.0;
+        stats.windowFrames = 0;
+    }
+}
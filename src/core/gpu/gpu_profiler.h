@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "utils/gl_utils.h"
+
+
+// GPU time of a named scope, in milliseconds per frame
+struct GpuScopeStats
+{
+    std::string name;
+    double lastMs;      // Last frame read back
+
+    // Over the last complete window (logInterval seconds)
+    double minMs;
+    double avgMs;
+    double maxMs;
+
+    // Window being measured
+    double windowMinMs;
+    double windowMaxMs;
+    double windowSumMs;
+    unsigned int windowFrames;
+};
+
+
+// GPU timers of the render passes. Every scope is a GL_TIME_ELAPSED query and
+// every frame is bracketed by two GL_TIMESTAMP queries (the "Frame" scope).
+// The queries of a frame are read back `latency` frames later from a ring of
+// query sets, so the CPU never waits for the GPU; a frame whose queries are
+// still pending by then is dropped.
+// Scopes can't nest (one GL_TIME_ELAPSED query at a time), a scope opened
+// several times in a frame is summed.
+class GpuProfiler
+{
+ public:
+    explicit GpuProfiler(unsigned int latency = 3);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Read back the frame issued `latency` frames ago, then start timing this one
+    void BeginFrame();
+    void EndFrame();
+
+    // Time the GL commands until End(), Begin closes the scope still open
+    void Begin(const char *scope);
+    void End();
+
+    // Timings per scope, nullptr before the first result of that scope
+    const GpuScopeStats *GetScope(const char *name) const;
+    const std::vector<GpuScopeStats>& GetScopes() const { return scopes; }
+
+    // Rolling min / avg / max over windows of intervalSeconds, printed at the end
+    // of every window when logging is on
+    void SetLogging(bool enabled, double intervalSeconds = 1.0);
+    bool IsLogging() const { return logging; }
+
+    unsigned int GetDroppedFrames() const { return droppedFrames; }
+
+ private:
+    struct FrameQueries
+    {
+        GLuint frameBegin;
+        GLuint frameEnd;
+        std::vector<GLuint> queries;        // Pool, the first `used` ones were issued
+        std::vector<std::size_t> scopes;    // Scope of each issued query
+        std::size_t used;
+        bool pending;
+    };
+
+    std::size_t GetScopeIndex(const char *name);
+    void ReadBack(FrameQueries &frame);
+    void AddSample(std::size_t scope, double ms);
+    void CloseWindow();
+
+ private:
+    std::vector<FrameQueries> ring;
+    std::size_t frameIndex;
+    bool inFrame;
+    bool inScope;
+
+    std::vector<GpuScopeStats> scopes;
+    std::vector<double> frameMs;            // Read back scratch, per scope
+    std::vector<char> frameSeen;
+
+    bool logging;
+    double logInterval;
+    std::chrono::steady_clock::time_point windowStart;
+    unsigned int droppedFrames;
+};
@@ -1,12 +1,16 @@
 #include "core/gpu/mesh.h"
 
+#include <cstring>
 #include <utility>
 
 #include "assimp/Importer.hpp"          // C++ importer interface
 #include "assimp/postprocess.h"         // Post processing flags
 
 #include "core/gpu/gpu_buffers.h"
+#include "core/gpu/gl_state.h"
+#include "core/gpu/mesh_cache.h"
 #include "core/gpu/texture2D.h"
+#include "core/log/log.h"
 #include "core/managers/texture_manager.h"
 
 #include "utils/memory_utils.h"
@@ -107,30 +111,96 @@ void Mesh::ClearRootNode(aiNode* node)
 
 bool Mesh::LoadMesh(const std::string& fileLocation,
     const std::string& fileName)
+{
+    return ImportMesh(fileLocation, fileName) && UploadMesh();
+}
+
+
+bool Mesh::ImportMesh(const std::string& fileLocation,
+    const std::string& fileName)
 {
     ClearData();
+    importedData.reset();
+    importedMaterials.clear();
     this->fileLocation = fileLocation;
     std::string file = (fileLocation + '/' + fileName).c_str();
 
-    Assimp::Importer Importer;
-
     unsigned int flags = aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
     if (glDrawMode == GL_TRIANGLES) flags |= aiProcess_Triangulate;
 
+    // Imported before, by this process or by a previous run
+    std::shared_ptr<const MeshCacheData> cached = MeshCache::Load(file, flags);
+    if (cached) {
+        importedData = cached;
+        return InitFromCache(*cached);
+    }
+
+    Assimp::Importer Importer;
+
     const aiScene* pScene = Importer.ReadFile(file, flags);
 
     if (pScene) {
         m_GlobalInverseTransform = glm::inverse(ConvertMatrix(pScene->mRootNode->mTransformation));
-        return InitFromScene(pScene);
+        if (!InitFromScene(pScene))
+            return false;
+
+        // Static meshes are uploaded interleaved, from the data written to the cache
+        importedData = MeshCache::Store(file, flags, *this);
+        return true;
     }
 
     // pScene is freed when returning because of Importer
 
-    printf("Error parsing '%s': '%s'\n", file.c_str(), Importer.GetErrorString());
+    LOG_ERROR(Assets, "Error parsing '%s': '%s'", file.c_str(), Importer.GetErrorString());
     return false;
 }
 
 
+bool Mesh::UploadMesh()
+{
+    if (useMaterial)
+        InitMaterials();
+
+    buffers->ReleaseMemory();
+    if (importedData) {
+        const MeshCacheHeader& header = *importedData->header;
+        *buffers = gpu_utils::UploadData(importedData->vertices, header.vertexCount,
+                                         importedData->indices, header.indexCount);
+        importedData.reset();
+    } else {
+        *buffers = gpu_utils::UploadData(positions, normals, texCoords, bones, indices);
+    }
+    return buffers->m_VAO != 0;
+}
+
+
+bool Mesh::InitFromCache(const MeshCacheData& data)
+{
+    const MeshCacheHeader& header = *data.header;
+
+    // Static mesh: no animations, an empty root node
+    numAnim = 0;
+    anim = nullptr;
+    rootNode = new aiNode();
+    m_GlobalInverseTransform = header.globalInverseTransform;
+
+    // The vertices stay in the cache, the draws only need the entries and the indices
+    indices.assign(data.indices, data.indices + header.indexCount);
+
+    meshEntries.resize(header.submeshCount);
+    for (unsigned int i = 0; i < header.submeshCount; i++)
+    {
+        meshEntries[i].nrIndices = data.submeshes[i].nrIndices;
+        meshEntries[i].baseVertex = data.submeshes[i].baseVertex;
+        meshEntries[i].baseIndex = data.submeshes[i].baseIndex;
+        meshEntries[i].materialIndex = data.submeshes[i].materialIndex;
+    }
+
+    importedMaterials.assign(data.materials, data.materials + header.materialCount);
+    return true;
+}
+
+
 void Mesh::InitFromData()
 {
     meshEntries.clear();
@@ -211,7 +281,6 @@ bool Mesh::InitFromScene(const aiScene* pScene)
     rootNode = CopyRoot(pScene->mRootNode);
 
     meshEntries.resize(pScene->mNumMeshes);
-    materials.resize(pScene->mNumMaterials);
 
     unsigned int nrVertices = 0;
     unsigned int nrIndices = 0;
@@ -242,12 +311,8 @@ bool Mesh::InitFromScene(const aiScene* pScene)
         InitMesh(i, paiMesh);
     }
 
-    if (useMaterial && !InitMaterials(pScene))
-        return false;
-
-    buffers->ReleaseMemory();
-    *buffers = gpu_utils::UploadData(positions, normals, texCoords, bones, indices);
-    return buffers->m_VAO != 0;
+    ImportMaterials(pScene);
+    return true;
 }
 
 void Mesh::CopyAnimations(const aiScene* pScene)
@@ -398,40 +463,59 @@ glm::mat4 Mesh::ConvertMatrix(const aiMatrix4x4& aiMat)
 }
 
 
-bool Mesh::InitMaterials(const aiScene* pScene)
+void Mesh::ImportMaterials(const aiScene* pScene)
 {
-    bool ret = true;
     aiColor4D color;
+    importedMaterials.resize(pScene->mNumMaterials);
 
     for (unsigned int i = 0 ; i < pScene->mNumMaterials ; i++)
     {
         const aiMaterial* pMaterial = pScene->mMaterials[i];
-        materials[i] = new Material();
+        MeshCacheMaterial& material = importedMaterials[i];
+        memset(&material, 0, sizeof(material));
 
         if (pMaterial->GetTextureCount(aiTextureType_DIFFUSE) > 0)
         {
             aiString Path;
             if (pMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &Path, NULL, NULL, NULL, NULL, NULL) == AI_SUCCESS)
             {
-                materials[i]->texture = TextureManager::LoadTexture(fileLocation, Path.data);
+                strncpy(material.texture, Path.data, MESH_CACHE_NAME_LENGTH - 1);
             }
         }
 
         if (aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_AMBIENT, &color) == AI_SUCCESS)
-            memcpy((void *)&materials[i]->ambient, &color, sizeof(color));
+            memcpy((void *)&material.ambient, &color, sizeof(color));
 
         if (aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_DIFFUSE, &color) == AI_SUCCESS)
-            memcpy((void *)&materials[i]->diffuse, &color, sizeof(color));
+            memcpy((void *)&material.diffuse, &color, sizeof(color));
 
         if (aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_SPECULAR, &color) == AI_SUCCESS)
-            memcpy((void *)&materials[i]->specular, &color, sizeof(color));
+            memcpy((void *)&material.specular, &color, sizeof(color));
 
         if (aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_EMISSIVE, &color) == AI_SUCCESS)
-            memcpy((void *)&materials[i]->emissive, &color, sizeof(color));
+            memcpy((void *)&material.emissive, &color, sizeof(color));
+    }
+}
+
+
+void Mesh::InitMaterials()
+{
+    materials.resize(importedMaterials.size());
+    for (unsigned int i = 0; i < importedMaterials.size(); i++)
+    {
+        const MeshCacheMaterial& imported = importedMaterials[i];
+        materials[i] = new Material();
+        materials[i]->ambient = imported.ambient;
+        materials[i]->diffuse = imported.diffuse;
+        materials[i]->specular = imported.specular;
+        materials[i]->emissive = imported.emissive;
+        materials[i]->shininess = imported.shininess;
+
+        if (imported.texture[0])
+            materials[i]->texture = TextureManager::LoadTexture(fileLocation, imported.texture);
     }
 
     CheckOpenGLError();
-    return ret;
 }
 
 
@@ -455,7 +539,7 @@ void Mesh::UseMaterials(bool value)
 
 void Mesh::Render() const
 {
-    glBindVertexArray(buffers->m_VAO);
+    GLState::BindVertexArray(buffers->m_VAO);
     for (unsigned int i = 0; i < meshEntries.size(); i++)
     {
         if (useMaterial)
@@ -473,5 +557,5 @@ void Mesh::Render() const
             GL_UNSIGNED_INT, (void*)(sizeof(unsigned int) * meshEntries[i].baseIndex),
             meshEntries[i].baseVertex);
     }
-    glBindVertexArray(0);
+    // The vertex array stays bound, the next draw binds its own
 }
@@ -3,7 +3,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
+#include "core/gpu/mesh_cache.h"
 #include "core/gpu/vertex_format.h"
 #include "core/gpu/texture2D.h"
 #include "core/gpu/gpu_buffers.h"
@@ -63,9 +65,18 @@ class Mesh {
                       const std::vector<glm::vec2>& texCoords,
                       const std::vector<unsigned int>& indices);
 
+    // Import the file then upload it, on the GL thread
     bool LoadMesh(const std::string& fileLocation,
                   const std::string& fileName);
 
+    // Read the file into CPU memory (from the mesh cache or with Assimp), no GL call:
+    // it may run on a worker thread, as long as no other thread uses the mesh
+    bool ImportMesh(const std::string& fileLocation,
+                    const std::string& fileName);
+
+    // Create the materials and the GPU buffers of the imported mesh, on the GL thread
+    bool UploadMesh();
+
     glm::mat4 ConvertMatrix(const aiMatrix4x4& aiMat);
     void UseMaterials(bool value);
 
@@ -84,8 +95,10 @@ class Mesh {
 
     void InitMesh(int index, const aiMesh* paiMesh);
     void LoadBones(int MeshIndex, const aiMesh* pMesh);
-    bool InitMaterials(const aiScene* pScene);
+    void ImportMaterials(const aiScene* pScene);
+    void InitMaterials();
     bool InitFromScene(const aiScene* pScene);
+    bool InitFromCache(const MeshCacheData& data);
 
     aiNode* CopyRoot(const aiNode* sourceNode);
     void CopyAnimations(const aiScene* pScene);
@@ -120,6 +133,7 @@ class Mesh {
 
     ///////////////////////////
     std::vector<Material*> materials;
+    std::vector<MeshCacheMaterial> importedMaterials;   // Read by ImportMesh, made into materials by UploadMesh
     std::vector<MeshEntry> meshEntries;
     bool useMaterial;
 
@@ -128,4 +142,7 @@ class Mesh {
 
     GLenum glDrawMode;
     GPUBuffers* buffers;
+
+    // Interleaved vertices of a static mesh, between ImportMesh and UploadMesh
+    std::shared_ptr<const MeshCacheData> importedData;
 };
@@ -0,0 +1,353 @@
+#include "core/gpu/mesh_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#   include <direct.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+#include "core/gpu/mesh.h"
+#include "core/log/log.h"
+#include "core/managers/resource_path.h"
+
+
+static_assert(sizeof(PackedVertex) == 32, "PackedVertex must be tightly packed");
+static_assert(sizeof(MeshCacheSubmesh) == sizeof(MeshEntry), "MeshCacheSubmesh and MeshEntry size differs");
+
+
+std::string MeshCache::directory;
+std::unordered_map<std::string, std::shared_ptr<const MeshCacheData>> MeshCache::loaded;
+std::mutex MeshCache::mutex;
+
+
+namespace
+{
+    const uint64_t sectionAlignment = 16;
+
+
+    uint64_t Align(uint64_t offset)
+    {
+        return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+    }
+
+
+    // FNV-1a, enough to tell two versions of a file apart
+    uint64_t Hash(const void *data, std::size_t size, uint64_t hash = 0xCBF29CE484222325ULL)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+
+    bool GetFileInfo(const std::string &file, uint64_t &size, int64_t &time)
+    {
+        struct stat info;
+        if (stat(file.c_str(), &info) != 0)
+            return false;
+
+        // Nanoseconds where the file system has them, a file rewritten within the
+        // second of the cache still gets a new time
+        size = static_cast<uint64_t>(info.st_size);
+#if defined(__APPLE__)
+        time = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+        time = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#else
+        time = static_cast<int64_t>(info.st_mtime) * 1000000000;
+#endif
+        return true;
+    }
+
+
+    bool HashFile(const std::string &file, uint64_t &hash)
+    {
+        FILE *source = fopen(file.c_str(), "rb");
+        if (!source)
+            return false;
+
+        hash = 0xCBF29CE484222325ULL;
+        unsigned char chunk[64 * 1024];
+        std::size_t read = 0;
+        while ((read = fread(chunk, 1, sizeof(chunk), source)) > 0)
+        {
+            hash = Hash(chunk, read, hash);
+        }
+
+        fclose(source);
+        return true;
+    }
+
+
+    void MakeDirectory(const std::string &path)
+    {
+#if defined(_WIN32)
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+
+    // Map a whole file read-only, returns nullptr on failure
+    void *MapFile(const std::string &file, std::size_t &size)
+    {
+#if defined(_WIN32)
+        HANDLE handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, NULL);
+        if (handle == INVALID_HANDLE_VALUE)
+            return nullptr;
+
+        LARGE_INTEGER fileSize;
+        void *view = nullptr;
+        if (GetFileSizeEx(handle, &fileSize) && fileSize.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping)
+            {
+                view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+            size = static_cast<std::size_t>(fileSize.QuadPart);
+        }
+        CloseHandle(handle);
+        return view;
+#else
+        int handle = open(file.c_str(), O_RDONLY);
+        if (handle < 0)
+            return nullptr;
+
+        struct stat info;
+        void *view = nullptr;
+        if (fstat(handle, &info) == 0 && info.st_size > 0)
+        {
+            size = static_cast<std::size_t>(info.st_size);
+            view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, handle, 0);
+            if (view == MAP_FAILED)
+                view = nullptr;
+        }
+        close(handle);
+        return view;
+#endif
+    }
+
+
+    void UnmapFile(void *view, std::size_t size)
+    {
+#if defined(_WIN32)
+        (void)size;
+        UnmapViewOfFile(view);
+#else
+        munmap(view, size);
+#endif
+    }
+
+
+    // Point the data at the sections of a cache file image, false if the image is broken
+    bool ReadSections(MeshCacheData &data, const unsigned char *image, std::size_t size)
+    {
+        if (size < sizeof(MeshCacheHeader))
+            return false;
+
+        const MeshCacheHeader *header = reinterpret_cast<const MeshCacheHeader *>(image);
+        if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION)
+            return false;
+
+        if (header->vertexOffset + sizeof(PackedVertex) * header->vertexCount > size ||
+            header->indexOffset + sizeof(unsigned int) * header->indexCount > size ||
+            header->submeshOffset + sizeof(MeshCacheSubmesh) * header->submeshCount > size ||
+            header->materialOffset + sizeof(MeshCacheMaterial) * header->materialCount > size)
+            return false;
+
+        data.header = header;
+        data.vertices = reinterpret_cast<const PackedVertex *>(image + header->vertexOffset);
+        data.indices = reinterpret_cast<const unsigned int *>(image + header->indexOffset);
+        data.submeshes = reinterpret_cast<const MeshCacheSubmesh *>(image + header->submeshOffset);
+        data.materials = reinterpret_cast<const MeshCacheMaterial *>(image + header->materialOffset);
+        return true;
+    }
+}
+
+
+MeshCacheData::MeshCacheData()
+    : header(nullptr), vertices(nullptr), indices(nullptr), submeshes(nullptr), materials(nullptr),
+      mapping(nullptr), mappingSize(0)
+{
+}
+
+
+MeshCacheData::~MeshCacheData()
+{
+    if (mapping)
+        UnmapFile(mapping, mappingSize);
+}
+
+
+void MeshCache::Init(const std::string &selfDir)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    MakeDirectory(PATH_JOIN(selfDir, CACHE_PATH::ROOT));
+    directory = PATH_JOIN(selfDir, CACHE_PATH::MESHES);
+    MakeDirectory(directory);
+}
+
+
+std::string MeshCache::CacheFile(const std::string &sourceFile, unsigned int importFlags)
+{
+    uint64_t key = Hash(sourceFile.data(), sourceFile.size());
+    key = Hash(&importFlags, sizeof(importFlags), key);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(key));
+    return PATH_JOIN(directory, name);
+}
+
+
+std::shared_ptr<const MeshCacheData> MeshCache::Load(const std::string &sourceFile, unsigned int importFlags)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Imported before by this process
+    std::string key = sourceFile + '|' + std::to_string(importFlags);
+    auto it = loaded.find(key);
+    if (it != loaded.end())
+        return it->second;
+
+    if (directory.empty())
+        return nullptr;
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!GetFileInfo(sourceFile, sourceSize, sourceTime))
+        return nullptr;
+
+    std::shared_ptr<MeshCacheData> data = std::make_shared<MeshCacheData>();
+    data->mapping = MapFile(CacheFile(sourceFile, importFlags), data->mappingSize);
+    if (!data->mapping)
+        return nullptr;
+
+    if (!ReadSections(*data, static_cast<const unsigned char *>(data->mapping), data->mappingSize))
+        return nullptr;
+
+    // The source changed since the cache was written: rebuild it. A new mtime with the
+    // same content (a checkout, a copy) keeps the cache.
+    const MeshCacheHeader *header = data->header;
+    if (header->importFlags != importFlags || header->sourceSize != sourceSize)
+        return nullptr;
+
+    if (header->sourceTime != sourceTime)
+    {
+        uint64_t sourceHash = 0;
+        if (!HashFile(sourceFile, sourceHash) || sourceHash != header->sourceHash)
+            return nullptr;
+    }
+
+    loaded[key] = data;
+    return data;
+}
+
+
+std::shared_ptr<const MeshCacheData> MeshCache::Store(const std::string &sourceFile, unsigned int importFlags,
+                                                      const Mesh &mesh)
+{
+    // Skinned and animated meshes keep the Assimp scene, they are not cached
+    if (mesh.m_NumBones > 0 || mesh.numAnim > 0)
+        return nullptr;
+
+    if (mesh.positions.size() != mesh.normals.size() || mesh.positions.size() != mesh.texCoords.size())
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = MESH_CACHE_VERSION;
+    header.importFlags = importFlags;
+    GetFileInfo(sourceFile, header.sourceSize, header.sourceTime);
+    HashFile(sourceFile, header.sourceHash);
+
+    header.vertexCount = static_cast<uint32_t>(mesh.positions.size());
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    header.submeshCount = static_cast<uint32_t>(mesh.meshEntries.size());
+    header.materialCount = static_cast<uint32_t>(mesh.importedMaterials.size());
+    header.globalInverseTransform = mesh.m_GlobalInverseTransform;
+
+    header.vertexOffset = Align(sizeof(MeshCacheHeader));
+    header.indexOffset = Align(header.vertexOffset + sizeof(PackedVertex) * header.vertexCount);
+    header.submeshOffset = Align(header.indexOffset + sizeof(unsigned int) * header.indexCount);
+    header.materialOffset = Align(header.submeshOffset + sizeof(MeshCacheSubmesh) * header.submeshCount);
+    std::size_t size = static_cast<std::size_t>(header.materialOffset + sizeof(MeshCacheMaterial) * header.materialCount);
+
+    // Build the file image in memory, it is also the data of this process
+    std::shared_ptr<MeshCacheData> data = std::make_shared<MeshCacheData>();
+    data->buffer.reset(new unsigned char[size]());
+    unsigned char *image = data->buffer.get();
+    memcpy(image, &header, sizeof(header));
+
+    PackedVertex *vertices = reinterpret_cast<PackedVertex *>(image + header.vertexOffset);
+    for (uint32_t i = 0; i < header.vertexCount; i++)
+    {
+        vertices[i].position = mesh.positions[i];
+        vertices[i].normal = mesh.normals[i];
+        vertices[i].text_coord = mesh.texCoords[i];
+    }
+
+    if (header.indexCount)
+        memcpy(image + header.indexOffset, &mesh.indices[0], sizeof(unsigned int) * header.indexCount);
+    if (header.submeshCount)
+        memcpy(image + header.submeshOffset, &mesh.meshEntries[0], sizeof(MeshCacheSubmesh) * header.submeshCount);
+
+    if (header.materialCount)
+        memcpy(image + header.materialOffset, &mesh.importedMaterials[0], sizeof(MeshCacheMaterial) * header.materialCount);
+
+    ReadSections(*data, image, size);
+
+    // Write a temporary file then rename it, a crash never leaves half a cache file
+    if (!directory.empty())
+    {
+        std::string file = CacheFile(sourceFile, importFlags);
+        std::string temporary = file + ".tmp";
+
+        FILE *out = fopen(temporary.c_str(), "wb");
+        bool written = out && fwrite(image, 1, size, out) == size;
+        if (out)
+            fclose(out);
+
+        if (written)
+        {
+            remove(file.c_str());
+            written = rename(temporary.c_str(), file.c_str()) == 0;
+        }
+        if (!written)
+        {
+            remove(temporary.c_str());
+            LOG_WARN(Assets, "MESH CACHE: could not write %s", file.c_str());
+        }
+    }
+
+    loaded[sourceFile + '|' + std::to_string(importFlags)] = data;
+    return data;
+}
+
+
+void MeshCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    loaded.clear();
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "core/gpu/vertex_format.h"
+#include "utils/glm_utils.h"
+
+
+#define MESH_CACHE_MAGIC            (0x4D584647u)   // "GFXM"
+#define MESH_CACHE_VERSION          (1u)
+#define MESH_CACHE_NAME_LENGTH      (256)
+
+
+class Mesh;
+
+
+// Binary mesh file, every section starts 16 byte aligned so the file can be
+// memory-mapped and its sections used in place:
+//
+//   MeshCacheHeader
+//   PackedVertex[vertexCount]            interleaved position, normal, UV
+//   unsigned int[indexCount]
+//   MeshCacheSubmesh[submeshCount]
+//   MeshCacheMaterial[materialCount]
+//
+// The header records the source file (size, mtime, content hash) and the
+// Assimp import flags, a cache file that doesn't match them is rebuilt.
+struct MeshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t importFlags;
+    uint32_t reserved;
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t sourceHash;
+
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t submeshCount;
+    uint32_t materialCount;
+
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t submeshOffset;
+    uint64_t materialOffset;
+
+    glm::mat4 globalInverseTransform;
+};
+
+
+struct MeshCacheSubmesh
+{
+    uint32_t nrIndices;
+    uint32_t baseVertex;
+    uint32_t baseIndex;
+    uint32_t materialIndex;
+};
+
+
+struct MeshCacheMaterial
+{
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 emissive;
+    float shininess;
+
+    // Diffuse texture, relative to the mesh folder (empty without texture)
+    char texture[MESH_CACHE_NAME_LENGTH];
+};
+
+
+// A mesh as it is stored in the cache, the pointers point into the mapped
+// file (or into the buffer it was written from) and stay valid as long as
+// the data is alive
+class MeshCacheData
+{
+ public:
+    MeshCacheData();
+    ~MeshCacheData();
+
+    const MeshCacheHeader *header;
+    const PackedVertex *vertices;
+    const unsigned int *indices;
+    const MeshCacheSubmesh *submeshes;
+    const MeshCacheMaterial *materials;
+
+ private:
+    friend class MeshCache;
+
+    // Owner of the bytes: a file mapping or a heap buffer
+    void *mapping;
+    std::size_t mappingSize;
+    std::unique_ptr<unsigned char[]> buffer;
+};
+
+
+// Binary cache of the meshes imported with Assimp. A file is imported once
+// per process (the next loads get the same data) and once per change of the
+// source file on disk, the next launches map the cache file instead.
+// Only static meshes are cached, the skinned or animated ones need the
+// Assimp scene and are imported every time.
+class MeshCache
+{
+ public:
+    // The cache files go to <selfDir>/cache/meshes
+    static void Init(const std::string &selfDir);
+
+    // Cached data of a source file imported with the given flags, nullptr
+    // when the file has to be imported (then Store() the result)
+    static std::shared_ptr<const MeshCacheData> Load(const std::string &sourceFile, unsigned int importFlags);
+
+    // Write the imported mesh to the cache, returns the stored data (nullptr
+    // when the mesh can't be cached)
+    static std::shared_ptr<const MeshCacheData> Store(const std::string &sourceFile, unsigned int importFlags,
+                                                      const Mesh &mesh);
+
+    // Forget the meshes loaded by this process (the files stay)
+    static void Clear();
+
+ protected:
+    MeshCache() = delete;
+    ~MeshCache() = delete;
+
+ private:
+    static std::string CacheFile(const std::string &sourceFile, unsigned int importFlags);
+
+ private:
+    static std::string directory;
+    static std::unordered_map<std::string, std::shared_ptr<const MeshCacheData>> loaded;
+    static std::mutex mutex;
+};
@@ -10,6 +10,7 @@
 #include "components/transform.h"
 
 #include "core/gpu/shader.h"
+#include "core/gpu/gl_state.h"
 #include "core/gpu/texture2D.h"
 #include "core/gpu/ssbo.h"
 
@@ -77,7 +78,7 @@ void ParticleEffect<T>::Render(gfxc::Camera *camera, Shader *shader, unsigned in
     particles->BindBuffer(0);
 
     // Render Particles
-    glBindVertexArray(VAO);
+    GLState::BindVertexArray(VAO);
     glDrawElements(GL_POINTS, MIN(particleCount, nrParticles), GL_UNSIGNED_INT, 0);
 }
 
@@ -95,7 +96,7 @@ void ParticleEffect<T>::RenderNEW(gfxc::Camera* camera, Shader* shader, glm::mat
     particles->BindBuffer(0);
 
     // Render Particles
-    glBindVertexArray(VAO);
+    GLState::BindVertexArray(VAO);
     glDrawElements(GL_POINTS, MIN(particleCount, nrParticles), GL_UNSIGNED_INT, 0);
 }
 
@@ -119,13 +120,13 @@ void ParticleEffect<T>::Generate(unsigned int particleCount, bool createLocalBuf
     GLuint IBO;
 
     glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    GLState::BindVertexArray(VAO);
 
     glGenBuffers(1, &IBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, particleCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
 
     delete[] indices;
 }
@@ -0,0 +1,213 @@
+#include "core/gpu/program_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#   include <direct.h>
+#endif
+
+#include "core/managers/resource_path.h"
+#include "core/log/log.h"
+
+
+std::string ProgramCache::directory;
+uint64_t ProgramCache::driverHash = 0;
+bool ProgramCache::enabled = false;
+std::mutex ProgramCache::mutex;
+
+
+namespace
+{
+    // FNV-1a, enough to tell two sources apart
+    uint64_t Hash(const void *data, std::size_t size, uint64_t hash = 0xCBF29CE484222325ULL)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+
+    uint64_t HashString(const GLubyte *text, uint64_t hash)
+    {
+        const char *chars = reinterpret_cast<const char *>(text);
+        // The terminator too, "ab" + "c" and "a" + "bc" differ
+        return chars ? Hash(chars, strlen(chars) + 1, hash) : Hash("", 1, hash);
+    }
+
+
+    void MakeDirectory(const std::string &path)
+    {
+#if defined(_WIN32)
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+}
+
+
+void ProgramCache::Init(const std::string &selfDir)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    GLint numFormats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+    enabled = numFormats > 0;
+    if (!enabled)
+    {
+        LOG_INFO(Gpu, "PROGRAM CACHE: program binaries not supported, disabled");
+        return;
+    }
+
+    driverHash = HashString(glGetString(GL_VENDOR), 0xCBF29CE484222325ULL);
+    driverHash = HashString(glGetString(GL_RENDERER), driverHash);
+    driverHash = HashString(glGetString(GL_VERSION), driverHash);
+
+    MakeDirectory(PATH_JOIN(selfDir, CACHE_PATH::ROOT));
+    directory = PATH_JOIN(selfDir, CACHE_PATH::PROGRAMS);
+    MakeDirectory(directory);
+}
+
+
+bool ProgramCache::IsEnabled()
+{
+    return enabled;
+}
+
+
+uint64_t ProgramCache::Key(const std::string &sources)
+{
+    uint64_t key = Hash(&driverHash, sizeof(driverHash));
+    return Hash(sources.data(), sources.size(), key);
+}
+
+
+std::string ProgramCache::CacheFile(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.program", static_cast<unsigned long long>(key));
+    return PATH_JOIN(directory, name);
+}
+
+
+GLuint ProgramCache::Load(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!enabled || directory.empty())
+        return 0;
+
+    std::string file = CacheFile(key);
+    FILE *in = fopen(file.c_str(), "rb");
+    if (!in)
+        return 0;
+
+    ProgramCacheHeader header;
+    std::vector<unsigned char> binary;
+    bool valid = fread(&header, sizeof(header), 1, in) == 1 &&
+                 header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION &&
+                 header.key == key && header.binarySize > 0;
+    if (valid)
+    {
+        binary.resize(header.binarySize);
+        valid = fread(&binary[0], 1, binary.size(), in) == binary.size();
+    }
+    fclose(in);
+
+    GLuint program = 0;
+    if (valid)
+    {
+        // The driver may still reject it (an update that kept its version string)
+        program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, &binary[0], static_cast<GLsizei>(binary.size()));
+
+        GLint linkResult = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linkResult);
+        if (linkResult == GL_FALSE)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (!program)
+    {
+        LOG_WARN(Gpu, "PROGRAM CACHE: rejected %s, compiling from source", file.c_str());
+        remove(file.c_str());
+    }
+
+    // A rejected binary may leave an error, the program is compiled again
+    while (glGetError() != GL_NO_ERROR) {}
+    return program;
+}
+
+
+void ProgramCache::Store(uint64_t key, GLuint program)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!enabled || directory.empty() || !program)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<unsigned char> binary(length);
+    GLenum binaryFormat = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &binaryFormat, &binary[0]);
+    if (written <= 0)
+        return;
+
+    ProgramCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.binaryFormat = binaryFormat;
+    header.binarySize = static_cast<uint32_t>(written);
+    header.key = key;
+
+    // Write a temporary file then rename it, a crash never leaves half a binary
+    std::string file = CacheFile(key);
+    std::string temporary = file + ".tmp";
+
+    FILE *out = fopen(temporary.c_str(), "wb");
+    bool ok = out && fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(&binary[0], 1, header.binarySize, out) == header.binarySize;
+    if (out)
+        fclose(out);
+
+    if (ok)
+    {
+        remove(file.c_str());
+        ok = rename(temporary.c_str(), file.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        remove(temporary.c_str());
+        LOG_WARN(Gpu, "PROGRAM CACHE: could not write %s", file.c_str());
+    }
+}
+
+
+void ProgramCache::Remove(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!enabled || directory.empty())
+        return;
+
+    remove(CacheFile(key).c_str());
+}
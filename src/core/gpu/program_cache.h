@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "utils/gl_utils.h"
+
+
+#define PROGRAM_CACHE_MAGIC         (0x50584647u)   // "GFXP"
+#define PROGRAM_CACHE_VERSION       (1u)
+
+
+// Program binary file:
+//
+//   ProgramCacheHeader
+//   unsigned char[binarySize]            glGetProgramBinary output
+//
+// The key is a hash of the shader sources and of the driver (vendor, renderer,
+// version): a new driver or an edited source gives another file.
+struct ProgramCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+    uint64_t key;
+};
+
+
+// On-disk cache of the linked programs, a program is compiled from source
+// once per driver and per version of its sources, the next launches load
+// its binary. Without program binary support (ARB_get_program_binary) the
+// cache stays disabled and every program is compiled.
+class ProgramCache
+{
+ public:
+    // The cache files go to <selfDir>/cache/programs. Needs the GL context.
+    static void Init(const std::string &selfDir);
+    static bool IsEnabled();
+
+    // Key of a program linked from these sources with the current driver
+    static uint64_t Key(const std::string &sources);
+
+    // A program created from the cached binary, 0 when it has to be compiled
+    // (not cached, or rejected by the driver: the file is then removed)
+    static GLuint Load(uint64_t key);
+
+    // Write the binary of a linked program, it must have been linked with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static void Store(uint64_t key, GLuint program);
+
+    // Forget a program, the next Load compiles it again
+    static void Remove(uint64_t key);
+
+ protected:
+    ProgramCache() = delete;
+    ~ProgramCache() = delete;
+
+ private:
+    static std::string CacheFile(uint64_t key);
+
+ private:
+    static std::string directory;
+    static uint64_t driverHash;
+    static bool enabled;
+    static std::mutex mutex;
+};
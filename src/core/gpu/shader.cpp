@@ -1,12 +1,18 @@
 #include "core/gpu/shader.h"
 
+#include <cstring>
 #include <fstream>
-#include <iostream>
+
+#include "core/gpu/camera_block.h"
+#include "core/gpu/gl_state.h"
+#include "core/gpu/program_cache.h"
+#include "core/log/log.h"
 
 
 Shader::Shader(const std::string &name)
 {
     program = 0;
+    programKey = 0;
     shaderName = name;
     shaderFiles.reserve(5);
 }
@@ -15,6 +21,7 @@ Shader::Shader(const std::string &name)
 Shader::~Shader()
 {
     glDeleteProgram(program);
+    GLState::Invalidate();
 }
 
 
@@ -34,7 +41,7 @@ void Shader::Use() const
 {
     if (program)
     {
-        glUseProgram(program);
+        GLState::UseProgram(program);
         CheckOpenGLError();
     }
 }
@@ -44,9 +51,12 @@ unsigned int Shader::Reload()
 {
     if (program) {
         glDeleteProgram(program);
+        GLState::Invalidate();
         program = 0;
     }
 
+    // Never reuse the cached binary of a reload, it is linked from source again
+    ProgramCache::Remove(programKey);
     return CreateAndLink();
 }
 
@@ -72,8 +82,80 @@ void Shader::OnLoad(std::function<void()> onLoad)
 }
 
 
+bool Shader::UpdateUniformCache(const char *uniformName, const void *value, size_t size, GLint &location)
+{
+    auto it = uniformCache.find(uniformName);
+    if (it == uniformCache.end())
+    {
+        UniformSlot slot;
+        slot.location = GetUniformLocation(uniformName);
+        slot.isSet = false;
+        it = uniformCache.emplace(uniformName, slot).first;
+    }
+
+    // Missing uniforms (-1) and unchanged values are skipped
+    UniformSlot &slot = it->second;
+    location = slot.location;
+    if (location == INVALID_LOC || (slot.isSet && memcmp(slot.value, value, size) == 0)) {
+        return false;
+    }
+
+    memcpy(slot.value, value, size);
+    slot.isSet = true;
+    return true;
+}
+
+
+void Shader::SetUniform(const char *uniformName, int value)
+{
+    GLint location;
+    if (UpdateUniformCache(uniformName, &value, sizeof(value), location)) {
+        glUniform1i(location, value);
+    }
+}
+
+
+void Shader::SetUniform(const char *uniformName, float value)
+{
+    GLint location;
+    if (UpdateUniformCache(uniformName, &value, sizeof(value), location)) {
+        glUniform1f(location, value);
+    }
+}
+
+
+void Shader::SetUniform(const char *uniformName, const glm::vec3 &value)
+{
+    GLint location;
+    if (UpdateUniformCache(uniformName, glm::value_ptr(value), sizeof(value), location)) {
+        glUniform3fv(location, 1, glm::value_ptr(value));
+    }
+}
+
+
+void Shader::SetUniform(const char *uniformName, const glm::vec4 &value)
+{
+    GLint location;
+    if (UpdateUniformCache(uniformName, glm::value_ptr(value), sizeof(value), location)) {
+        glUniform4fv(location, 1, glm::value_ptr(value));
+    }
+}
+
+
+void Shader::SetUniform(const char *uniformName, const glm::mat4 &value)
+{
+    GLint location;
+    if (UpdateUniformCache(uniformName, glm::value_ptr(value), sizeof(value), location)) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+}
+
+
 void Shader::GetUniforms()
 {
+    // A new program: its locations and values are not known yet
+    uniformCache.clear();
+
     // MVP
     loc_model_matrix        = GetUniformLocation("Model");
     loc_view_matrix         = GetUniformLocation("View");
@@ -105,6 +187,12 @@ void Shader::GetUniforms()
     // Text
     text_color              = GetUniformLocation("text_color");
 
+    // Per-frame camera data
+    GLuint cameraBlock = glGetUniformBlockIndex(program, "CameraBlock");
+    if (cameraBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, cameraBlock, CAMERA_BLOCK_BINDING);
+    }
+
     BindTexturesUnits();
 
     CheckOpenGLError();
@@ -129,43 +217,89 @@ void Shader::AddShaderCode(const std::string &shaderCode, GLenum shaderType)
 }
 
 
+static std::string InjectDefines(const std::string &shaderCode)
+{
+    std::string defines;
+    size_t pos = shaderCode.find_first_of("\n");
+
+#ifdef SOLVED
+    defines += "\n#define SOLVED";
+#endif
+
+    if (pos == std::string::npos)
+    {
+        return shaderCode + defines;
+    }
+
+    return shaderCode.substr(0, pos) + defines + shaderCode.substr(pos, std::string::npos);
+}
+
+
 unsigned int Shader::CreateAndLink()
 {
-    std::vector<unsigned int> shaders;
-
-    // Compile shaders
-    for (auto S : shaderFiles) {
-        auto shaderID = Shader::CreateShader(S.file, S.type);
-        if (shaderID) {
-            shaders.push_back(shaderID);
-        } else {
-            return 0;
+    // Sources of every stage: read ahead by ReadSources or read now
+    std::vector<ShaderFile> sources;
+    for (auto &S : shaderFiles) {
+        ShaderFile source;
+        source.file = S.file;
+        source.type = S.type;
+        source.code.swap(S.code);
+
+        if (source.code.empty() && !ReadShaderFile(S.file, source.code)) {
+            LOG_ERROR(Shader, "Could not open file: %s", S.file.c_str());
+            Log::Stop();
+            std::terminate();
         }
+        source.code = InjectDefines(source.code);
+        sources.push_back(source);
     }
 
-    for (auto S : shaderCodes)
-    {
-        auto shaderID = Shader::CompileShader(S.file, S.type);
-        if (shaderID) {
-            shaders.push_back(shaderID);
-        } else {
-            return 0;
-        }
+    for (auto S : shaderCodes) {
+        ShaderFile source;
+        source.type = S.type;
+        source.code = S.file;
+        sources.push_back(source);
     }
 
-    // Create Program and Link
-    if (shaders.size()) {
-        program = Shader::CreateProgram(shaders);
+    // Same sources on the same driver: load the program linked by a previous run
+    std::string key;
+    for (auto &S : sources) {
+        key += std::to_string(S.type) + '\n' + S.code + '\0';
+    }
+    programKey = ProgramCache::Key(key);
+    program = ProgramCache::Load(programKey);
 
-        if (program)
-        {
-            glUseProgram(program);
-            GetUniforms();
-            for (auto Observer : loadObservers) {
-                Observer();
+    if (program) {
+        LOG_INFO(Shader, "PROGRAM = %s ..... CACHED", shaderName.c_str());
+    } else if (sources.size()) {
+        // Compile shaders
+        std::vector<unsigned int> shaders;
+        for (auto &S : sources) {
+            auto shaderID = Shader::CompileShader(S.code, S.type);
+            if (shaderID) {
+                if (!S.file.empty()) {
+                    LOG_INFO(Shader, "FILE = %s ..... COMPILED", S.file.c_str());
+                }
+                shaders.push_back(shaderID);
+            } else {
+                LOG_ERROR(Shader, "FILE = %s ..... ERROR", S.file.empty() ? shaderName.c_str() : S.file.c_str());
+                return 0;
             }
-            return program;
         }
+
+        // Create Program and Link
+        program = Shader::CreateProgram(shaders);
+        ProgramCache::Store(programKey, program);
+    }
+
+    if (program)
+    {
+        GLState::UseProgram(program);
+        GetUniforms();
+        for (auto Observer : loadObservers) {
+            Observer();
+        }
+        return program;
     }
     return 0;
 }
@@ -177,44 +311,34 @@ void Shader::ClearShaders()
 }
 
 
-static std::string InjectDefines(const std::string &shaderCode)
+bool Shader::ReadSources()
 {
-    std::string defines;
-    size_t pos = shaderCode.find_first_of("\n");
-
-#ifdef SOLVED
-    defines += "\n#define SOLVED";
-#endif
-
-    if (pos == std::string::npos)
-    {
-        return shaderCode + defines;
+    bool status = true;
+    for (auto &S : shaderFiles) {
+        if (!ReadShaderFile(S.file, S.code)) {
+            status = false;
+        }
     }
-
-    return shaderCode.substr(0, pos) + defines + shaderCode.substr(pos, std::string::npos);
+    return status;
 }
 
 
-unsigned int Shader::CreateShader(const std::string &shaderFile, GLenum shaderType)
+bool Shader::ReadShaderFile(const std::string &shaderFile, std::string &shaderCode)
 {
-    std::string shader_code;
     std::ifstream file(shaderFile.c_str(), std::ios::in);
 
     if (!file.good()) {
-        std::cout << "\tCould not open file: " << shaderFile << std::endl;
-        std::terminate();
+        shaderCode.clear();
+        return false;
     }
 
-    std::cout << "\tFILE = " << shaderFile;
-
     // Get file content
     file.seekg(0, std::ios::end);
-    shader_code.resize((unsigned int)file.tellg());
+    shaderCode.resize((unsigned int)file.tellg());
     file.seekg(0, std::ios::beg);
-    file.read(&shader_code[0], shader_code.size());
+    file.read(&shaderCode[0], shaderCode.size());
     file.close();
-
-    return CompileShader(InjectDefines(shader_code), shaderType);
+    return true;
 }
 
 
@@ -227,7 +351,6 @@ unsigned int Shader::CompileShader(const std::string shaderCode, GLenum shaderTy
     // Create new shader object
     glShaderObject = glCreateShader(shaderType);
     if (glShaderObject == 0) {
-        std::cout << "\t ..... ERROR " << std::endl;
         return 0;
     }
 
@@ -256,16 +379,12 @@ unsigned int Shader::CompileShader(const std::string shaderCode, GLenum shaderTy
         std::vector<char> shader_log(infoLogLength);
         glGetShaderInfoLog(glShaderObject, infoLogLength, NULL, &shader_log[0]);
 
-        std::cout << "\n-----------------------------------------------------\n";
-        std::cout << "\n[ERROR]: [" << str_shader_type << " SHADER]\n\n";
-        std::cout << &shader_log[0] << "\n";
-        std::cout << "-----------------------------------------------------" << std::endl;
+        LOG_ERROR(Shader, "[%s SHADER]", str_shader_type.c_str());
+        Log::WriteLines(LogCategory::Shader, LogLevel::Error, &shader_log[0]);
 
         return 0;
     }
 
-    std::cout << "\t ..... COMPILED " << std::endl;
-
     return glShaderObject;
 }
 
@@ -281,6 +400,10 @@ unsigned int Shader::CreateProgram(const std::vector<unsigned int> &shaderObject
     for (auto shader : shaderObjects)
         glAttachShader(glProgramObject, shader);
 
+    // Keep the binary available for the program cache
+    if (ProgramCache::IsEnabled())
+        glProgramParameteri(glProgramObject, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     glLinkProgram(glProgramObject);
     glGetProgramiv(glProgramObject, GL_LINK_STATUS, &linkResult);
 
@@ -290,8 +413,8 @@ unsigned int Shader::CreateProgram(const std::vector<unsigned int> &shaderObject
         std::vector<char> program_log(infoLogLength);
         glGetProgramInfoLog(glProgramObject, infoLogLength, NULL, &program_log[0]);
 
-        std::cout << "Shader Loader : LINK ERROR" << std::endl;
-        std::cout << &program_log[0] << std::endl;
+        LOG_ERROR(Shader, "Shader Loader : LINK ERROR");
+        Log::WriteLines(LogCategory::Shader, LogLevel::Error, &program_log[0]);
 
         return 0;
     }
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <list>
 #include <functional>
+#include <unordered_map>
 
 #include "utils/gl_utils.h"
+#include "utils/glm_utils.h"
 
 
 #define MAX_2D_TEXTURES        (16)
@@ -29,14 +32,27 @@ class Shader
     void ClearShaders();
     unsigned int CreateAndLink();
 
+    // Read the source files now (any thread), the next CreateAndLink compiles
+    // them without touching the disk. False if a file can't be read.
+    bool ReadSources();
+
     void BindTexturesUnits();
     GLint GetUniformLocation(const char * uniformName) const;
 
     void OnLoad(std::function<void()> onLoad);
 
+    // Uniforms by name, cached per program: the location is looked up once
+    // and the value is only sent when it changes. The program must be in use.
+    void SetUniform(const char *uniformName, int value);
+    void SetUniform(const char *uniformName, float value);
+    void SetUniform(const char *uniformName, const glm::vec3 &value);
+    void SetUniform(const char *uniformName, const glm::vec4 &value);
+    void SetUniform(const char *uniformName, const glm::mat4 &value);
+
  private:
     void GetUniforms();
-    static unsigned int CreateShader(const std::string &shaderFile, GLenum shaderType);
+    bool UpdateUniformCache(const char *uniformName, const void *value, size_t size, GLint &location);
+    static bool ReadShaderFile(const std::string &shaderFile, std::string &shaderCode);
     static unsigned int CompileShader(const std::string shaderCode, GLenum shaderType);
     static unsigned int CreateProgram(const std::vector<unsigned int> &shaderObjects);
 
@@ -74,10 +90,21 @@ class Shader
     {
         std::string file;
         GLenum type;
+        std::string code;   // Read ahead by ReadSources, empty otherwise
+    };
+
+    // Last value sent to a uniform, large enough for a mat4
+    struct UniformSlot
+    {
+        GLint location;
+        bool isSet;
+        unsigned char value[sizeof(glm::mat4)];
     };
 
     std::string shaderName;
+    uint64_t programKey;    // Program cache entry of the last link
     std::vector<ShaderFile> shaderFiles;
     std::vector<ShaderFile> shaderCodes;
     std::list<std::function<void()>> loadObservers;
+    std::unordered_map<std::string, UniformSlot> uniformCache;
 };
@@ -2,6 +2,7 @@
 
 #include "utils/gl_utils.h"
 #include "utils/memory_utils.h"
+#include "core/gpu/gl_state.h"
 
 
 template <class StorageEntry>
@@ -27,6 +28,7 @@ class SSBO
     ~SSBO()
     {
         glDeleteBuffers(1, &ssbo);
+        GLState::Invalidate();
         SAFE_FREE_ARRAY(data);
     };
 
@@ -46,7 +48,7 @@ class SSBO
 
     void BindBuffer(GLuint index) const
     {
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, ssbo);
+        GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, index, ssbo);
     }
 
     void ReadBuffer()
@@ -87,13 +89,13 @@ class SSBO
  private:
     inline void Bind() const
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+        GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
         CheckOpenGLError();
     }
 
     static inline void Unbind()
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
         CheckOpenGLError();
     }
 
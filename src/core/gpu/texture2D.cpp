@@ -1,7 +1,6 @@
 #include "core/gpu/texture2D.h"
 
 #include <thread>
-#include <iostream>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -9,6 +8,8 @@
 #include "stb/stb_image_write.h"
 
 #include "utils/memory_utils.h"
+#include "core/gpu/gl_state.h"
+#include "core/log/log.h"
 
 
 void write_image_thread(const char* fileName, unsigned int width, unsigned int height, unsigned int channels, const unsigned char *data)
@@ -39,6 +40,7 @@ Texture2D::Texture2D()
     wrappingMode = GL_REPEAT;
     textureMinFilter = GL_LINEAR;
     textureMagFilter = GL_LINEAR;
+    imageData = nullptr;
 }
 
 
@@ -64,35 +66,49 @@ void Texture2D::Init(GLuint gpuTextureID, unsigned int width, unsigned int heigh
 bool Texture2D::Load2D(const char *fileName, GLenum wrapping_mode)
 {
     int width, height, chn;
-    imageData = stbi_load(fileName, &width, &height, &chn, 0);
+    unsigned char *img = Decode2D(fileName, width, height, chn);
 
-    if (imageData == NULL) {
-#ifdef DEBUG_INFO
-        cout << "ERROR loading texture: " << file_name << endl << endl;
-#endif
+    if (img == NULL) {
+        LOG_DEBUG(Assets, "ERROR loading texture: %s", fileName);
         return false;
     }
 
-#ifdef DEBUG_INFO
-    cout << "Loaded " << file_name << endl;
-    cout << width << " * " << height << " channels: " << chn << endl << endl;
-#endif
+    LOG_DEBUG(Assets, "Loaded %s, %d * %d channels: %d", fileName, width, height, chn);
+
+    Upload2D(img, width, height, chn, wrapping_mode);
+    return true;
+}
+
+
+unsigned char *Texture2D::Decode2D(const char *fileName, int &width, int &height, int &chn)
+{
+    return stbi_load(fileName, &width, &height, &chn, 0);
+}
+
+
+void Texture2D::FreeImage(unsigned char *img)
+{
+    stbi_image_free(img);
+}
+
 
+void Texture2D::Upload2D(unsigned char *img, int width, int height, int chn, GLenum wrapping_mode)
+{
+    imageData = img;
     textureMinFilter = GL_LINEAR_MIPMAP_LINEAR;
     wrappingMode = wrapping_mode;
 
     Init2DTexture(width, height, chn);
     glTexImage2D(targetType, 0, internalFormat[0][chn], width, height, 0, pixelFormat[chn], GL_UNSIGNED_BYTE, imageData);
     glGenerateMipmap(targetType);
-    glBindTexture(targetType, 0);
+    GLState::BindTexture(targetType, 0);
     CheckOpenGLError();
 
     if (cacheInMemory == false)
     {
         stbi_image_free(imageData);
+        imageData = nullptr;
     }
-
-    return true;
 }
 
 
@@ -102,10 +118,13 @@ void Texture2D::SaveToFile(const char *fileName)
     {
         imageData = new unsigned char[width * height * channels];
     }
-    glBindTexture(targetType, textureID);
+    GLState::BindTexture(targetType, textureID);
     glGetTexImage(targetType, 0, pixelFormat[channels], GL_UNSIGNED_BYTE, (void *)imageData);
 
+    // GL rows go bottom to top, the image rows top to bottom
+    stbi_flip_vertically_on_write(1);
     stbi_write_png(fileName, width, height, channels, imageData, width * channels);
+    stbi_flip_vertically_on_write(0);
 }
 
 
@@ -156,9 +175,10 @@ void Texture2D::CreateCubeTexture(const float *data, unsigned int width, unsigne
     targetType = GL_TEXTURE_CUBE_MAP;
 
     glDeleteTextures(1, &textureID);
+    GLState::ForgetTexture(textureID);
     glGenTextures(1, &textureID);
 
-    glBindTexture(targetType, textureID);
+    GLState::BindTexture(targetType, textureID);
     glTexParameteri(targetType, GL_TEXTURE_MIN_FILTER, textureMinFilter);
     glTexParameteri(targetType, GL_TEXTURE_MAG_FILTER, textureMagFilter);
     glTexParameteri(targetType, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -200,21 +220,21 @@ void Texture2D::CreateDepthBufferTexture(unsigned int width, unsigned int height
 
 void Texture2D::Bind() const
 {
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GLState::BindTexture(GL_TEXTURE_2D, textureID);
 }
 
 
 void Texture2D::BindToTextureUnit(GLenum TextureUnit) const
 {
     if (!textureID) return;
-    glActiveTexture(TextureUnit);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GLState::ActiveTexture(TextureUnit);
+    GLState::BindTexture(GL_TEXTURE_2D, textureID);
 }
 
 
 void Texture2D::UnBind() const
 {
-    glBindTexture(targetType, 0);
+    GLState::BindTexture(targetType, 0);
     CheckOpenGLError();
 }
 
@@ -271,7 +291,7 @@ void Texture2D::SetWrappingMode(GLenum mode)
 
     if (textureID)
     {
-        glBindTexture(targetType, textureID);
+        GLState::BindTexture(targetType, textureID);
         glTexParameteri(targetType, GL_TEXTURE_WRAP_S, mode);
         glTexParameteri(targetType, GL_TEXTURE_WRAP_T, mode);
         glTexParameteri(targetType, GL_TEXTURE_WRAP_R, mode);
@@ -284,7 +304,7 @@ void Texture2D::SetFiltering(GLenum minFilter, GLenum magFilter)
 {
     if (textureID)
     {
-        glBindTexture(targetType, textureID);
+        GLState::BindTexture(targetType, textureID);
 
         if (textureMinFilter != minFilter) {
             glTexParameteri(targetType, GL_TEXTURE_MIN_FILTER, minFilter);
@@ -301,6 +321,17 @@ void Texture2D::SetFiltering(GLenum minFilter, GLenum magFilter)
 }
 
 
+void Texture2D::GenerateMipmaps()
+{
+    if (!textureID) return;
+
+    Bind();
+    glGenerateMipmap(targetType);
+    UnBind();
+    SetFiltering(GL_LINEAR_MIPMAP_LINEAR, textureMagFilter);
+}
+
+
 void Texture2D::Init2DTexture(unsigned int width, unsigned int height, unsigned int channels)
 {
     this->width = width;
@@ -308,9 +339,12 @@ void Texture2D::Init2DTexture(unsigned int width, unsigned int height, unsigned
     this->channels = channels;
 
     if (textureID)
+    {
         glDeleteTextures(1, &textureID);
+        GLState::ForgetTexture(textureID);
+    }
     glGenTextures(1, &textureID);
-    glBindTexture(targetType, textureID);
+    GLState::BindTexture(targetType, textureID);
     SetTextureParameters();
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
     CheckOpenGLError();
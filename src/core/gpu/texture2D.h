@@ -25,6 +25,12 @@ class Texture2D
     void CreateDepthBufferTexture(unsigned int width, unsigned int height);
 
     bool Load2D(const char* fileName, GLenum wrappingMode = GL_REPEAT);
+
+    // Load2D in two steps: decoding the file needs no GL context (any thread),
+    // the upload takes the decoded image (freed unless cached in memory)
+    static unsigned char *Decode2D(const char* fileName, int &width, int &height, int &chn);
+    static void FreeImage(unsigned char *img);
+    void Upload2D(unsigned char *img, int width, int height, int chn, GLenum wrappingMode = GL_REPEAT);
     void SaveToFile(const char* fileName);
     void CacheInMemory(bool state);
 
@@ -37,6 +43,7 @@ class Texture2D
 
     void SetWrappingMode(GLenum mode);
     void SetFiltering(GLenum minFilter, GLenum magFilter = GL_LINEAR);
+    void GenerateMipmaps();
 
     GLuint GetTextureID() const;
 
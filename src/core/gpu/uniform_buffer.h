@@ -0,0 +1,58 @@
+#pragma once
+
+#include "utils/gl_utils.h"
+#include "core/gpu/gl_state.h"
+
+
+// Uniform buffer holding one block of type Block, laid out as std140
+// on the GLSL side: the C++ struct has to match that layout.
+template <class Block>
+class UniformBuffer
+{
+ public:
+    UniformBuffer()
+    {
+        glGenBuffers(1, &ubo);
+        Bind();
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), NULL, GL_DYNAMIC_DRAW);
+        Unbind();
+    }
+
+    ~UniformBuffer()
+    {
+        glDeleteBuffers(1, &ubo);
+        GLState::Invalidate();
+    }
+
+    // Replace the whole block, the old storage is orphaned so
+    // the upload does not wait for the draws still reading it
+    void SetData(const Block &block)
+    {
+        Bind();
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+        Unbind();
+    }
+
+    // Attach the buffer to a uniform block binding point
+    void BindBuffer(GLuint index) const
+    {
+        GLState::BindBufferBase(GL_UNIFORM_BUFFER, index, ubo);
+    }
+
+ private:
+    inline void Bind() const
+    {
+        GLState::BindBuffer(GL_UNIFORM_BUFFER, ubo);
+        CheckOpenGLError();
+    }
+
+    static inline void Unbind()
+    {
+        GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+        CheckOpenGLError();
+    }
+
+ private:
+    unsigned int ubo;
+};
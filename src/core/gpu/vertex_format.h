@@ -23,3 +23,13 @@ struct VertexFormat
     // Vertex color
     glm::vec3 color;
 };
+
+
+// Vertex of the loaded meshes, the attributes interleaved in one buffer
+// (the binary mesh cache stores them this way, see mesh_cache.h)
+struct PackedVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 text_coord;
+};
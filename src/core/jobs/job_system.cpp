@@ -0,0 +1,212 @@
+#include "core/jobs/job_system.h"
+
+#include <algorithm>
+#include <string>
+
+#include "core/profiler/cpu_profiler.h"
+
+
+namespace
+{
+    // Worker index of the current thread, for the job system that owns it
+    thread_local const JobSystem *tlsOwner = nullptr;
+    thread_local unsigned int tlsQueueIndex = 0;
+}
+
+
+JobSystem::JobSystem(unsigned int numThreads)
+    : numThreads(numThreads), queuedJobs(0), stopping(false)
+{
+    if (this->numThreads == 0)
+    {
+        this->numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < this->numThreads; i++)
+    {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+
+    // The calling thread is the first of the threads, it runs jobs while it waits
+    for (unsigned int i = 1; i < this->numThreads; i++)
+    {
+        workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+    }
+}
+
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+
+unsigned int JobSystem::GetQueueIndex() const
+{
+    return tlsOwner == this ? tlsQueueIndex : 0;
+}
+
+
+void JobSystem::Run(Job job, JobCounter *counter)
+{
+    if (counter)
+    {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Nobody else to run it
+    if (workers.empty())
+    {
+        QueuedJob queued = { std::move(job), counter };
+        Execute(queued);
+        return;
+    }
+
+    WorkerQueue &queue = *queues[GetQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(QueuedJob{ std::move(job), counter });
+    }
+    queuedJobs.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders the wake up after the check of a worker going to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+
+void JobSystem::Wait(JobCounter &counter)
+{
+    const unsigned int index = GetQueueIndex();
+
+    while (!counter.IsDone())
+    {
+        QueuedJob queued;
+        if (PopOrSteal(index, queued))
+        {
+            Execute(queued);
+        }
+        else
+        {
+            // The last jobs of the counter are running on other threads
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+void JobSystem::ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const RangeJob &body)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    // A few chunks per thread, so the threads that finish early can steal the rest
+    const std::size_t count = end - begin;
+    const std::size_t maxChunks = static_cast<std::size_t>(numThreads) * 4;
+    const std::size_t chunkSize = std::max(std::max<std::size_t>(grainSize, 1), (count + maxChunks - 1) / maxChunks);
+
+    if (workers.empty() || count <= chunkSize)
+    {
+        body(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    std::size_t chunkBegin = begin;
+    while (end - chunkBegin > chunkSize)
+    {
+        const std::size_t chunkEnd = chunkBegin + chunkSize;
+        Run([&body, chunkBegin, chunkEnd]() { body(chunkBegin, chunkEnd); }, &counter);
+        chunkBegin = chunkEnd;
+    }
+
+    // Last chunk on this thread, then help with the others
+    body(chunkBegin, end);
+    Wait(counter);
+}
+
+
+bool JobSystem::PopOrSteal(unsigned int index, QueuedJob &out)
+{
+    if (queuedJobs.load(std::memory_order_acquire) <= 0)
+    {
+        return false;
+    }
+
+    // Own queue first, newest job
+    {
+        WorkerQueue &queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            out = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest job of another queue
+    for (unsigned int offset = 1; offset < numThreads; offset++)
+    {
+        WorkerQueue &queue = *queues[(index + offset) % numThreads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            out = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void JobSystem::Execute(QueuedJob &queued)
+{
+    queued.job();
+
+    if (queued.counter)
+    {
+        queued.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+    tlsOwner = this;
+    tlsQueueIndex = index;
+    PROFILE_THREAD("Worker " + std::to_string(index));
+
+    while (!stopping.load())
+    {
+        QueuedJob queued;
+        if (PopOrSteal(index, queued))
+        {
+            Execute(queued);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]()
+        {
+            return stopping.load() || queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+/*
+ *  Work-stealing job system
+ *
+ *  Every worker owns a deque of jobs: it pushes and pops at the back (newest first,
+ *  the data is still in its cache) and the idle workers steal from the front (oldest,
+ *  usually the biggest pieces of work). Threads that wait on a counter run jobs
+ *  instead of blocking, so jobs may spawn and wait on other jobs.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Number of unfinished jobs of a batch, Wait() returns when it drops to 0
+class JobCounter
+{
+ public:
+    JobCounter() : pending(0) {}
+
+    bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+ private:
+    friend class JobSystem;
+    std::atomic<int> pending;
+};
+
+
+class JobSystem
+{
+ public:
+    typedef std::function<void()> Job;
+    typedef std::function<void(std::size_t begin, std::size_t end)> RangeJob;
+
+    // numThreads counts the calling thread, 0 uses every hardware thread
+    explicit JobSystem(unsigned int numThreads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Queue a job, the counter (optional) is incremented now and decremented when the job ends
+    void Run(Job job, JobCounter *counter = nullptr);
+    // Run queued jobs on this thread until every job of the counter is done
+    void Wait(JobCounter &counter);
+
+    // Call body(begin, end) on sub-ranges of [begin, end) of at least grainSize indices,
+    // returns when all of them are done. Small ranges run inline on the calling thread.
+    void ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const RangeJob &body);
+
+    // Threads running jobs, the calling thread included
+    unsigned int GetNumThreads() const { return numThreads; }
+
+ private:
+    struct QueuedJob
+    {
+        Job job;
+        JobCounter *counter;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+
+    void WorkerLoop(unsigned int index);
+    bool PopOrSteal(unsigned int index, QueuedJob &out);
+    void Execute(QueuedJob &queued);
+    unsigned int GetQueueIndex() const;
+
+ private:
+    unsigned int numThreads;
+    // Queue 0 is shared by the threads that are not workers (the main thread)
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<int> queuedJobs;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+};
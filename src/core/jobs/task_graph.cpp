@@ -0,0 +1,72 @@
+#include "core/jobs/task_graph.h"
+
+
+TaskGraph::TaskID TaskGraph::AddTask(const std::string &name, std::function<void()> task)
+{
+    std::unique_ptr<Node> node(new Node());
+    node->name = name;
+    node->task = std::move(task);
+    nodes.push_back(std::move(node));
+
+    return nodes.size() - 1;
+}
+
+
+void TaskGraph::AddDependency(TaskID before, TaskID after)
+{
+    nodes[before]->successors.push_back(after);
+    nodes[after]->numPredecessors++;
+}
+
+
+void TaskGraph::Run(JobSystem &jobs)
+{
+    for (std::unique_ptr<Node> &node : nodes)
+    {
+        node->pendingPredecessors.store(node->numPredecessors, std::memory_order_relaxed);
+    }
+
+    // The successors are queued by their last predecessor before it ends,
+    // so the counter only reaches 0 when the whole graph is done
+    JobCounter counter;
+    for (TaskID id = 0; id < nodes.size(); id++)
+    {
+        if (nodes[id]->numPredecessors == 0)
+        {
+            Schedule(jobs, id, counter);
+        }
+    }
+    jobs.Wait(counter);
+}
+
+
+void TaskGraph::Schedule(JobSystem &jobs, TaskID id, JobCounter &counter)
+{
+    jobs.Run([this, &jobs, &counter, id]()
+    {
+        Node &node = *nodes[id];
+
+        // Named on the first run that records, Intern() takes the profiler registry lock.
+        // A node only runs on one thread at a time
+        if (!node.zoneName && CpuProfiler::IsEnabled())
+            node.zoneName = CpuProfiler::Intern(node.name);
+        {
+            PROFILE_ZONE(node.zoneName);
+            node.task();
+        }
+
+        for (TaskID successor : node.successors)
+        {
+            if (nodes[successor]->pendingPredecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Schedule(jobs, successor, counter);
+            }
+        }
+    }, &counter);
+}
+
+
+void TaskGraph::Clear()
+{
+    nodes.clear();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/*
+ *  Task graph
+ *
+ *  Tasks with dependencies, run on a JobSystem. A task starts once all the tasks it
+ *  depends on have finished, tasks with no path between them may run at the same time.
+ *  The graph is built once and can be run any number of times.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/jobs/job_system.h"
+#include "core/profiler/cpu_profiler.h"
+
+
+class TaskGraph
+{
+ public:
+    typedef std::size_t TaskID;
+
+    TaskID AddTask(const std::string &name, std::function<void()> task);
+    // `after` starts once `before` has finished
+    void AddDependency(TaskID before, TaskID after);
+
+    // Run every task once, returns when all of them are done
+    void Run(JobSystem &jobs);
+    void Clear();
+
+    std::size_t GetNumTasks() const { return nodes.size(); }
+    const std::string &GetTaskName(TaskID id) const { return nodes[id]->name; }
+
+ private:
+    struct Node
+    {
+        std::string name;
+        const char *zoneName = nullptr;     // Name of the profiler zone of the task, set on its first recorded run
+        std::function<void()> task;
+        std::vector<TaskID> successors;
+        int numPredecessors = 0;
+        std::atomic<int> pendingPredecessors{ 0 };
+    };
+
+    void Schedule(JobSystem &jobs, TaskID id, JobCounter &counter);
+
+ private:
+    std::vector<std::unique_ptr<Node>> nodes;
+};
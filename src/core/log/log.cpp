@@ -0,0 +1,497 @@
+#include "core/log/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+namespace
+{
+    // 4096 messages (about 1 MB), a burst of a few thousand lines at startup fits
+    const std::size_t queueCapacity = 1 << 12;
+    const unsigned int defaultRateLimit = 200;
+    const std::chrono::milliseconds idleWait(20);
+
+    const char *levelNames[] = { "trace", "debug", "info", "warn", "error", "off" };
+    const char *categoryNames[] = { "engine", "gpu", "shader", "assets", "game", "profiler" };
+
+    static_assert(sizeof(categoryNames) / sizeof(categoryNames[0]) == static_cast<std::size_t>(LogCategory::Count),
+                  "A log category has no name");
+
+
+    // Constant initialized, usable before and after the logger lives
+    struct CategoryState
+    {
+        std::atomic<int> level{ static_cast<int>(LogLevel::Info) };
+        std::atomic<unsigned int> rateLimit{ defaultRateLimit };
+        std::atomic<int64_t> window{ -1 };      // Second of the rate limit window
+        std::atomic<unsigned int> windowCount{ 0 };
+        std::atomic<unsigned int> dropped{ 0 };
+    };
+
+    CategoryState categories[static_cast<std::size_t>(LogCategory::Count)];
+    std::atomic<uint64_t> totalDropped{ 0 };
+    std::atomic<bool> loggerDestroyed{ false };
+
+
+    int64_t NowNs()
+    {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+
+    CategoryState &GetState(LogCategory category)
+    {
+        return categories[static_cast<std::size_t>(category)];
+    }
+
+
+    // Bounded multi-producer queue (Vyukov): a slot's sequence tells whether it is
+    // free for the producer of that position or filled for the consumer
+    class Logger
+    {
+     public:
+        Logger()
+            : cells(new Cell[queueCapacity]), enqueuePos(0), dequeuePos(0), written(0),
+              sink(&Log::WriteDefault), running(true), writers(0), stopping(false), sleeping(false)
+        {
+            for (std::size_t i = 0; i < queueCapacity; i++)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+
+            thread = std::thread(&Logger::Run, this);
+        }
+
+        ~Logger()
+        {
+            Stop();
+            loggerDestroyed.store(true);
+        }
+
+        // Reserve a slot, nullptr when the queue is full
+        LogMessage *Reserve(std::size_t &position)
+        {
+            position = enqueuePos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell &cell = cells[position & (queueCapacity - 1)];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                if (difference == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        return &cell.message;
+                }
+                else if (difference < 0)
+                {
+                    return nullptr;
+                }
+                else
+                {
+                    position = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void Publish(std::size_t position)
+        {
+            cells[position & (queueCapacity - 1)].sequence.store(position + 1, std::memory_order_release);
+            if (sleeping.load(std::memory_order_relaxed))
+                wakeUp.notify_one();
+        }
+
+        void Flush()
+        {
+            std::size_t target = enqueuePos.load(std::memory_order_acquire);
+            while (written.load(std::memory_order_acquire) < target && IsRunning())
+                std::this_thread::yield();
+        }
+
+        void Stop()
+        {
+            if (!running.exchange(false))
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                stopping.store(true);
+            }
+            wakeUp.notify_one();
+            thread.join();
+
+            // A writer that entered before running was cleared publishes into the queue,
+            // the later ones write straight to the sink
+            while (writers.load() != 0)
+                std::this_thread::yield();
+            // Published while the thread was stopping
+            Drain();
+        }
+
+        bool IsRunning() const { return running.load(std::memory_order_acquire); }
+
+        // Enter the queue, false once Stop() began: write straight to the sink then.
+        // Sequentially consistent with Stop(), either it waits for this writer or
+        // the writer sees it stopping
+        bool BeginWrite()
+        {
+            writers.fetch_add(1);
+            if (running.load())
+                return true;
+
+            writers.fetch_sub(1);
+            return false;
+        }
+
+        void EndWrite() { writers.fetch_sub(1, std::memory_order_release); }
+
+        void SetSink(Log::Sink newSink)
+        {
+            std::lock_guard<std::mutex> lock(sinkMutex);
+            sink = newSink ? std::move(newSink) : Log::Sink(&Log::WriteDefault);
+        }
+
+        // Straight to the sink, once the thread is stopped
+        void WriteNow(const LogMessage &message)
+        {
+            std::lock_guard<std::mutex> lock(sinkMutex);
+            sink(message);
+        }
+
+     private:
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence;
+            LogMessage message;
+        };
+
+        // Hand the published messages to the sink, false when there was none
+        bool Drain()
+        {
+            bool any = false;
+            std::lock_guard<std::mutex> lock(sinkMutex);
+            while (true)
+            {
+                std::size_t position = dequeuePos;
+                Cell &cell = cells[position & (queueCapacity - 1)];
+                if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+                    return any;
+
+                sink(cell.message);
+                cell.sequence.store(position + queueCapacity, std::memory_order_release);
+                dequeuePos = position + 1;
+                written.store(dequeuePos, std::memory_order_release);
+                any = true;
+            }
+        }
+
+        void Run()
+        {
+            while (true)
+            {
+                if (Drain())
+                    continue;
+                if (stopping.load())
+                    break;
+                fflush(stdout);
+
+                // The producers only notify a sleeping thread, the timeout covers a
+                // message published just as it went to sleep
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                sleeping.store(true);
+                if (!stopping.load())
+                    wakeUp.wait_for(lock, idleWait);
+                sleeping.store(false);
+            }
+            Drain();
+        }
+
+     private:
+        std::unique_ptr<Cell[]> cells;
+        std::atomic<std::size_t> enqueuePos;
+        std::size_t dequeuePos;                 // Logging thread only
+        std::atomic<std::size_t> written;
+
+        std::mutex sinkMutex;
+        Log::Sink sink;
+
+        std::thread thread;
+        std::atomic<bool> running;
+        std::atomic<unsigned int> writers;      // Write() calls between BeginWrite() and EndWrite()
+        std::mutex wakeMutex;
+        std::condition_variable wakeUp;
+        std::atomic<bool> stopping;
+        std::atomic<bool> sleeping;
+    };
+
+
+    Logger &GetLogger()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+
+    // False when the message is over the rate limit of its category
+    bool Admit(CategoryState &state, LogLevel level, int64_t timeNs)
+    {
+        unsigned int limit = state.rateLimit.load(std::memory_order_relaxed);
+        if (limit == 0 || level >= LogLevel::Error)
+            return true;
+
+        int64_t second = timeNs / 1000000000;
+        int64_t window = state.window.load(std::memory_order_relaxed);
+        if (window != second && state.window.compare_exchange_strong(window, second, std::memory_order_relaxed))
+            state.windowCount.store(0, std::memory_order_relaxed);
+
+        return state.windowCount.fetch_add(1, std::memory_order_relaxed) < limit;
+    }
+
+
+    void Drop(CategoryState &state)
+    {
+        state.dropped.fetch_add(1, std::memory_order_relaxed);
+        totalDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+
+    void Fill(LogMessage &message, CategoryState &state, LogCategory category, LogLevel level, int64_t timeNs,
+              const char *format, va_list args)
+    {
+        message.level = level;
+        message.category = category;
+        message.timeNs = timeNs;
+        message.dropped = state.dropped.exchange(0, std::memory_order_relaxed);
+        vsnprintf(message.text, sizeof(message.text), format, args);
+    }
+
+
+    std::string ToLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        return text;
+    }
+
+
+    bool ParseLevel(const std::string &name, LogLevel &level)
+    {
+        for (std::size_t i = 0; i < sizeof(levelNames) / sizeof(levelNames[0]); i++)
+        {
+            if (name == levelNames[i])
+            {
+                level = static_cast<LogLevel>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+
+void Log::Write(LogCategory category, LogLevel level, const char *format, ...)
+{
+    CategoryState &state = GetState(category);
+    int64_t timeNs = NowNs();
+    if (!Admit(state, level, timeNs))
+    {
+        Drop(state);
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+
+    if (loggerDestroyed.load(std::memory_order_acquire))
+    {
+        // Logged by a static destructor, after the logger
+        LogMessage message;
+        Fill(message, state, category, level, timeNs, format, args);
+        WriteDefault(message);
+        va_end(args);
+        return;
+    }
+
+    Logger &logger = GetLogger();
+    if (logger.BeginWrite())
+    {
+        std::size_t position;
+        LogMessage *message = logger.Reserve(position);
+        if (message)
+        {
+            Fill(*message, state, category, level, timeNs, format, args);
+            logger.Publish(position);
+        }
+        else
+        {
+            Drop(state);
+        }
+        logger.EndWrite();
+    }
+    else
+    {
+        LogMessage message;
+        Fill(message, state, category, level, timeNs, format, args);
+        logger.WriteNow(message);
+    }
+
+    va_end(args);
+}
+
+
+void Log::WriteLines(LogCategory category, LogLevel level, const std::string &text)
+{
+    if (!IsEnabled(category, level))
+        return;
+
+    std::size_t begin = 0;
+    while (begin < text.size())
+    {
+        std::size_t end = std::min(text.find('\n', begin), text.size());
+        std::string line = text.substr(begin, end - begin);
+        if (!line.empty() && line.find_first_not_of(" \t\r") != std::string::npos)
+            Write(category, level, "%s", line.c_str());
+        begin = end + 1;
+    }
+}
+
+
+bool Log::IsEnabled(LogCategory category, LogLevel level)
+{
+    return level != LogLevel::Off &&
+           static_cast<int>(level) >= GetState(category).level.load(std::memory_order_relaxed);
+}
+
+
+void Log::SetLevel(LogCategory category, LogLevel level)
+{
+    GetState(category).level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+
+void Log::SetLevel(LogLevel level)
+{
+    for (CategoryState &state : categories)
+        state.level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+
+LogLevel Log::GetLevel(LogCategory category)
+{
+    return static_cast<LogLevel>(GetState(category).level.load(std::memory_order_relaxed));
+}
+
+
+bool Log::ParseLevels(const std::string &spec)
+{
+    bool valid = true;
+    std::size_t begin = 0;
+    while (begin <= spec.size())
+    {
+        std::size_t end = std::min(spec.find(',', begin), spec.size());
+        std::string item = ToLower(spec.substr(begin, end - begin));
+        begin = end + 1;
+        if (item.empty())
+            continue;
+
+        LogLevel level;
+        std::size_t equal = item.find('=');
+        if (equal == std::string::npos)
+        {
+            if (ParseLevel(item, level))
+                SetLevel(level);
+            else
+                valid = false;
+            continue;
+        }
+
+        std::string name = item.substr(0, equal);
+        bool found = false;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(LogCategory::Count); i++)
+        {
+            if (name == categoryNames[i] && ParseLevel(item.substr(equal + 1), level))
+            {
+                SetLevel(static_cast<LogCategory>(i), level);
+                found = true;
+            }
+        }
+        valid = valid && found;
+    }
+    return valid;
+}
+
+
+void Log::SetRateLimit(LogCategory category, unsigned int messagesPerSecond)
+{
+    GetState(category).rateLimit.store(messagesPerSecond, std::memory_order_relaxed);
+}
+
+
+void Log::SetSink(Sink sink)
+{
+    GetLogger().SetSink(std::move(sink));
+}
+
+
+void Log::WriteDefault(const LogMessage &message)
+{
+    time_t seconds = static_cast<time_t>(message.timeNs / 1000000000);
+    int milliseconds = static_cast<int>(message.timeNs / 1000000 % 1000);
+    struct tm local;
+#if defined(_WIN32)
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+
+    FILE *out = message.level >= LogLevel::Warn ? stderr : stdout;
+    if (message.dropped > 0)
+    {
+        fprintf(out, "[%02d:%02d:%02d.%03d] [warn] [%s] %u messages dropped\n", local.tm_hour, local.tm_min,
+                local.tm_sec, milliseconds, GetCategoryName(message.category), message.dropped);
+    }
+    fprintf(out, "[%02d:%02d:%02d.%03d] [%s] [%s] %s\n", local.tm_hour, local.tm_min, local.tm_sec, milliseconds,
+            GetLevelName(message.level), GetCategoryName(message.category), message.text);
+}
+
+
+void Log::Flush()
+{
+    if (!loggerDestroyed.load())
+        GetLogger().Flush();
+    fflush(stdout);
+}
+
+
+void Log::Stop()
+{
+    if (!loggerDestroyed.load())
+        GetLogger().Stop();
+    fflush(stdout);
+}
+
+
+uint64_t Log::GetDroppedCount()
+{
+    return totalDropped.load(std::memory_order_relaxed);
+}
+
+
+const char *Log::GetLevelName(LogLevel level)
+{
+    return levelNames[static_cast<std::size_t>(level)];
+}
+
+
+const char *Log::GetCategoryName(LogCategory category)
+{
+    return category < LogCategory::Count ? categoryNames[static_cast<std::size_t>(category)] : "unknown";
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+/*
+ *  Asynchronous logger
+ *
+ *  The calling thread formats the message straight into a slot of a bounded
+ *  lock-free queue and returns, a background thread hands the messages to the
+ *  sink (stdout / stderr by default, spdlog in the engine). Logging never waits
+ *  on terminal or file I/O: when the queue is full the message is dropped and
+ *  counted. Every category has its level and a rate limit (messages per second),
+ *  the messages over the limit are dropped and reported with the next one
+ *  (errors are never rate limited).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+
+#define LOG_MESSAGE_LENGTH      (256)
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define LOG_PRINTF_FORMAT(formatIndex, argsIndex)  __attribute__((format(printf, formatIndex, argsIndex)))
+#else
+#   define LOG_PRINTF_FORMAT(formatIndex, argsIndex)
+#endif
+
+
+enum class LogLevel
+{
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+
+enum class LogCategory
+{
+    Engine,
+    Gpu,
+    Shader,
+    Assets,
+    Game,
+    Profiler,
+    Count
+};
+
+
+struct LogMessage
+{
+    LogLevel level;
+    LogCategory category;
+    int64_t timeNs;             // System clock, nanoseconds since the epoch
+    unsigned int dropped;       // Messages of the category dropped just before this one
+    char text[LOG_MESSAGE_LENGTH];
+};
+
+
+class Log
+{
+ public:
+    // Called on the logging thread only, in the order of the messages
+    typedef std::function<void(const LogMessage &message)> Sink;
+
+    // Queue a message, formatted like printf (truncated to LOG_MESSAGE_LENGTH)
+    static void Write(LogCategory category, LogLevel level, const char *format, ...) LOG_PRINTF_FORMAT(3, 4);
+    // A long text (a compiler log) as one message per line
+    static void WriteLines(LogCategory category, LogLevel level, const std::string &text);
+
+    static bool IsEnabled(LogCategory category, LogLevel level);
+    static void SetLevel(LogCategory category, LogLevel level);
+    static void SetLevel(LogLevel level);
+    static LogLevel GetLevel(LogCategory category);
+    // "info" or "game=debug,shader=warn", false on an unknown name
+    static bool ParseLevels(const std::string &spec);
+
+    // Messages per second accepted per category, 0 for no limit (default 200)
+    static void SetRateLimit(LogCategory category, unsigned int messagesPerSecond);
+
+    // Replace the output, takes effect from the next message
+    static void SetSink(Sink sink);
+    static void WriteDefault(const LogMessage &message);
+
+    // Wait until every message queued so far reached the sink
+    static void Flush();
+    // Write the queued messages and stop the logging thread, messages logged
+    // after that go straight to the sink (done at exit)
+    static void Stop();
+
+    // Messages dropped because the queue was full or over the rate limit
+    static uint64_t GetDroppedCount();
+
+    static const char *GetLevelName(LogLevel level);
+    static const char *GetCategoryName(LogCategory category);
+
+ protected:
+    Log() = delete;
+    ~Log() = delete;
+};
+
+
+#define LOG_WRITE(category, level, ...) \
+    do { \
+        if (Log::IsEnabled(LogCategory::category, LogLevel::level)) \
+            Log::Write(LogCategory::category, LogLevel::level, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_TRACE(category, ...)    LOG_WRITE(category, Trace, __VA_ARGS__)
+#define LOG_DEBUG(category, ...)    LOG_WRITE(category, Debug, __VA_ARGS__)
+#define LOG_INFO(category, ...)     LOG_WRITE(category, Info, __VA_ARGS__)
+#define LOG_WARN(category, ...)     LOG_WRITE(category, Warn, __VA_ARGS__)
+#define LOG_ERROR(category, ...)    LOG_WRITE(category, Error, __VA_ARGS__)
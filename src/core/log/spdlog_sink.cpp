@@ -0,0 +1,74 @@
+#include "core/log/spdlog_sink.h"
+
+#include <memory>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include "core/log/log.h"
+
+
+namespace
+{
+    spdlog::level::level_enum ToSpdlog(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Trace:   return spdlog::level::trace;
+        case LogLevel::Debug:   return spdlog::level::debug;
+        case LogLevel::Info:    return spdlog::level::info;
+        case LogLevel::Warn:    return spdlog::level::warn;
+        case LogLevel::Error:   return spdlog::level::err;
+        default:                return spdlog::level::off;
+        }
+    }
+}
+
+
+bool SpdlogSink::Install(const std::string &logFile)
+{
+    // Single threaded sinks, the logging thread is their only user
+    std::vector<spdlog::sink_ptr> sinks;
+    sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_st>());
+
+    bool opened = true;
+    if (!logFile.empty())
+    {
+        try
+        {
+            sinks.push_back(std::make_shared<spdlog::sinks::basic_file_sink_st>(logFile, true));
+        }
+        catch (const spdlog::spdlog_ex &)
+        {
+            opened = false;
+        }
+    }
+
+    std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::logger>("gfxf", sinks.begin(), sinks.end());
+    logger->set_pattern("[%H:%M:%S.%e] [%^%l%$] %v");
+    // The levels are filtered before the queue
+    logger->set_level(spdlog::level::trace);
+    logger->flush_on(spdlog::level::warn);
+
+    Log::SetSink([logger](const LogMessage &message)
+    {
+        // Time of the call that logged the message, not of its output
+        spdlog::log_clock::time_point time(std::chrono::duration_cast<spdlog::log_clock::duration>(
+            std::chrono::nanoseconds(message.timeNs)));
+        const char *category = Log::GetCategoryName(message.category);
+
+        if (message.dropped > 0)
+        {
+            std::string dropped = fmt::format("[{}] {} messages dropped", category, message.dropped);
+            logger->log(time, spdlog::source_loc(), spdlog::level::warn, dropped);
+        }
+        std::string text = fmt::format("[{}] {}", category, message.text);
+        logger->log(time, spdlog::source_loc(), ToSpdlog(message.level), text);
+    });
+
+    if (!opened)
+        LOG_ERROR(Engine, "Could not open the log file %s", logFile.c_str());
+    return opened;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+
+// Output of the logger through spdlog: colored console, and a file when one is
+// given. The spdlog sinks only run on the logging thread.
+class SpdlogSink
+{
+ public:
+    // False when the log file can't be opened (the console is used alone)
+    static bool Install(const std::string &logFile = "");
+
+ protected:
+    SpdlogSink() = delete;
+    ~SpdlogSink() = delete;
+};
@@ -0,0 +1,158 @@
+#include "core/managers/asset_loader.h"
+
+#include "core/gpu/mesh.h"
+#include "core/gpu/shader.h"
+#include "core/gpu/texture2D.h"
+#include "core/log/log.h"
+#include "core/managers/texture_manager.h"
+#include "utils/text_utils.h"
+
+
+namespace
+{
+    // Owns a decoded image until Upload2D takes it, a request dropped before
+    // its upload frees the pixels
+    class DecodedImage
+    {
+     public:
+        explicit DecodedImage(unsigned char *img) : img(img) {}
+        ~DecodedImage() { if (img) Texture2D::FreeImage(img); }
+
+        DecodedImage(const DecodedImage&) = delete;
+        DecodedImage& operator=(const DecodedImage&) = delete;
+
+        unsigned char *Get() const { return img; }
+        unsigned char *Release()
+        {
+            unsigned char *released = img;
+            img = nullptr;
+            return released;
+        }
+
+     private:
+        unsigned char *img;
+    };
+}
+
+
+AssetLoader::AssetLoader()
+    : ownJobs(new JobSystem()), jobs(*ownJobs)
+{
+}
+
+
+AssetLoader::AssetLoader(JobSystem &jobs)
+    : jobs(jobs)
+{
+}
+
+
+AssetLoader::~AssetLoader()
+{
+    // The workers write into the requests, never leave them running
+    jobs.Wait(counter);
+
+    // Uploads never run here, the GL context may be gone. Dropping the
+    // pending closures frees their CPU buffers.
+    queue.clear();
+}
+
+
+void AssetLoader::Queue(std::function<std::function<void()>()> decode)
+{
+    queue.emplace_back(new Request());
+    Request *request = queue.back().get();
+
+    jobs.Run([request, decode]()
+    {
+        request->upload = decode();
+        request->ready.store(true, std::memory_order_release);
+    }, &counter);
+}
+
+
+void AssetLoader::LoadTexture(const std::string &path, const char *fileName, const char *key)
+{
+    std::string uid = key ? std::string(key) : std::string(fileName);
+    if (TextureManager::GetTexture(uid.c_str()))
+        return;
+
+    std::string file = path + (fileName ? (std::string(1, PATH_SEPARATOR) + fileName) : "");
+
+    Queue([uid, file]() -> std::function<void()>
+    {
+        int width = 0, height = 0, chn = 0;
+        std::shared_ptr<DecodedImage> img = std::make_shared<DecodedImage>(
+            Texture2D::Decode2D(file.c_str(), width, height, chn));
+
+        return [uid, file, img, width, height, chn]()
+        {
+            if (img->Get() == nullptr) {
+                LOG_ERROR(Assets, "ERROR loading texture: %s", file.c_str());
+                return;
+            }
+
+            // Requested twice, or loaded directly meanwhile, the image is freed with the closure
+            if (TextureManager::GetTexture(uid.c_str()))
+                return;
+
+            // The texture owns the pixels from here
+            Texture2D *texture = new Texture2D();
+            texture->Upload2D(img->Release(), width, height, chn);
+            TextureManager::AddTexture(uid, texture);
+        };
+    });
+}
+
+
+void AssetLoader::LoadMesh(Mesh *mesh, const std::string &fileLocation, const std::string &fileName)
+{
+    Queue([mesh, fileLocation, fileName]() -> std::function<void()>
+    {
+        bool imported = mesh->ImportMesh(fileLocation, fileName);
+
+        return [mesh, imported]()
+        {
+            if (imported)
+                mesh->UploadMesh();
+        };
+    });
+}
+
+
+void AssetLoader::LoadShader(Shader *shader)
+{
+    Queue([shader]() -> std::function<void()>
+    {
+        // A file that can't be read is reported by CreateAndLink
+        shader->ReadSources();
+
+        return [shader]()
+        {
+            shader->CreateAndLink();
+        };
+    });
+}
+
+
+std::size_t AssetLoader::Poll()
+{
+    std::size_t uploaded = 0;
+    while (!queue.empty() && queue.front()->ready.load(std::memory_order_acquire))
+    {
+        std::unique_ptr<Request> request = std::move(queue.front());
+        queue.pop_front();
+
+        if (request->upload)
+            request->upload();
+        uploaded++;
+    }
+    return uploaded;
+}
+
+
+void AssetLoader::Finish()
+{
+    jobs.Wait(counter);
+    Poll();
+}
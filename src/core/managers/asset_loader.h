@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "core/jobs/job_system.h"
+
+
+class Mesh;
+class Shader;
+
+
+// Loads the startup assets on worker threads: the images are decoded, the
+// meshes imported and the shader sources read in parallel. Each result waits
+// in a queue as a CPU buffer until the GL thread uploads it (Poll / Finish),
+// in the order of the requests. The assets still pending when the loader is
+// destroyed are dropped and their CPU buffers freed, they are never uploaded.
+class AssetLoader
+{
+ public:
+    // Decodes on its own pool, one thread per core
+    AssetLoader();
+    // Decodes on the workers of an existing pool
+    explicit AssetLoader(JobSystem &jobs);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Decode an image, it is registered in the TextureManager (under key, the file
+    // name by default) when uploaded. A texture already registered is skipped.
+    void LoadTexture(const std::string &path, const char *fileName, const char *key = nullptr);
+
+    // Import a mesh file, the mesh gets its materials and GPU buffers when uploaded.
+    // The mesh must not be used before.
+    void LoadMesh(Mesh *mesh, const std::string &fileLocation, const std::string &fileName);
+
+    // Read the source files of a shader, it is compiled and linked when uploaded.
+    // The shader must not be used before.
+    void LoadShader(Shader *shader);
+
+    // Upload the assets decoded so far, stops at the first one still decoding.
+    // GL thread only, returns the number of assets uploaded.
+    std::size_t Poll();
+
+    // Decode what is left (the calling thread helps) and upload everything
+    void Finish();
+
+    // Assets requested and not uploaded yet
+    std::size_t GetPending() const { return queue.size(); }
+
+ private:
+    struct Request
+    {
+        Request() : ready(false) {}
+
+        std::function<void()> upload;   // Set by the worker, run by the GL thread
+        std::atomic<bool> ready;
+    };
+
+    // Run decode on a worker, it returns the upload step
+    void Queue(std::function<std::function<void()>()> decode);
+
+ private:
+    std::unique_ptr<JobSystem> ownJobs;
+    JobSystem &jobs;
+    JobCounter counter;
+    std::deque<std::unique_ptr<Request>> queue;
+};
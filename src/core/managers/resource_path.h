@@ -18,3 +18,11 @@ namespace SOURCE_PATH
 {
     const std::string PATH_PROJECT        = PATH_JOIN("src", "");
 }
+
+// Files generated at runtime, next to the executable
+namespace CACHE_PATH
+{
+    const std::string ROOT      = PATH_JOIN("cache");
+    const std::string MESHES    = PATH_JOIN(ROOT, "meshes");
+    const std::string PROGRAMS  = PATH_JOIN(ROOT, "programs");
+}
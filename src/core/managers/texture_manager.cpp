@@ -1,6 +1,7 @@
 #include "core/managers/texture_manager.h"
 
 #include "core/gpu/texture2D.h"
+#include "core/managers/asset_loader.h"
 #include "core/managers/resource_path.h"
 #include "utils/memory_utils.h"
 
@@ -9,14 +10,15 @@ std::unordered_map<std::string, Texture2D*> TextureManager::mapTextures;
 std::vector<Texture2D*> TextureManager::vTextures;
 
 
-void TextureManager::Init(const std::string &selfDir)
+void TextureManager::Init(const std::string &selfDir, AssetLoader &loader)
 {
-    LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "default.png");
-    LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "white.png");
-    LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "black.jpg");
-    LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "noise.png");
-    LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "random.jpg");
-    LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "particle.png");
+    // Uploaded in this order, default.png stays the texture 0
+    loader.LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "default.png");
+    loader.LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "white.png");
+    loader.LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "black.jpg");
+    loader.LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "noise.png");
+    loader.LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "random.jpg");
+    loader.LoadTexture(PATH_JOIN(selfDir, RESOURCE_PATH::TEXTURES), "particle.png");
 }
 
 
@@ -41,13 +43,19 @@ Texture2D* TextureManager::LoadTexture(const std::string& path, const char* file
             return (!vTextures.empty()) ? vTextures[0] : nullptr;
         }
 
-        vTextures.push_back(texture);
-        mapTextures[uid] = texture;
+        AddTexture(uid, texture);
     }
     return texture;
 }
 
 
+void TextureManager::AddTexture(const std::string &name, Texture2D *texture)
+{
+    vTextures.push_back(texture);
+    mapTextures[name] = texture;
+}
+
+
 void TextureManager::SetTexture(std::string name, Texture2D *texture)
 {
     mapTextures[name] = texture;
@@ -7,11 +7,15 @@
 #include "core/gpu/texture2D.h"
 
 
+class AssetLoader;
+
 class TextureManager
 {
  public:
-    static void Init(const std::string &selfDir);
+    // Queues the default textures on the loader, they are registered when it uploads them
+    static void Init(const std::string &selfDir, AssetLoader &loader);
     static Texture2D *LoadTexture(const std::string &Path, const char *fileName, const char *key = nullptr, bool forceLoad = false, bool cacheInRAM = false);
+    static void AddTexture(const std::string &name, Texture2D *texture);
     static void SetTexture(const std::string name, Texture2D * texture);
     static Texture2D* GetTexture(const char* name);
     static Texture2D* GetTexture(unsigned int textureID);
@@ -0,0 +1,226 @@
+#include "core/profiler/cpu_profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "core/log/log.h"
+
+
+// Off when compiled out, nothing pays for the zone names then
+#if defined(GFXF_ENABLE_PROFILER)
+std::atomic<bool> CpuProfiler::enabled(true);
+#else
+std::atomic<bool> CpuProfiler::enabled(false);
+#endif
+
+
+namespace
+{
+    // 16384 zones (384 KB) per thread, a few hundred frames of the main thread
+    const std::size_t zoneCapacity = 1 << 14;
+    const std::size_t frameCapacity = 1 << 10;
+
+
+    // Written by its thread only, read by WriteChromeTrace(). The events of a
+    // slot are written before `head` is published (release).
+    struct ThreadBuffer
+    {
+        unsigned int id;
+        std::string name;
+        std::atomic<uint64_t> head{ 0 };
+        CpuZoneEvent events[zoneCapacity];
+    };
+
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;     // Never freed, the trace outlives the threads
+    std::unordered_set<std::string> names;
+
+    thread_local ThreadBuffer *tlsBuffer = nullptr;
+
+    // Frame starts, written by the main loop only
+    uint64_t frameStarts[frameCapacity];
+    std::atomic<uint64_t> frameCount(0);
+
+
+    ThreadBuffer *RegisterThread()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->id = static_cast<unsigned int>(threads.size());
+        buffer->name = "Thread " + std::to_string(buffer->id);
+        threads.push_back(std::move(buffer));
+        return threads.back().get();
+    }
+
+
+    void WriteString(FILE *out, const char *text)
+    {
+        fputc('"', out);
+        for (const char *c = text; *c; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                fputc('\\', out);
+            if (static_cast<unsigned char>(*c) >= 0x20)
+                fputc(*c, out);
+        }
+        fputc('"', out);
+    }
+}
+
+
+void CpuProfiler::Record(const char *name, uint64_t beginNs, uint64_t endNs)
+{
+    ThreadBuffer *buffer = tlsBuffer;
+    if (!buffer)
+        buffer = tlsBuffer = RegisterThread();
+
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    CpuZoneEvent &event = buffer->events[head % zoneCapacity];
+    event.name = name;
+    event.beginNs = beginNs;
+    event.endNs = endNs;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+
+void CpuProfiler::MarkFrame()
+{
+    if (!IsEnabled())
+        return;
+
+    uint64_t count = frameCount.load(std::memory_order_relaxed);
+    frameStarts[count % frameCapacity] = Now();
+    frameCount.store(count + 1, std::memory_order_release);
+}
+
+
+void CpuProfiler::SetThreadName(const std::string &name)
+{
+    ThreadBuffer *buffer = tlsBuffer;
+    if (!buffer)
+        buffer = tlsBuffer = RegisterThread();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->name = name;
+}
+
+
+const char *CpuProfiler::Intern(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return names.insert(name).first->c_str();
+}
+
+
+bool CpuProfiler::WriteChromeTrace(const std::string &file, unsigned int numFrames)
+{
+#if !defined(GFXF_ENABLE_PROFILER)
+    (void)numFrames;
+    LOG_WARN(Profiler, "PROFILER: compiled out, rebuild with GFXF_ENABLE_PROFILER to write %s", file.c_str());
+    return false;
+#else
+    // Start of the oldest frame exported, everything when fewer frames were marked
+    uint64_t count = frameCount.load(std::memory_order_acquire);
+    uint64_t frames = std::min<uint64_t>(std::min<uint64_t>(numFrames, count), frameCapacity);
+    uint64_t sinceNs = frames > 0 && frames < count ? frameStarts[(count - frames) % frameCapacity] : 0;
+
+    struct ThreadEvents
+    {
+        unsigned int id;
+        std::string name;
+        std::vector<CpuZoneEvent> events;
+    };
+    std::vector<ThreadEvents> copies;
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<ThreadBuffer> &buffer : threads)
+        {
+            ThreadEvents copy;
+            copy.id = buffer->id;
+            copy.name = buffer->name;
+
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head > zoneCapacity ? head - zoneCapacity : 0;
+            std::vector<CpuZoneEvent> slots(static_cast<std::size_t>(head - first));
+            for (uint64_t i = first; i < head; i++)
+                slots[static_cast<std::size_t>(i - first)] = buffer->events[i % zoneCapacity];
+
+            // The thread kept recording during the copy: skip the slots it overwrote,
+            // and the slot of index newHead - zoneCapacity it may be writing right now
+            uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+            uint64_t valid = newHead + 1 > zoneCapacity ? std::max(first, newHead + 1 - zoneCapacity) : first;
+            for (uint64_t i = valid; i < head; i++)
+            {
+                const CpuZoneEvent &event = slots[static_cast<std::size_t>(i - first)];
+                if (event.beginNs >= sinceNs)
+                    copy.events.push_back(event);
+            }
+            copies.push_back(std::move(copy));
+        }
+    }
+
+    uint64_t originNs = sinceNs;
+    if (originNs == 0)
+    {
+        originNs = UINT64_MAX;
+        for (const ThreadEvents &copy : copies)
+            for (const CpuZoneEvent &event : copy.events)
+                originNs = std::min(originNs, event.beginNs);
+    }
+
+    FILE *out = fopen(file.c_str(), "w");
+    if (!out)
+    {
+        LOG_ERROR(Profiler, "PROFILER: could not write %s", file.c_str());
+        return false;
+    }
+
+    std::size_t numEvents = 0;
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const ThreadEvents &copy : copies)
+    {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                first ? "" : ",\n", copy.id);
+        WriteString(out, copy.name.c_str());
+        fprintf(out, "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                     "\"args\":{\"sort_index\":%u}}", copy.id, copy.id);
+        first = false;
+
+        for (const CpuZoneEvent &event : copy.events)
+        {
+            fprintf(out, ",\n{\"name\":");
+            WriteString(out, event.name);
+            fprintf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", copy.id,
+                    (event.beginNs - originNs) / 1000.0, (event.endNs - event.beginNs) / 1000.0);
+            numEvents++;
+        }
+    }
+
+    // The frame starts, as global instant events
+    for (uint64_t i = count - frames; i < count; i++)
+    {
+        uint64_t startNs = frameStarts[i % frameCapacity];
+        if (startNs < originNs)
+            continue;
+        fprintf(out, "%s{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+                first ? "" : ",\n", (startNs - originNs) / 1000.0);
+        first = false;
+    }
+    fprintf(out, "\n]}\n");
+
+    bool written = ferror(out) == 0;
+    fclose(out);
+
+    LOG_INFO(Profiler, "PROFILER: %zu zones of the last %llu frames written to %s", numEvents,
+             static_cast<unsigned long long>(frames), file.c_str());
+    return written;
+#endif
+}
@@ -0,0 +1,271 @@
+#include "core/profiler/frame_stats.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "core/log/log.h"
+
+
+namespace
+{
+    const char *phaseNames[] = {
+        "PollEvents",
+        "UpdateObservers",
+        "FrameStart",
+        "Update",
+        "FrameEnd",
+        "SwapBuffers",
+    };
+
+    static_assert(sizeof(phaseNames) / sizeof(phaseNames[0]) == static_cast<std::size_t>(FramePhase::Count),
+                  "A frame phase has no name");
+
+
+    bool EndsWith(const std::string &text, const std::string &suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+
+    void AppendFormat(std::string &text, const char *format, ...)
+    {
+        char buffer[512];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (length > 0)
+            text.append(buffer, std::min(static_cast<std::size_t>(length), sizeof(buffer) - 1));
+    }
+}
+
+
+// Appends the dumps to the file on its own thread, the frame thread only hands
+// the text over and never waits on the file
+class FrameStats::DumpWriter
+{
+ public:
+    explicit DumpWriter(FILE *file)
+        : file(file), stopping(false), thread(&DumpWriter::Run, this) {}
+
+    // Writes what is still pending and closes the file
+    ~DumpWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_one();
+        thread.join();
+        fclose(file);
+    }
+
+    void Append(const std::string &text)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending += text;
+        }
+        wakeUp.notify_one();
+    }
+
+ private:
+    void Run()
+    {
+        std::string text;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wakeUp.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty())
+                break;
+
+            text.swap(pending);
+            lock.unlock();
+            fwrite(text.data(), 1, text.size(), file);
+            fflush(file);
+            text.clear();
+            lock.lock();
+        }
+    }
+
+ private:
+    FILE *file;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::string pending;
+    bool stopping;
+    std::thread thread;
+};
+
+
+FrameStats::FrameStats(double sliceSeconds, unsigned int numSlices)
+    : sliceSeconds(sliceSeconds), numSlices(std::max(1u, numSlices)), slice(0), sliceStart(-1.0),
+      hitchThresholdMs(50.0), totalHitches(0),
+      dumpJson(false), dumpInterval(10.0), lastDump(0.0)
+{
+    frames.resize(this->numSlices);
+    phases.resize(static_cast<std::size_t>(FramePhase::Count), Series(this->numSlices));
+}
+
+
+// Out of line, the DumpWriter is only complete here
+FrameStats::~FrameStats()
+{
+}
+
+
+const char *FrameStats::GetPhaseName(FramePhase phase)
+{
+    return phase < FramePhase::Count ? phaseNames[static_cast<std::size_t>(phase)] : "Unknown";
+}
+
+
+void FrameStats::BeginFrame(double elapsedSeconds, double frameSeconds)
+{
+    if (sliceStart < 0.0)
+    {
+        sliceStart = elapsedSeconds;
+        lastDump = elapsedSeconds;
+        return;
+    }
+
+    // A pause longer than the window leaves nothing of it
+    if (elapsedSeconds - sliceStart >= sliceSeconds * numSlices)
+    {
+        for (unsigned int i = 0; i < numSlices; i++)
+            NextSlice();
+        sliceStart = elapsedSeconds;
+    }
+    while (elapsedSeconds - sliceStart >= sliceSeconds)
+    {
+        NextSlice();
+        sliceStart += sliceSeconds;
+    }
+
+    double frameMs = frameSeconds * 1000.0;
+    frames[slice].Record(static_cast<uint64_t>(std::max(frameMs, 0.0) * 1000.0));
+    if (frameMs > hitchThresholdMs)
+        totalHitches++;
+
+    if (dumpWriter && elapsedSeconds - lastDump >= dumpInterval)
+    {
+        Dump(elapsedSeconds);
+        lastDump = elapsedSeconds;
+    }
+}
+
+
+void FrameStats::AddPhase(FramePhase phase, uint64_t microseconds)
+{
+    phases[static_cast<std::size_t>(phase)][slice].Record(microseconds);
+}
+
+
+void FrameStats::NextSlice()
+{
+    slice = (slice + 1) % numSlices;
+    frames[slice].Clear();
+    for (Series &series : phases)
+        series[slice].Clear();
+}
+
+
+FrameTimeSummary FrameStats::Summarize(const Series &series) const
+{
+    LatencyHistogram window;
+    for (const LatencyHistogram &histogram : series)
+        window.Add(histogram);
+
+    FrameTimeSummary summary;
+    summary.count = window.GetCount();
+    summary.meanMs = window.GetMean() / 1000.0;
+    summary.p50Ms = window.GetPercentile(50.0) / 1000.0;
+    summary.p95Ms = window.GetPercentile(95.0) / 1000.0;
+    summary.p99Ms = window.GetPercentile(99.0) / 1000.0;
+    summary.maxMs = window.GetMax() / 1000.0;
+    summary.hitches = window.CountAbove(static_cast<uint64_t>(hitchThresholdMs * 1000.0));
+    return summary;
+}
+
+
+bool FrameStats::SetDump(const std::string &file, double intervalSeconds)
+{
+    dumpWriter.reset();
+    if (file.empty())
+        return true;
+
+    FILE *out = fopen(file.c_str(), "w");
+    if (!out)
+    {
+        LOG_ERROR(Profiler, "FRAME STATS: could not open %s", file.c_str());
+        return false;
+    }
+
+    dumpWriter.reset(new DumpWriter(out));
+    dumpJson = EndsWith(file, ".json");
+    dumpInterval = intervalSeconds;
+    if (!dumpJson)
+        dumpWriter->Append("time_s,series,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches\n");
+    return true;
+}
+
+
+void FrameStats::Dump(double elapsedSeconds)
+{
+    if (!dumpWriter)
+        return;
+
+    std::string text;
+    if (dumpJson)
+        FormatJson(elapsedSeconds, text);
+    else
+        FormatCsv(elapsedSeconds, text);
+    dumpWriter->Append(text);
+}
+
+
+void FrameStats::FormatCsv(double elapsedSeconds, std::string &text) const
+{
+    auto write = [&](const char *name, const FrameTimeSummary &summary)
+    {
+        AppendFormat(text, "%.3f,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu\n", elapsedSeconds, name,
+                static_cast<unsigned long long>(summary.count), summary.meanMs, summary.p50Ms, summary.p95Ms,
+                summary.p99Ms, summary.maxMs, static_cast<unsigned long long>(summary.hitches));
+    };
+
+    write("Frame", GetFrameSummary());
+    for (std::size_t i = 0; i < phases.size(); i++)
+    {
+        FramePhase phase = static_cast<FramePhase>(i);
+        write(GetPhaseName(phase), GetPhaseSummary(phase));
+    }
+}
+
+
+void FrameStats::FormatJson(double elapsedSeconds, std::string &text) const
+{
+    auto write = [&](const char *name, const FrameTimeSummary &summary)
+    {
+        AppendFormat(text, "\"%s\":{\"count\":%llu,\"mean_ms\":%.3f,\"p50_ms\":%.3f,\"p95_ms\":%.3f,"
+                           "\"p99_ms\":%.3f,\"max_ms\":%.3f,\"hitches\":%llu}", name,
+                static_cast<unsigned long long>(summary.count), summary.meanMs, summary.p50Ms, summary.p95Ms,
+                summary.p99Ms, summary.maxMs, static_cast<unsigned long long>(summary.hitches));
+    };
+
+    AppendFormat(text, "{\"time_s\":%.3f,\"window_s\":%.3f,\"hitch_threshold_ms\":%.3f,\"total_hitches\":%llu,"
+                       "\"series\":{", elapsedSeconds, sliceSeconds * numSlices, hitchThresholdMs,
+            static_cast<unsigned long long>(totalHitches));
+    write("Frame", GetFrameSummary());
+    for (std::size_t i = 0; i < phases.size(); i++)
+    {
+        FramePhase phase = static_cast<FramePhase>(i);
+        text += ',';
+        write(GetPhaseName(phase), GetPhaseSummary(phase));
+    }
+    text += "}}\n";
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/profiler/latency_histogram.h"
+
+
+// Phases of World::LoopUpdate, timed every frame
+enum class FramePhase
+{
+    PollEvents,
+    UpdateObservers,
+    FrameStart,
+    Update,
+    FrameEnd,
+    SwapBuffers,
+    Count
+};
+
+
+// Distribution of a series over the sliding window, in milliseconds
+struct FrameTimeSummary
+{
+    uint64_t count;
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double maxMs;
+    uint64_t hitches;       // Values over the hitch threshold
+};
+
+
+// Frame time and phase time histograms over a sliding window. The window is
+// a ring of numSlices histograms of sliceSeconds each: the oldest slice is
+// dropped as a new one starts, so the percentiles cover the last
+// numSlices * sliceSeconds seconds and a hitch stays visible that long.
+// The summaries can be appended to a file at a fixed interval, as CSV or as
+// JSON lines (one object per dump) when the file name ends with .json. The
+// frame thread only formats them, a background thread writes the file.
+class FrameStats
+{
+ public:
+    explicit FrameStats(double sliceSeconds = 1.0, unsigned int numSlices = 10);
+    ~FrameStats();
+
+    FrameStats(const FrameStats&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+
+    // Start of a frame at elapsedSeconds that followed a frame of frameSeconds,
+    // moves the window and dumps the summaries when due. The first frame only
+    // starts the window, its time is the loading time.
+    void BeginFrame(double elapsedSeconds, double frameSeconds);
+    void AddPhase(FramePhase phase, uint64_t microseconds);
+
+    FrameTimeSummary GetFrameSummary() const { return Summarize(frames); }
+    FrameTimeSummary GetPhaseSummary(FramePhase phase) const
+    {
+        return Summarize(phases[static_cast<std::size_t>(phase)]);
+    }
+    static const char *GetPhaseName(FramePhase phase);
+
+    // Frames slower than this are hitches (default 50 ms, 3 frames at 60 FPS)
+    void SetHitchThreshold(double milliseconds) { hitchThresholdMs = milliseconds; }
+    double GetHitchThreshold() const { return hitchThresholdMs; }
+    // Hitches since the start
+    uint64_t GetTotalHitches() const { return totalHitches; }
+
+    // Append the summaries to file every intervalSeconds, false when the file
+    // can't be opened. An empty name stops the dumps, once the pending ones
+    // are written.
+    bool SetDump(const std::string &file, double intervalSeconds = 10.0);
+    void Dump(double elapsedSeconds);
+
+ private:
+    // A series: one histogram per slice of the window
+    typedef std::vector<LatencyHistogram> Series;
+
+    FrameTimeSummary Summarize(const Series &series) const;
+    void NextSlice();
+    void FormatCsv(double elapsedSeconds, std::string &text) const;
+    void FormatJson(double elapsedSeconds, std::string &text) const;
+
+    class DumpWriter;
+
+ private:
+    double sliceSeconds;
+    unsigned int numSlices;
+    unsigned int slice;             // Slice being filled
+    double sliceStart;
+
+    Series frames;
+    std::vector<Series> phases;
+
+    double hitchThresholdMs;
+    uint64_t totalHitches;
+
+    std::unique_ptr<DumpWriter> dumpWriter;
+    bool dumpJson;
+    double dumpInterval;
+    double lastDump;
+};
+
+
+// Time the scope into a phase of the frame stats
+class FramePhaseTimer
+{
+ public:
+    FramePhaseTimer(FrameStats &stats, FramePhase phase)
+        : stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+    ~FramePhaseTimer()
+    {
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        stats.AddPhase(phase, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+
+    FramePhaseTimer(const FramePhaseTimer&) = delete;
+    FramePhaseTimer& operator=(const FramePhaseTimer&) = delete;
+
+ private:
+    FrameStats &stats;
+    FramePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,108 @@
+#include "core/profiler/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+    const unsigned int subBucketBits = 7;
+    const uint64_t subBucketCount = 1ULL << subBucketBits;         // Buckets per power of two
+    const uint64_t linearCount = subBucketCount * 2;                // Values with a bucket each
+    const unsigned int maxValueBits = 32;
+    const std::size_t numBuckets = static_cast<std::size_t>(
+        linearCount + (maxValueBits - subBucketBits - 1) * subBucketCount);
+}
+
+
+const uint64_t LatencyHistogram::maxValue;
+
+
+LatencyHistogram::LatencyHistogram()
+    : buckets(numBuckets, 0), count(0), sum(0), max(0)
+{
+}
+
+
+std::size_t LatencyHistogram::GetBucket(uint64_t value)
+{
+    value = std::min(value, maxValue);
+    if (value < linearCount)
+        return static_cast<std::size_t>(value);
+
+    // value >> shift lands in [subBucketCount, linearCount)
+    unsigned int shift = 0;
+    while ((value >> shift) >= linearCount)
+        shift++;
+
+    return static_cast<std::size_t>(linearCount + (shift - 1) * subBucketCount + ((value >> shift) - subBucketCount));
+}
+
+
+uint64_t LatencyHistogram::GetBucketMax(std::size_t bucket)
+{
+    if (bucket < linearCount)
+        return bucket;
+
+    uint64_t index = bucket - linearCount;
+    unsigned int shift = static_cast<unsigned int>(index / subBucketCount) + 1;
+    uint64_t subBucket = index % subBucketCount + subBucketCount;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+
+void LatencyHistogram::Record(uint64_t value)
+{
+    buckets[GetBucket(value)]++;
+    count++;
+    sum += value;
+    max = std::max(max, value);
+}
+
+
+void LatencyHistogram::Add(const LatencyHistogram &other)
+{
+    for (std::size_t i = 0; i < numBuckets; i++)
+        buckets[i] += other.buckets[i];
+
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+
+void LatencyHistogram::Clear()
+{
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    sum = 0;
+    max = 0;
+}
+
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    if (count == 0)
+        return 0;
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)));
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < numBuckets; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(GetBucketMax(i), max);
+    }
+    return max;
+}
+
+
+uint64_t LatencyHistogram::CountAbove(uint64_t value) const
+{
+    uint64_t above = 0;
+    for (std::size_t i = GetBucket(value) + 1; i < numBuckets; i++)
+        above += buckets[i];
+    return above;
+}
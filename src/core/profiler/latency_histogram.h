@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Histogram of durations in microseconds with a bounded relative error, in the
+// way of HdrHistogram: values below 256 have a bucket each, above that every
+// power of two is split in 128 buckets (under 0.8% error). Values over
+// maxValue are counted in the last bucket, the exact maximum is kept aside.
+class LatencyHistogram
+{
+ public:
+    static const uint64_t maxValue = (1ULL << 32) - 1;     // About 71 minutes
+
+    LatencyHistogram();
+
+    void Record(uint64_t value);
+    // Add the counts of another histogram
+    void Add(const LatencyHistogram &other);
+    void Clear();
+
+    uint64_t GetCount() const { return count; }
+    uint64_t GetMax() const { return max; }
+    double GetMean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+    // Smallest value that `percentile` percent of the values don't exceed (the
+    // upper bound of its bucket, at most the maximum), 0 when empty
+    uint64_t GetPercentile(double percentile) const;
+    // Number of values above `value` (to the bucket precision)
+    uint64_t CountAbove(uint64_t value) const;
+
+ private:
+    static std::size_t GetBucket(uint64_t value);
+    static uint64_t GetBucketMax(std::size_t bucket);
+
+ private:
+    std::vector<uint32_t> buckets;
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+};
@@ -0,0 +1,155 @@
+#include "core/window/headless_context.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "core/log/log.h"
+
+#if defined(__linux__)
+#   include <EGL/egl.h>
+#   include <EGL/eglext.h>
+#endif
+
+
+#if defined(__linux__)
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#   define EGL_PLATFORM_SURFACELESS_MESA    0x31DD
+#endif
+
+
+namespace
+{
+    bool HasExtension(const char *extensions, const char *name)
+    {
+        if (!extensions)
+            return false;
+
+        // Whole words only, a name may prefix another one
+        std::size_t length = strlen(name);
+        for (const char *it = strstr(extensions, name); it; it = strstr(it + length, name))
+        {
+            bool start = it == extensions || it[-1] == ' ';
+            bool end = it[length] == ' ' || it[length] == '\0';
+            if (start && end)
+                return true;
+        }
+        return false;
+    }
+}
+
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT)
+{
+}
+
+
+HeadlessContext::~HeadlessContext()
+{
+    if (display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT)
+        eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+
+bool HeadlessContext::Create()
+{
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        LOG_ERROR(Engine, "EGL_MESA_platform_surfaceless is not supported");
+        return false;
+    }
+
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (!getPlatformDisplay)
+    {
+        LOG_ERROR(Engine, "eglGetPlatformDisplayEXT is missing");
+        return false;
+    }
+
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        LOG_ERROR(Engine, "cannot initialize the surfaceless EGL display");
+        display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    if (!HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        LOG_ERROR(Engine, "EGL_KHR_surfaceless_context is not supported");
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        LOG_ERROR(Engine, "EGL has no desktop OpenGL");
+        return false;
+    }
+
+    // Any OpenGL config, the context never draws to an EGL surface
+    const EGLint configAttributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &numConfigs);
+
+    // Same version as the window, meaning 3.3 core profile
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, numConfigs > 0 ? config : nullptr, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        LOG_ERROR(Engine, "cannot create an OpenGL 3.3 core context (EGL error 0x%x)", eglGetError());
+        return false;
+    }
+
+    MakeCurrent();
+    return true;
+}
+
+
+void HeadlessContext::MakeCurrent() const
+{
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+#else
+
+HeadlessContext::HeadlessContext()
+    : display(nullptr), context(nullptr)
+{
+}
+
+
+HeadlessContext::~HeadlessContext()
+{
+}
+
+
+bool HeadlessContext::Create()
+{
+    LOG_ERROR(Engine, "the headless backend needs EGL (Linux with Mesa)");
+    return false;
+}
+
+
+void HeadlessContext::MakeCurrent() const
+{
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+
+// OpenGL 3.3 core context without a display or a window system, for the
+// machines that only run the render jobs: EGL on the Mesa surfaceless
+// platform (EGL_MESA_platform_surfaceless), llvmpipe when there is no GPU.
+// It has no default framebuffer, the frames go to an offscreen FrameBuffer.
+class HeadlessContext
+{
+ public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Create the context and make it current, false (with a message) when
+    // EGL or the surfaceless platform is missing
+    bool Create();
+    void MakeCurrent() const;
+
+ private:
+    // EGLDisplay and EGLContext, the EGL headers stay in the translation unit
+    void *display;
+    void *context;
+};
@@ -1,8 +1,7 @@
 #include "core/window/window_callbacks.h"
 
-#include <iostream>
-
 #include "core/engine.h"
+#include "core/log/log.h"
 
 
 void WindowCallbacks::KeyCallback(GLFWwindow *W, int key, int scanCode, int action, int mods)
@@ -43,5 +42,5 @@ void WindowCallbacks::OnResize(GLFWwindow *W, int width, int height)
 
 void WindowCallbacks::OnError(int error, const char * description)
 {
-    std::cout << "[GLFW ERROR]\t" << error << "\t" << description << std::endl;
+    LOG_ERROR(Engine, "[GLFW ERROR] %d %s", error, description);
 }
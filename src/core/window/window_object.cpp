@@ -3,6 +3,9 @@
 #include <iostream>
 
 #include "core/engine.h"
+#include "core/gpu/frame_buffer.h"
+#include "core/log/log.h"
+#include "core/window/headless_context.h"
 #include "core/window/window_callbacks.h"
 #include "core/window/input_controller.h"
 
@@ -16,6 +19,11 @@
 struct WindowDataImpl
 {
     GLFWwindow *handle;
+
+    // Headless window: the context, its offscreen target and the close request
+    HeadlessContext *context;
+    FrameBuffer *target;
+    bool closeRequested;
 };
 
 
@@ -33,6 +41,9 @@ WindowProperties::WindowProperties()
     visible = true;
     hideOnClose = false;
     vSync = true;
+    headless = false;
+    frameLimit = 0;
+    frameTime = 0;
 }
 
 
@@ -41,6 +52,9 @@ WindowObject::WindowObject(WindowProperties properties)
 {
     window = new WindowDataImpl();
     window->handle = nullptr;
+    window->context = nullptr;
+    window->target = nullptr;
+    window->closeRequested = false;
 
     resizeEvent = false;
     scrollEvent = false;
@@ -50,6 +64,24 @@ WindowObject::WindowObject(WindowProperties properties)
     deltaFrameTime = 0;
     props.aspectRatio = float(props.resolution.x) / props.resolution.y;
 
+    // Set default state
+    mouseButtonAction = 0;
+    mouseButtonStates = 0;
+    registeredKeyEvents = 0;
+    memset(keyStates, 0, 384);
+    memset(keyScanCode, 0, 512);
+
+    if (props.headless)
+    {
+        window->context = new HeadlessContext();
+        if (!window->context->Create())
+            exit(0);
+
+        props.visible = false;
+        props.scaleFactor = 1.f;
+        return;
+    }
+
     // Set context version, meaning 3.3 core profile
     glfwWindowHint(GLFW_VISIBLE, props.visible);
 
@@ -64,26 +96,25 @@ WindowObject::WindowObject(WindowProperties properties)
     props.fullScreen ? FullScreen() : WindowMode();
     SetVSync(props.vSync);
 
-    // Set default state
-    mouseButtonAction = 0;
-    mouseButtonStates = 0;
-    registeredKeyEvents = 0;
-    memset(keyStates, 0, 384);
-    memset(keyScanCode, 0, 512);
-
     SetWindowCallbacks();
 }
 
 
 WindowObject::~WindowObject()
 {
-    glfwDestroyWindow(window->handle);
+    if (window->handle)
+        glfwDestroyWindow(window->handle);
+    SAFE_FREE(window->target);
+    SAFE_FREE(window->context);
     delete window;
 }
 
 
 void WindowObject::Show()
 {
+    if (props.headless)
+        return;
+
     props.visible = true;
     glfwShowWindow(window->handle);
     MakeCurrentContext();
@@ -93,14 +124,16 @@ void WindowObject::Show()
 void WindowObject::Hide()
 {
     props.visible = false;
-    glfwHideWindow(window->handle);
+    if (window->handle)
+        glfwHideWindow(window->handle);
 }
 
 
 void WindowObject::SetVSync(bool state)
 {
     props.vSync = state;
-    glfwSwapInterval(state);
+    if (window->handle)
+        glfwSwapInterval(state);
 }
 
 
@@ -113,47 +146,58 @@ bool WindowObject::ToggleVSync()
 
 void WindowObject::Close()
 {
-    props.hideOnClose ? Hide() : glfwSetWindowShouldClose(window->handle, 1);
+    if (props.headless)
+        window->closeRequested = true;
+    else
+        props.hideOnClose ? Hide() : glfwSetWindowShouldClose(window->handle, 1);
 }
 
 
 int WindowObject::ShouldClose() const
 {
-    return glfwWindowShouldClose(window->handle);
+    if (props.frameLimit && frameID >= props.frameLimit)
+        return 1;
+    return props.headless ? window->closeRequested : glfwWindowShouldClose(window->handle);
 }
 
 
 void WindowObject::ShowPointer()
 {
     hiddenPointer = false;
-    glfwSetInputMode(window->handle, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+    if (window->handle)
+        glfwSetInputMode(window->handle, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 }
 
 
 void WindowObject::HidePointer()
 {
     hiddenPointer = true;
-    glfwSetInputMode(window->handle, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
+    if (window->handle)
+        glfwSetInputMode(window->handle, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
 }
 
 
 void WindowObject::DisablePointer()
 {
     hiddenPointer = true;
-    glfwSetInputMode(window->handle, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (window->handle)
+        glfwSetInputMode(window->handle, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 }
 
 
 void WindowObject::SetWindowPosition(glm::ivec2 position)
 {
     props.position = position;
-    glfwSetWindowPos(window->handle, position.x, position.y);
+    if (window->handle)
+        glfwSetWindowPos(window->handle, position.x, position.y);
 }
 
 
 void WindowObject::CenterWindow()
 {
     props.centered = true;
+    if (!window->handle)
+        return;
 
     GLFWmonitor *monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode *videoDisplay = glfwGetVideoMode(monitor);
@@ -167,7 +211,8 @@ void WindowObject::CenterPointer()
 {
     props.cursorPos.x = props.resolution.x / 2;
     props.cursorPos.y = props.resolution.y / 2;
-    glfwSetCursorPos(window->handle, props.cursorPos.x, props.cursorPos.y);
+    if (window->handle)
+        glfwSetCursorPos(window->handle, props.cursorPos.x, props.cursorPos.y);
 }
 
 
@@ -175,13 +220,16 @@ void WindowObject::SetPointerPosition(int mousePosX, int mousePosY)
 {
     props.cursorPos.x = mousePosX;
     props.cursorPos.y = mousePosY;
-    glfwSetCursorPos(window->handle, mousePosX, mousePosY);
+    if (window->handle)
+        glfwSetCursorPos(window->handle, mousePosX, mousePosY);
 }
 
 
 void WindowObject::PollEvents() const
 {
-    glfwPollEvents();
+    // A headless window has no events
+    if (window->handle)
+        glfwPollEvents();
 }
 
 
@@ -209,14 +257,14 @@ void WindowObject::FullScreen()
 
 void error_callback(int error, const char* description)
 {
-    fprintf(stderr, "Error: %s\n", description);
+    LOG_ERROR(Engine, "Error: %s", description);
 }
 
 
 void WindowObject::WindowMode()
 {
     glfwSetErrorCallback(error_callback);
-    if (!glfwInit()) { fprintf(stderr, "Failed to initialize GLFW\n"); }
+    if (!glfwInit()) { LOG_ERROR(Engine, "Failed to initialize GLFW"); }
     window->handle = glfwCreateWindow(props.resolution.x, props.resolution.y, props.name.c_str(), NULL, NULL);
     assert(window->handle != nullptr);
     glfwMakeContextCurrent(window->handle);
@@ -394,12 +442,47 @@ void WindowObject::UpdateObservers()
 
 void WindowObject::MakeCurrentContext() const
 {
-    glfwMakeContextCurrent(window->handle);
+    if (window->context)
+        window->context->MakeCurrent();
+    else
+        glfwMakeContextCurrent(window->handle);
+}
+
+
+void WindowObject::InitRenderTarget()
+{
+    if (!props.headless || window->target)
+        return;
+
+    // RGBA8 color and a depth texture, like the back buffer of a window
+    window->target = new FrameBuffer();
+    window->target->Generate(props.resolution.x, props.resolution.y, 1, true, 8);
+    FrameBuffer::SetDefaultFramebuffer(window->target->GetFramebufferID());
+    FrameBuffer::BindDefault(props.resolution);
+}
+
+
+FrameBuffer *WindowObject::GetRenderTarget() const
+{
+    return window->target;
 }
 
 
 void WindowObject::SetSize(int width, int height)
 {
+    if (props.headless)
+    {
+        props.resolution = glm::ivec2(width, height);
+        props.aspectRatio = float(width) / height;
+        if (window->target)
+        {
+            window->target->Resize(width, height, 8);
+            FrameBuffer::BindDefault(props.resolution);
+        }
+        resizeEvent = true;
+        return;
+    }
+
     int frameBufferWidth, frameBufferHeight;
 
     glfwGetFramebufferSize(window->handle, &frameBufferWidth, &frameBufferHeight);
@@ -413,6 +496,12 @@ void WindowObject::SetSize(int width, int height)
 }
 
 
+unsigned int WindowObject::GetFrameID() const
+{
+    return frameID;
+}
+
+
 glm::ivec2 WindowObject::GetResolution(bool unscaled) const
 {
     glm::ivec2 resolution = props.resolution;
@@ -428,5 +517,9 @@ glm::ivec2 WindowObject::GetResolution(bool unscaled) const
 
 void WindowObject::SwapBuffers() const
 {
-    glfwSwapBuffers(window->handle);
+    // Nothing to present offscreen, wait for the frame so the frame times stay honest
+    if (props.headless)
+        glFinish();
+    else
+        glfwSwapBuffers(window->handle);
 }
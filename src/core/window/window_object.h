@@ -9,6 +9,8 @@
 #include "utils/glm_utils.h"
 
 
+class FrameBuffer;
+
 class WindowProperties
 {
  public:
@@ -28,6 +30,15 @@ class WindowProperties
     bool centered;
     bool hideOnClose;
     bool vSync;
+
+    // No window: an EGL surfaceless context drawing into an offscreen
+    // FrameBuffer, no input. For the display-less render and benchmark jobs.
+    bool headless;
+    // Frames to draw before ShouldClose, 0 for no limit
+    unsigned int frameLimit;
+    // Headless: seconds the clock advances every frame, 0 for the real clock.
+    // With a fixed step a run (and its capture) only depends on the seed.
+    double frameTime;
 };
 
 
@@ -70,8 +81,16 @@ class WindowObject
 
     void MakeCurrentContext() const;
 
+    // Create the offscreen target of a headless window (after the GL functions
+    // are loaded) and make it the default framebuffer, nothing for a window
+    void InitRenderTarget();
+    // Offscreen target of a headless window, nullptr for a window
+    FrameBuffer *GetRenderTarget() const;
+
     // Window Information
     void SetSize(int width, int height);
+    // Frames started so far
+    unsigned int GetFrameID() const;
 
     // Use scaled resolution for setting the viewport.
     // Use unscaled resolution when working with mouse coordinates.
@@ -3,6 +3,7 @@
 #include "core/engine.h"
 #include "components/camera_input.h"
 #include "components/transform.h"
+#include "core/profiler/cpu_profiler.h"
 
 
 World::World()
@@ -22,6 +23,7 @@ void World::Run()
     if (!window)
         return;
 
+    PROFILE_THREAD("Main");
     while (!window->ShouldClose())
     {
         LoopUpdate();
@@ -58,22 +60,50 @@ void World::ComputeFrameDeltaTime()
 
 void World::LoopUpdate()
 {
+    PROFILE_FRAME();
+    PROFILE_ZONE("Frame");
+
     // Polls and buffers the events
-    window->PollEvents();
+    {
+        PROFILE_ZONE("PollEvents");
+        FramePhaseTimer phase(frameStats, FramePhase::PollEvents);
+        window->PollEvents();
+    }
 
     // Computes frame deltaTime in seconds
     ComputeFrameDeltaTime();
+    frameStats.BeginFrame(elapsedTime, deltaTime);
 
     // Calls the methods of the instance of InputController in the following order
     // OnWindowResize, OnMouseMove, OnMouseBtnPress, OnMouseBtnRelease, OnMouseScroll, OnKeyPress, OnMouseScroll, OnInputUpdate
     // OnInputUpdate will be called each frame, the other functions are called only if an event is registered
-    window->UpdateObservers();
+    {
+        PROFILE_ZONE("UpdateObservers");
+        FramePhaseTimer phase(frameStats, FramePhase::UpdateObservers);
+        window->UpdateObservers();
+    }
 
     // Frame processing
-    FrameStart();
-    Update(static_cast<float>(deltaTime));
-    FrameEnd();
+    {
+        PROFILE_ZONE("FrameStart");
+        FramePhaseTimer phase(frameStats, FramePhase::FrameStart);
+        FrameStart();
+    }
+    {
+        PROFILE_ZONE("Update");
+        FramePhaseTimer phase(frameStats, FramePhase::Update);
+        Update(static_cast<float>(deltaTime));
+    }
+    {
+        PROFILE_ZONE("FrameEnd");
+        FramePhaseTimer phase(frameStats, FramePhase::FrameEnd);
+        FrameEnd();
+    }
 
     // Swap front and back buffers - image will be displayed to the screen
-    window->SwapBuffers();
+    {
+        PROFILE_ZONE("SwapBuffers");
+        FramePhaseTimer phase(frameStats, FramePhase::SwapBuffers);
+        window->SwapBuffers();
+    }
 }
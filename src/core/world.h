@@ -1,6 +1,7 @@
 #pragma once
 
 #include "window/input_controller.h"
+#include "core/profiler/frame_stats.h"
 
 
 class World : public InputController
@@ -18,6 +19,8 @@ class World : public InputController
     void Exit();
 
     double GetLastFrameTime();
+    // Frame time and loop phase percentiles over the last seconds
+    FrameStats &GetFrameStats() { return frameStats; }
 
  private:
     void ComputeFrameDeltaTime();
@@ -29,4 +32,6 @@ class World : public InputController
     double deltaTime;
     bool paused;
     bool shouldClose;
+
+    FrameStats frameStats;
 };
@@ -1,10 +1,17 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <iostream>
 
 #include "core/engine.h"
+#include "core/gpu/frame_buffer.h"
+#include "core/log/log.h"
+#include "core/log/spdlog_sink.h"
+#include "core/profiler/cpu_profiler.h"
 #include "components/simple_scene.h"
 
 #include "World_OF_Tanks/World_OF_Tanks.h"
+#include "World_OF_Tanks/GameConstants.h"
 
 #ifdef _WIN32
     PREFER_DISCRETE_GPU_NVIDIA;
@@ -19,9 +26,52 @@ std::string GetParentDir(const std::string &filePath)
 }
 
 
+// Value of the option "name <value>", nullptr when not given
+const char *GetOption(int argc, char **argv, const char *name)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+            return argv[i + 1];
+    }
+    return nullptr;
+}
+
+
+bool HasFlag(int argc, char **argv, const char *name)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+
+// Seed given with --seed <number>, otherwise the current time
+std::uint64_t GetSeed(int argc, char **argv)
+{
+    const char *seed = GetOption(argc, argv, "--seed");
+    return seed ? strtoull(seed, nullptr, 10) : static_cast<std::uint64_t>(time(NULL));
+}
+
+
 int main(int argc, char **argv)
 {
-    srand((unsigned int)time(NULL));
+    // --log-level <spec> sets the levels ("debug" or "game=debug,shader=warn"),
+    // --log-file <file> copies the log to a file
+    const char *logLevel = GetOption(argc, argv, "--log-level");
+    const char *logFile = GetOption(argc, argv, "--log-file");
+    SpdlogSink::Install(logFile ? logFile : "");
+    if (logLevel && !Log::ParseLevels(logLevel))
+    {
+        LOG_WARN(Engine, "Unknown log level in '%s'", logLevel);
+    }
+
+    // Print the seed, running again with --seed replays the same game
+    std::uint64_t seed = GetSeed(argc, argv);
+    LOG_INFO(Engine, "SEED: %llu", static_cast<unsigned long long>(seed));
 
     // Create a window property structure
     WindowProperties wp;
@@ -29,16 +79,55 @@ int main(int argc, char **argv)
     wp.vSync = true;
     wp.selfDir = GetParentDir(std::string(argv[0]));
 
+    // --headless renders offscreen (EGL, no display needed), --frames <n> stops after n frames
+    // and --capture <file.png> saves the last frame of a headless run. --frame-time <ms> makes
+    // every headless frame advance the clock by a fixed step, the same seed gives the same capture
+    const char *frames = GetOption(argc, argv, "--frames");
+    const char *capture = GetOption(argc, argv, "--capture");
+    const char *frameTime = GetOption(argc, argv, "--frame-time");
+    wp.headless = HasFlag(argc, argv, "--headless");
+    wp.frameLimit = frames ? static_cast<unsigned int>(strtoul(frames, nullptr, 10)) : 0;
+    wp.frameTime = frameTime ? strtod(frameTime, nullptr) / 1000.0 : 0.0;
+
+    // --trace <file.json> writes the CPU zones of the last frames at exit (--trace-frames <n>)
+    const char *trace = GetOption(argc, argv, "--trace");
+    const char *traceFrames = GetOption(argc, argv, "--trace-frames");
+
+    // --frame-stats <file.csv|file.json> appends the frame time percentiles every
+    // --frame-stats-interval <seconds> (default 10)
+    const char *frameStats = GetOption(argc, argv, "--frame-stats");
+    const char *frameStatsInterval = GetOption(argc, argv, "--frame-stats-interval");
+
     // Init the Engine and create a new window with the defined properties
-    (void)Engine::Init(wp);
+    WindowObject *window = Engine::Init(wp);
 
-	World* world = new World_OF_Tanks();
+	World* world = new World_OF_Tanks(seed);
 
     world->Init();
+    if (frameStats)
+    {
+        world->GetFrameStats().SetDump(frameStats, frameStatsInterval ? strtod(frameStatsInterval, nullptr) : 10.0);
+    }
     world->Run();
+    world->GetFrameStats().Dump(Engine::GetElapsedTime());
+    // The world is never deleted, wait here until the dumps are in the file
+    world->GetFrameStats().SetDump("");
+
+    if (capture && window->GetRenderTarget())
+    {
+        window->GetRenderTarget()->GetTexture(0)->SaveToFile(capture);
+        LOG_INFO(Engine, "CAPTURE: %s", capture);
+    }
+
+    if (trace)
+    {
+        CpuProfiler::WriteChromeTrace(trace, traceFrames ?
+            static_cast<unsigned int>(strtoul(traceFrames, nullptr, 10)) : cpuTraceFrames);
+    }
 
     // Signals to the Engine to release the OpenGL context
     Engine::Exit();
+    Log::Stop();
 
     return 0;
 }
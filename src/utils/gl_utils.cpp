@@ -1,7 +1,8 @@
 #include "utils/gl_utils.h"
 
 #include <string>
-#include <iostream>
+
+#include "core/log/log.h"
 
 
 void PrintGLErrorDescription(unsigned int glErr)
@@ -16,8 +17,7 @@ void PrintGLErrorDescription(unsigned int glErr)
         "GL_INVALID_FRAMEBUFFER_OPERATION"      // 0x0506
     };
 
-    std::cout << "\n[OpenGL Error]\n";
-    std::cout << "\t[" << glErr << "] : " << GLerrorDescription[glErr - GL_INVALID_ENUM].c_str() << "\n";
+    LOG_ERROR(Gpu, "[OpenGL Error] [%u] : %s", glErr, GLerrorDescription[glErr - GL_INVALID_ENUM].c_str());
 }
 
 
@@ -42,14 +42,14 @@ int gl_utils::CheckError(const char *file, int line)
          */
         if (err == errLast)
         {
-            std::cout << "OpenGL error state couldn't be reset";
+            LOG_ERROR(Gpu, "OpenGL error state couldn't be reset");
             break;
         }
 
         errLast = err;
 
         PrintGLErrorDescription(err);
-        std::cout << "\t[File] : " << file << "\t[Line] : " << line << std::endl;
+        LOG_ERROR(Gpu, "[File] : %s [Line] : %d", file, line);
     }
 
     return errLast;
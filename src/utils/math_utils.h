@@ -9,6 +9,14 @@ inline float lerp(float v0, float v1, float t)
     return v0 + (v1 - v0) * t;
 }
 
+// Interpolate two angles (radians) along the shortest arc
+inline float lerpAngle(float a0, float a1, float t)
+{
+    float diff = fmodf(a1 - a0 + (float)M_PI, 2.0f * (float)M_PI);
+    if (diff < 0) diff += 2.0f * (float)M_PI;
+    return a0 + (diff - (float)M_PI) * t;
+}
+
 #ifndef MAX
 #   define MAX(a, b)        (((a) > (b)) ? (a) : (b))
 #endif
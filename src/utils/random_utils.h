@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+
+// -------------------------------------------------------------------------
+// Counter-based random numbers: every number is a hash of its key
+// (seed, stream, entity, counter) with the SplitMix64 finalizer, there is no
+// generator state. The same key gives the same number on any thread and in
+// any order, e.g. (world seed, movement stream, tank index, tick).
+namespace random_utils
+{
+    // SplitMix64 finalizer, a bijection of the 64 bits with good avalanche
+    inline std::uint64_t Mix64(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // 64 random bits for a key
+    inline std::uint64_t Bits(std::uint64_t seed, std::uint32_t stream, std::uint64_t entity, std::uint64_t counter)
+    {
+        // Golden ratio increments keep the keys (0, 0, 0, 0), (0, 0, 0, 1)... far apart
+        std::uint64_t h = Mix64(seed + 0x9E3779B97F4A7C15ULL * (static_cast<std::uint64_t>(stream) + 1));
+        h = Mix64(h ^ (entity + 0x9E3779B97F4A7C15ULL));
+        return Mix64(h ^ (counter + 0x6A09E667F3BCC909ULL));
+    }
+
+    // Float in [0, 1) from the top 24 bits (the float mantissa)
+    inline float ToUnitFloat(std::uint64_t bits)
+    {
+        return static_cast<float>(bits >> 40) * (1.0f / 16777216.0f);
+    }
+
+    // Integer in [0, n) from the top 32 bits, multiply-shift instead of a biased modulo
+    inline std::uint32_t ToRange(std::uint64_t bits, std::uint32_t n)
+    {
+        return static_cast<std::uint32_t>(((bits >> 32) * n) >> 32);
+    }
+
+    // Float in [min, max)
+    inline float UniformFloat(std::uint64_t seed, std::uint32_t stream, std::uint64_t entity, std::uint64_t counter,
+                              float min, float max)
+    {
+        return min + (max - min) * ToUnitFloat(Bits(seed, stream, entity, counter));
+    }
+
+    // Integer in [0, n)
+    inline int UniformInt(std::uint64_t seed, std::uint32_t stream, std::uint64_t entity, std::uint64_t counter, int n)
+    {
+        return static_cast<int>(ToRange(Bits(seed, stream, entity, counter), static_cast<std::uint32_t>(n)));
+    }
+
+
+    // Numbers drawn one after the other for a (seed, stream, entity), the counter
+    // is the number of draws. Handy in setup code that draws in a fixed order.
+    class Sequence
+    {
+     public:
+        Sequence(std::uint64_t seed, std::uint32_t stream, std::uint64_t entity = 0)
+            : seed(seed), stream(stream), entity(entity), counter(0) {}
+
+        std::uint64_t NextBits() { return Bits(seed, stream, entity, counter++); }
+        float NextFloat(float min, float max) { return min + (max - min) * ToUnitFloat(NextBits()); }
+        int NextInt(int n) { return static_cast<int>(ToRange(NextBits(), static_cast<std::uint32_t>(n))); }
+
+     private:
+        std::uint64_t seed;
+        std::uint32_t stream;
+        std::uint64_t entity;
+        std::uint64_t counter;
+    };
+}